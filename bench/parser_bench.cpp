@@ -0,0 +1,390 @@
+/**
+ * @file parser_bench.cpp
+ * @brief Command-line benchmarks for the .blend parser.
+ *
+ * Build with -DBFF_BUILD_BENCHMARKS=ON, then run e.g.:
+ * @code
+ * ./parser_bench zstd scene_a.blend scene_b.blend
+ * ./parser_bench headers scene_a.blend
+ * ./parser_bench diff shot_v012.blend shot_v013.blend
+ * ./parser_bench order /mnt/archive/projects
+ * @endcode
+ *
+ * Bytes read are taken from /proc/self/io (rchar), so they include every
+ * read() issued on behalf of the measured operation.
+ */
+
+#include "blend_parser.hpp"
+#include "block_diff.hpp"
+#include "block_hash.hpp"
+#include "block_header.hpp"
+#include "compressed_stream.hpp"
+#include "mapped_file.hpp"
+#include "path_filter.hpp"
+#include "scanner.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace BlenderFileFinder;
+
+namespace {
+
+uint64_t bytesReadSoFar() {
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    uint64_t value = 0;
+    while (io >> key >> value) {
+        if (key == "rchar:") return value;
+    }
+    return 0;
+}
+
+/**
+ * @brief Time and I/O volume of one measured operation.
+ */
+struct Sample {
+    double ms = 0.0;
+    uint64_t bytes = 0;
+};
+
+template <typename Fn>
+Sample measure(Fn&& fn) {
+    uint64_t startBytes = bytesReadSoFar();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    Sample sample;
+    sample.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    sample.bytes = bytesReadSoFar() - startBytes;
+    return sample;
+}
+
+/**
+ * @brief Compare parseQuick on compressed files against decompressing them fully.
+ */
+int benchZstd(const std::vector<std::string>& files) {
+    if (!CompressedStream::hasZstdSupport()) {
+        std::cerr << "Built without zstd support\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(40) << "file"
+              << std::right << std::setw(14) << "quick bytes" << std::setw(12) << "quick ms"
+              << std::setw(14) << "full bytes" << std::setw(12) << "full ms" << "\n";
+
+    Sample quickTotal, fullTotal;
+    for (const auto& file : files) {
+        bool hasThumbnail = false;
+        Sample quick = measure([&]() {
+            auto info = BlendParser::parseQuick(file);
+            hasThumbnail = info && info->thumbnail;
+        });
+
+        Sample full = measure([&]() {
+            auto stream = CompressedStream::open(file);
+            if (!stream) return;
+            std::vector<uint8_t> buffer(1 << 20);
+            size_t chunk = buffer.size();
+            while (chunk > 0) {
+                if (!stream->read(buffer.data(), chunk)) {
+                    // Drain the tail in smaller steps until the data runs out
+                    chunk /= 2;
+                }
+            }
+        });
+
+        quickTotal.ms += quick.ms;
+        quickTotal.bytes += quick.bytes;
+        fullTotal.ms += full.ms;
+        fullTotal.bytes += full.bytes;
+
+        std::cout << std::left << std::setw(40) << std::filesystem::path(file).filename().string().substr(0, 39)
+                  << std::right << std::setw(14) << quick.bytes << std::setw(12) << std::fixed << std::setprecision(2) << quick.ms
+                  << std::setw(14) << full.bytes << std::setw(12) << full.ms
+                  << (hasThumbnail ? "" : "  (no thumbnail)") << "\n";
+    }
+
+    if (!files.empty()) {
+        double n = static_cast<double>(files.size());
+        std::cout << std::left << std::setw(40) << "average per file"
+                  << std::right << std::setw(14) << static_cast<uint64_t>(quickTotal.bytes / n)
+                  << std::setw(12) << quickTotal.ms / n
+                  << std::setw(14) << static_cast<uint64_t>(fullTotal.bytes / n)
+                  << std::setw(12) << fullTotal.ms / n << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief Block header read as it was before BlockHeaderDecoder: one read()
+ * per field, and a branch per field on pointer size and byte order.
+ */
+bool readBranching(std::ifstream& file, bool is64bit, bool bigEndian, BlendBlockHeader& block) {
+    auto read32 = [&]() {
+        uint32_t v = 0;
+        file.read(reinterpret_cast<char*>(&v), 4);
+        return bigEndian ? __builtin_bswap32(v) : v;
+    };
+
+    file.read(block.code, 4);
+    block.size = static_cast<int32_t>(read32());
+    if (is64bit) {
+        uint64_t v = 0;
+        file.read(reinterpret_cast<char*>(&v), 8);
+        block.oldAddress = bigEndian ? __builtin_bswap64(v) : v;
+    } else {
+        block.oldAddress = read32();
+    }
+    block.sdnaIndex = static_cast<int32_t>(read32());
+    block.count = static_cast<int32_t>(read32());
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Compare per-field and single-read block header decoding over each
+ * file's block chain, the way the Stream parse mode walks it
+ * (uncompressed files only).
+ */
+int benchHeaders(const std::vector<std::string>& files) {
+    constexpr int PASSES = 20;
+
+    std::cout << std::left << std::setw(40) << "file"
+              << std::right << std::setw(10) << "blocks"
+              << std::setw(16) << "per-field/s" << std::setw(16) << "specialized/s" << "\n";
+
+    for (const auto& file : files) {
+        MappedFile mapping;
+        if (!mapping.open(file) || mapping.size() < 12 ||
+            std::memcmp(mapping.data(), "BLENDER", 7) != 0) {
+            std::cerr << file << ": not an uncompressed .blend file\n";
+            continue;
+        }
+
+        const uint8_t* data = mapping.data();
+        bool is64bit = data[7] == '-';
+        bool bigEndian = data[8] == 'V';
+        BlockHeaderDecoder decoder = BlockHeaderDecoder::select(is64bit, bigEndian);
+
+        // Header offsets, found once so both passes decode the same bytes
+        std::vector<std::streamoff> offsets;
+        size_t offset = 12;
+        while (offset + decoder.size <= mapping.size()) {
+            BlendBlockHeader block;
+            decoder.decode(data + offset, block);
+            if (block.size < 0) break;
+            offsets.push_back(static_cast<std::streamoff>(offset));
+            if (std::memcmp(block.code, "ENDB", 4) == 0) break;
+            offset += decoder.size + static_cast<size_t>(block.size);
+        }
+
+        std::ifstream stream(file, std::ios::binary);
+        // Sum a field so the decodes can't be optimized away
+        int64_t checksum = 0;
+        Sample perField = measure([&]() {
+            for (int pass = 0; pass < PASSES; ++pass) {
+                for (std::streamoff at : offsets) {
+                    BlendBlockHeader block;
+                    stream.seekg(at);
+                    readBranching(stream, is64bit, bigEndian, block);
+                    checksum += block.size;
+                }
+            }
+        });
+        Sample specialized = measure([&]() {
+            for (int pass = 0; pass < PASSES; ++pass) {
+                for (std::streamoff at : offsets) {
+                    BlendBlockHeader block;
+                    uint8_t bytes[BlockHeaderDecoder::MAX_SIZE];
+                    stream.seekg(at);
+                    stream.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(decoder.size));
+                    decoder.decode(bytes, block);
+                    checksum -= block.size;
+                }
+            }
+        });
+
+        double decodes = static_cast<double>(offsets.size()) * PASSES;
+        std::cout << std::left << std::setw(40) << std::filesystem::path(file).filename().string().substr(0, 39)
+                  << std::right << std::setw(10) << offsets.size()
+                  << std::setw(16) << static_cast<uint64_t>(decodes / (perField.ms / 1000.0))
+                  << std::setw(16) << static_cast<uint64_t>(decodes / (specialized.ms / 1000.0))
+                  << (checksum == 0 ? "" : "  (mismatch)") << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief Hash two versions of a file and print their datablock differences.
+ */
+int benchDiff(const std::vector<std::string>& files) {
+    if (files.size() != 2) {
+        std::cerr << "diff takes exactly two files (older, newer)\n";
+        return 1;
+    }
+
+    std::cout << "Hash implementation: " << BlockHash::implementation() << "\n";
+    std::optional<FileDigest> digests[2];
+    for (size_t i = 0; i < 2; ++i) {
+        Sample sample = measure([&]() { digests[i] = BlockDiff::computeDigest(files[i]); });
+        if (!digests[i]) {
+            std::cerr << files[i] << ": can't be read\n";
+            return 1;
+        }
+        double mb = static_cast<double>(digests[i]->fileSize) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(40) << std::filesystem::path(files[i]).filename().string().substr(0, 39)
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << mb << " MB" << std::setw(10) << sample.ms << " ms"
+                  << std::setw(10) << mb / (sample.ms / 1000.0) << " MB/s  "
+                  << digests[i]->datablocks.size() << " datablocks\n";
+    }
+
+    FileDiff diff = BlockDiff::diff(*digests[0], *digests[1]);
+    for (const auto& change : diff.changes) {
+        const char* kind = change.kind == DatablockChange::Kind::Added ? "+"
+                         : change.kind == DatablockChange::Kind::Removed ? "-" : "~";
+        std::cout << "  " << kind << " " << change.type << " " << change.name
+                  << "  (" << change.oldSize << " -> " << change.newSize << " bytes)\n";
+    }
+    std::cout << diff.changes.size() << " changed, " << diff.unchangedCount << " unchanged\n";
+
+    // Through the digest cache: the first call fills it, the second only reads it
+    BlockDiff differ;
+    Sample first = measure([&]() { differ.compare(files[0], files[1]); });
+    Sample cached = measure([&]() { differ.compare(files[0], files[1]); });
+    std::cout << "compare(): " << first.ms << " ms, cached " << cached.ms << " ms\n";
+    return 0;
+}
+
+/**
+ * @brief Evict files from the page cache so the next read comes from disk.
+ *
+ * Dropping all caches also forgets dentries and inodes, but needs root;
+ * otherwise each file's pages are dropped with POSIX_FADV_DONTNEED.
+ *
+ * @return true if all caches were dropped, false if only the files' pages
+ */
+bool evictFromCache(const std::vector<std::filesystem::path>& files) {
+    ::sync();
+    std::ofstream dropCaches("/proc/sys/vm/drop_caches");
+    if (dropCaches && (dropCaches << "3" << std::flush)) return true;
+
+    for (const auto& file : files) {
+        int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+    return false;
+}
+
+/**
+ * @brief Scan a directory from a cold cache in discovery order and in disk order.
+ *
+ * Uses the scan settings of a spinning disk (two walkers, two parsers),
+ * so the numbers show what ParseOrder::Disk saves there.
+ */
+int benchOrder(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        std::cerr << "order takes one directory\n";
+        return 1;
+    }
+    std::filesystem::path root = args[0];
+
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec) && PathFilter::isBlendName(it->path().filename().string())) {
+            files.push_back(it->path());
+        }
+    }
+    if (files.empty()) {
+        std::cerr << root << ": no .blend files\n";
+        return 1;
+    }
+
+    std::cout << files.size() << " files\n";
+    std::cout << std::left << std::setw(12) << "order"
+              << std::right << std::setw(12) << "ms" << std::setw(12) << "files/s"
+              << std::setw(12) << "MB/s" << std::setw(14) << "read MB" << "\n";
+
+    const std::pair<const char*, Scanner::ParseOrder> orders[] = {
+        {"discovery", Scanner::ParseOrder::Discovery},
+        {"disk", Scanner::ParseOrder::Disk},
+    };
+    bool droppedAll = true;
+    for (const auto& [name, order] : orders) {
+        droppedAll = evictFromCache(files) && droppedAll;
+
+        Scanner scanner;
+        scanner.setWalkConcurrency(2);
+        scanner.setParseThreads(2);
+        scanner.setParseOrder(order);
+        std::atomic<uint64_t> fileBytes{0};
+        std::atomic<size_t> fileCount{0};
+        scanner.setBatchCallback([&](std::vector<BlendFileInfo>& batch) {
+            for (const auto& info : batch) fileBytes += info.fileSize;
+            fileCount += batch.size();
+        });
+
+        Sample sample = measure([&]() {
+            scanner.startScan(root, true);
+            while (!scanner.isComplete()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+
+        double seconds = sample.ms / 1000.0;
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << sample.ms
+                  << std::setw(12) << static_cast<double>(fileCount.load()) / seconds
+                  << std::setw(12) << static_cast<double>(fileBytes.load()) / (1024.0 * 1024.0) / seconds
+                  << std::setw(14) << static_cast<double>(sample.bytes) / (1024.0 * 1024.0) << "\n";
+    }
+    if (!droppedAll) {
+        std::cout << "Only file pages were evicted; run as root to drop dentries and inodes too\n";
+    }
+    return 0;
+}
+
+void printUsage() {
+    std::cerr << "Usage: parser_bench <benchmark> <files...|directory>\n"
+              << "Benchmarks:\n"
+              << "  zstd      parseQuick vs full decompression of compressed .blend files\n"
+              << "  headers   per-field vs single-read block header decoding\n"
+              << "  diff      datablock hashing throughput and diff of two files\n"
+              << "  order     cold-cache scan of a directory in discovery vs disk order\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string benchmark = argv[1];
+    std::vector<std::string> files(argv + 2, argv + argc);
+
+    if (benchmark == "zstd") {
+        return benchZstd(files);
+    }
+    if (benchmark == "headers") {
+        return benchHeaders(files);
+    }
+    if (benchmark == "diff") {
+        return benchDiff(files);
+    }
+    if (benchmark == "order") {
+        return benchOrder(files);
+    }
+
+    printUsage();
+    return 1;
+}
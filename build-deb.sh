@@ -82,7 +82,7 @@ Section: graphics
 Priority: optional
 Architecture: ${ARCH}
 Installed-Size: ${INSTALLED_SIZE}
-Depends: libc6 (>= 2.34), libstdc++6 (>= 11), libglfw3 (>= 3.3), libsqlite3-0, libgl1
+Depends: libc6 (>= 2.34), libstdc++6 (>= 11), libglfw3 (>= 3.3), libsqlite3-0, zlib1g, libzstd1, libgl1
 Maintainer: Blender File Finder Team <noreply@example.com>
 Homepage: https://github.com/yourusername/BlenderFileFinder
 Description: Browse and manage Blender files with thumbnails
@@ -6,6 +6,9 @@
 #include "database.hpp"
 #include "blend_parser.hpp"
 #include "preview_cache.hpp"
+#include "file_watcher.hpp"
+#include "block_index.hpp"
+#include "path_filter.hpp"
 #include "ui/file_browser.hpp"
 #include "ui/file_view.hpp"
 #include "ui/search_bar.hpp"
@@ -23,7 +26,9 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <iterator>
 #include <set>
+#include <unordered_map>
 
 namespace BlenderFileFinder {
 
@@ -32,6 +37,45 @@ static FileBrowser* s_fileBrowser = nullptr;
 static FileView* s_fileView = nullptr;
 static SearchBar* s_searchBar = nullptr;
 
+// While scanning, the view is reloaded with the files stored so far at most this often
+static constexpr auto SCAN_RELOAD_INTERVAL = std::chrono::seconds(2);
+
+// Path -> mtime of files recorded as having no embedded thumbnail
+static std::unordered_map<std::string, int64_t> noThumbnailFiles(const std::vector<BlendFileInfo>& files) {
+    std::unordered_map<std::string, int64_t> result;
+    for (const auto& file : files) {
+        if (file.noEmbeddedThumbnail) {
+            result.emplace(file.path.string(), file.modifiedTime.time_since_epoch().count());
+        }
+    }
+    return result;
+}
+
+// Stores the datablock previews a parse read in the thumbnail disk cache
+static Scanner::PreviewCallback previewCacher(ThumbnailCache* cache) {
+    return [cache](const BlendFileInfo& file, const std::vector<BlendPreview>& previews) {
+        cache->savePreviewsToDiskCache(file.path, file.modifiedTime.time_since_epoch().count(), previews);
+    };
+}
+
+// The location a path is in: the deepest one whose path is the path or a
+// parent of it, so nested locations keep their own rules
+static const ScanLocation* owningLocation(const std::vector<ScanLocation>& locations,
+                                          const std::filesystem::path& path) {
+    const std::string& target = path.native();
+    const ScanLocation* best = nullptr;
+    for (const auto& loc : locations) {
+        const std::string& base = loc.path.native();
+        if (base.empty() || target.compare(0, base.size(), base) != 0) continue;
+        // "/foo/bar" contains "/foo/bar/x" but not "/foo/barbaz"
+        bool boundary = target.size() == base.size() || base.back() == '/' || target[base.size()] == '/';
+        if (boundary && (!best || base.size() > best->path.native().size())) {
+            best = &loc;
+        }
+    }
+    return best;
+}
+
 App::App() = default;
 
 App::~App() = default;
@@ -154,8 +198,6 @@ bool App::init() {
     DEBUG_LOG("ImGui backends initialized");
 
     // Initialize components
-    DEBUG_LOG("Creating Scanner");
-    m_scanner = std::make_unique<Scanner>();
     DEBUG_LOG("Creating ThumbnailCache");
     m_thumbnailCache = std::make_unique<ThumbnailCache>(2000);  // Increased to reduce eviction thrashing
     DEBUG_LOG("Creating VersionGrouper");
@@ -180,6 +222,24 @@ bool App::init() {
     }
     DEBUG_LOG("Database opened at: " << dbPath);
 
+    // Scans store their results from a background thread, on a connection of their own
+    m_scanDatabase = std::make_unique<Database>();
+    if (!m_scanDatabase->open(dbPath)) {
+        DEBUG_LOG("Failed to open scan database connection, scan results will be stored on completion");
+        m_scanDatabase.reset();
+    }
+
+    // The file watcher stores changes from its own thread too
+    m_watchDatabase = std::make_unique<Database>();
+    if (!m_watchDatabase->open(dbPath)) {
+        DEBUG_LOG("Failed to open watch database connection, watch mode disabled");
+        m_watchDatabase.reset();
+    }
+    m_fileWatcher = std::make_unique<FileWatcher>();
+
+    // Block chains of parsed files are indexed next to the database
+    BlockIndex::setStorageDirectory(dbPath.parent_path() / "block_index");
+
     DEBUG_LOG("Core components created");
 
     // Initialize UI components
@@ -210,12 +270,18 @@ bool App::init() {
         m_tagFilter = tag;
     });
 
+    s_fileView->setCompareCallback([this](const BlendFileInfo& older, const BlendFileInfo& newer) {
+        compareVersions(older, newer);
+    });
+
     s_searchBar->setSearchCallback([this](const std::string& query) {
         m_searchQuery = query;
     });
 
     m_currentPath = std::filesystem::current_path();
 
+    updateWatcher(m_database->getAllScanLocations());
+
     // Database loading is deferred to after first frame renders
     // to keep the window responsive during startup
 
@@ -259,6 +325,9 @@ void App::run() {
         m_thumbnailCache->processLoadedThumbnails();
         auto thumbProcMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - processStart).count();
 
+        // Remember files the thumbnail loaders found to have no thumbnail
+        m_database->markNoThumbnail(m_thumbnailCache->takeNoThumbnailResults());
+
         m_previewCache->processLoadedPreviews();
         auto previewProcMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - processStart).count() - thumbProcMs;
 
@@ -291,36 +360,20 @@ void App::run() {
             DEBUG_LOG("Frame " << m_frameCount << " starting render");
         }
 
-        // Check for scan completion (with timing for early frames)
-        auto scanCheckStart = std::chrono::steady_clock::now();
-        if (m_isScanning && m_scanner->isComplete()) {
-            auto results = m_scanner->pollResults();
-
-            // Save files to database
-            auto locations = m_database->getAllScanLocations();
-            int64_t locationId = 0;
-            for (const auto& loc : locations) {
-                if (m_currentPath.string().find(loc.path.string()) == 0) {
-                    locationId = loc.id;
-                    break;
-                }
-            }
-
-            for (const auto& file : results) {
-                m_database->addOrUpdateFile(file, locationId);
-            }
+        // Start rescans the watcher asked for
+        processWatchChanges();
 
-            // Check if we have more locations to scan
-            m_scanLocationIndex++;
-            if (m_scanLocationIndex < static_cast<int>(m_pendingScanLocations.size())) {
-                const auto& nextLoc = m_pendingScanLocations[m_scanLocationIndex];
-                m_currentPath = nextLoc.path;
-                m_scanner->startScan(nextLoc.path, nextLoc.recursive);
-            } else {
-                m_isScanning = false;
-                m_pendingScanLocations.clear();
-                startBackgroundLoad();
-            }
+        // Store scan results, finish scans and start queued ones
+        auto scanCheckStart = std::chrono::steady_clock::now();
+        processScans();
+
+        // Show files stored by the scan or the watcher; while scanning,
+        // reload at most every SCAN_RELOAD_INTERVAL
+        if (m_filesStored && !m_isLoading &&
+            (!m_isScanning || scanCheckStart - m_lastStoredReload >= SCAN_RELOAD_INTERVAL)) {
+            m_filesStored = false;
+            m_lastStoredReload = scanCheckStart;
+            startBackgroundLoad();
         }
 
         // Time the scan check
@@ -401,6 +454,12 @@ void App::shutdown() {
     delete s_fileView;
     delete s_searchBar;
 
+    // The scanners' writer threads and the watcher use their own connections
+    m_queuedScans.clear();
+    m_activeScans.clear();  // Stops and joins each scan
+    m_fileWatcher->stop();
+    if (m_scanDatabase) m_scanDatabase->close();
+    if (m_watchDatabase) m_watchDatabase->close();
     m_database->close();
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -413,6 +472,7 @@ void App::shutdown() {
 
 void App::loadFromDatabase() {
     auto files = m_database->getAllFiles();
+    m_thumbnailCache->setNoThumbnailFiles(noThumbnailFiles(files));
     m_fileGroups = VersionGrouper::groupFiles(files);
     DEBUG_LOG("Loaded " << files.size() << " files from database, " << m_fileGroups.size() << " groups");
 }
@@ -431,6 +491,8 @@ void App::startBackgroundLoad() {
         auto dbTime = std::chrono::steady_clock::now();
         DEBUG_LOG("Database query took: " << std::chrono::duration_cast<std::chrono::milliseconds>(dbTime - startTime).count() << "ms");
 
+        m_thumbnailCache->setNoThumbnailFiles(noThumbnailFiles(files));
+
         auto groups = VersionGrouper::groupFiles(files);
         auto groupTime = std::chrono::steady_clock::now();
         DEBUG_LOG("Grouping took: " << std::chrono::duration_cast<std::chrono::milliseconds>(groupTime - dbTime).count() << "ms");
@@ -451,6 +513,8 @@ void App::checkBackgroundLoadComplete() {
             std::lock_guard<std::mutex> lock(m_loadMutex);
             m_fileGroups = std::move(m_loadedGroups);
         }
+        // Files stored since the last load may match the current search
+        s_fileView->invalidateDatablockMatches();
 
         m_isLoading = false;
         m_loadComplete = false;
@@ -528,6 +592,7 @@ void App::renderUI() {
     renderStatisticsDialog();
     renderBulkTagDialog();
     renderPreloadDialog();
+    renderVersionDiffDialog();
 
     auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - uiStart).count();
 
@@ -551,6 +616,9 @@ void App::renderMenuBar() {
             if (ImGui::MenuItem("Check for New Files...", "Ctrl+N")) {
                 checkForNewFiles();
             }
+            if (ImGui::MenuItem("Watch Locations for Changes", nullptr, &m_watchEnabled, m_watchDatabase != nullptr)) {
+                updateWatcher(m_database->getAllScanLocations());
+            }
             if (ImGui::MenuItem("Generate New Previews...", nullptr, false, !m_previewCache->isGenerating())) {
                 startPreviewGeneration(false);
             }
@@ -726,6 +794,9 @@ void App::renderScanLocations() {
             m_locationGroupCounts[loc.id] = groups.size();
         }
         m_locationsUpdateFrame = m_frameCount;
+
+        // Follow added, removed and edited locations
+        updateWatcher(m_cachedScanLocations);
     }
 
     if (m_cachedScanLocations.empty()) {
@@ -856,11 +927,51 @@ void App::renderScanLocations() {
                 ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.3f, 1.0f), "Already covered by '%s'", parentFolder.c_str());
             }
 
+            // Include/exclude rules
+            if (!loc.excludePatterns.empty()) {
+                std::string rules = PathFilter::joinPatterns(loc.excludePatterns);
+                std::replace(rules.begin(), rules.end(), '\n', ' ');
+                ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Skipping: %s", rules.c_str());
+            }
+            if (!loc.includePatterns.empty()) {
+                std::string rules = PathFilter::joinPatterns(loc.includePatterns);
+                std::replace(rules.begin(), rules.end(), '\n', ' ');
+                ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Only: %s", rules.c_str());
+            }
+
+            // Datablock names need every block read, so they are opt-in per location
+            bool indexDatablocks = loc.indexDatablocks;
+            if (m_isScanning) ImGui::BeginDisabled();
+            if (ImGui::Checkbox("Index datablock names", &indexDatablocks)) {
+                ScanLocation updated = loc;
+                updated.indexDatablocks = indexDatablocks;
+                m_database->updateScanLocation(updated);
+                m_locationsUpdateFrame = -1000;  // Force refresh
+                // Unchanged files are skipped by scans; read them all once for their names
+                if (indexDatablocks) startScan(loc.path, true);
+            }
+            if (m_isScanning) ImGui::EndDisabled();
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Search objects, materials and linked files by name\n"
+                                  "Scans read whole files instead of just the thumbnail");
+            }
+
             // Action buttons
             if (ImGui::SmallButton("Scan")) {
                 startScan(loc.path, true);
             }
             ImGui::SameLine();
+            if (ImGui::SmallButton("Rules")) {
+                m_editRulesLocationId = m_editRulesLocationId == loc.id ? 0 : loc.id;
+                snprintf(m_editExcludeRules, sizeof(m_editExcludeRules), "%s",
+                         PathFilter::joinPatterns(loc.excludePatterns).c_str());
+                snprintf(m_editIncludeRules, sizeof(m_editIncludeRules), "%s",
+                         PathFilter::joinPatterns(loc.includePatterns).c_str());
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Folders and files to skip, or the only files to scan");
+            }
+            ImGui::SameLine();
             ImGui::PushStyleColor(ImGuiCol_Button, isRedundant ? ImVec4(0.7f, 0.5f, 0.2f, 1.0f) : ImVec4(0.5f, 0.2f, 0.2f, 1.0f));
             if (ImGui::SmallButton(isRedundant ? "Remove Duplicate" : "Remove")) {
                 m_database->removeScanLocation(loc.id);
@@ -868,6 +979,30 @@ void App::renderScanLocations() {
             }
             ImGui::PopStyleColor();
 
+            if (m_editRulesLocationId == loc.id) {
+                float boxHeight = ImGui::GetTextLineHeight() * 4.5f;
+                ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Skip (one pattern per line):");
+                ImGui::InputTextMultiline("##exclude", m_editExcludeRules, sizeof(m_editExcludeRules), ImVec2(-1, boxHeight));
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Names match at any depth: .git, node_modules, *_autosave.blend\n"
+                                      "Paths match from this folder: renders/final, /cache\n"
+                                      "A trailing / only matches folders; ** matches across folders");
+                }
+                ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Only scan (empty = all .blend files):");
+                ImGui::InputTextMultiline("##include", m_editIncludeRules, sizeof(m_editIncludeRules), ImVec2(-1, boxHeight));
+
+                // A scan in progress would add back files the new rules exclude
+                if (m_isScanning) ImGui::BeginDisabled();
+                if (ImGui::SmallButton("Save Rules")) {
+                    saveLocationRules(loc);
+                }
+                if (m_isScanning) ImGui::EndDisabled();
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Cancel")) {
+                    m_editRulesLocationId = 0;
+                }
+            }
+
             ImGui::TreePop();
         }
 
@@ -920,10 +1055,11 @@ void App::renderMainContent() {
     }
 
     if (m_isScanning) {
-        auto [scanned, total] = m_scanner->getProgress();
+        auto [scanned, total] = getScanProgress();
         ImGui::Text("Scanning... %d / %d files", scanned, total);
-        if (m_pendingScanLocations.size() > 1) {
-            ImGui::Text("Location %d of %zu", m_scanLocationIndex + 1, m_pendingScanLocations.size());
+        if (m_scansRequested > 1) {
+            ImGui::Text("%d of %d locations done, %zu scanning", m_scansFinished, m_scansRequested,
+                        m_activeScans.size());
         }
         ImGui::ProgressBar(total > 0 ? static_cast<float>(scanned) / total : 0.0f);
     } else if (m_fileGroups.empty()) {
@@ -978,7 +1114,7 @@ void App::renderStatusBar() {
         if (m_needsInitialLoad || m_isLoading) {
             ImGui::TextDisabled("(Loading database...)");
         } else if (m_isScanning) {
-            auto [scanned, total] = m_scanner->getProgress();
+            auto [scanned, total] = getScanProgress();
             ImGui::TextDisabled("(Scanning %d/%d...)", scanned, total);
         } else if (m_previewCache->isGenerating()) {
             auto [current, total] = m_previewCache->getProgress();
@@ -1039,43 +1175,250 @@ void App::startScan(const std::filesystem::path& path, bool forceRescan) {
     if (m_isScanning) return;
 
     m_currentPath = path;
-    m_pendingScanLocations.clear();
-    m_scanLocationIndex = 0;
 
     // Get location info for recursive setting
     auto locations = m_database->getAllScanLocations();
-    bool recursive = true;
+    ScanLocation tempLoc;
+    tempLoc.path = path;
+    tempLoc.recursive = true;
     for (const auto& loc : locations) {
         if (loc.path == path) {
-            recursive = loc.recursive;
+            tempLoc.id = loc.id;
+            tempLoc.recursive = loc.recursive;
             break;
         }
     }
 
-    ScanLocation tempLoc;
-    tempLoc.path = path;
-    tempLoc.recursive = recursive;
-    m_pendingScanLocations.push_back(tempLoc);
-
-    m_isScanning = true;
-    m_scanner->startScan(path, recursive);
+    // A rescan of one location lists every directory again
+    queueScan(tempLoc, !forceRescan);
 }
 
 void App::scanAllLocations() {
     if (m_isScanning) return;
 
-    m_pendingScanLocations = m_database->getAllScanLocations();
-    if (m_pendingScanLocations.empty()) {
+    auto locations = m_database->getAllScanLocations();
+    if (locations.empty()) {
         DEBUG_LOG("No scan locations configured");
         return;
     }
 
-    m_scanLocationIndex = 0;
-    m_isScanning = true;
-    m_currentPath = m_pendingScanLocations[0].path;
-    m_scanner->startScan(m_pendingScanLocations[0].path, m_pendingScanLocations[0].recursive);
+    for (const auto& location : locations) {
+        queueScan(location, true);
+    }
+
+    DEBUG_LOG("Starting scan of " << locations.size() << " locations");
+}
+
+void App::queueScan(const ScanLocation& location, bool incremental) {
+    if (!m_isScanning) {
+        m_scansRequested = 0;
+        m_scansFinished = 0;
+        m_finishedScanProgress = {0, 0};
+        m_isScanning = true;
+    }
+
+    QueuedScan queued;
+    queued.location = location;
+    queued.device = StorageDevice::of(location.path);
+    queued.incremental = incremental;
+    m_queuedScans.push_back(std::move(queued));
+    ++m_scansRequested;
+
+    startQueuedScans();
+}
+
+void App::startQueuedScans() {
+    // Locations on different devices run side by side; each device takes
+    // as many at once as its limits allow, in the order they were queued
+    std::unordered_map<std::string, unsigned> running;
+    for (const auto& active : m_activeScans) {
+        ++running[active.device.key];
+    }
+
+    for (auto it = m_queuedScans.begin(); it != m_queuedScans.end();) {
+        unsigned& count = running[it->device.key];
+        if (count >= it->device.limits().scans) {
+            ++it;
+            continue;
+        }
+        ++count;
+        startLocationScan(*it);
+        it = m_queuedScans.erase(it);
+    }
+}
+
+void App::startLocationScan(const QueuedScan& queued) {
+    const ScanLocation& location = queued.location;
+
+    ActiveScan active;
+    active.location = location;
+    active.device = queued.device;
+
+    PathFilter pathFilter;
+    bool indexDatablocks = false;
+    auto locations = m_database->getAllScanLocations();
+    const ScanLocation* owner = nullptr;
+    if (location.id > 0) {
+        auto it = std::find_if(locations.begin(), locations.end(),
+                               [&](const ScanLocation& loc) { return loc.id == location.id; });
+        if (it != locations.end()) owner = &*it;
+    }
+    if (!owner) {
+        owner = owningLocation(locations, location.path);
+    }
+    if (owner) {
+        active.scanLocationId = owner->id;
+        // Rules are relative to the location, also when scanning a subfolder
+        pathFilter = PathFilter(owner->path, owner->includePatterns, owner->excludePatterns);
+        indexDatablocks = owner->indexDatablocks;
+        // Directory records describe a location's whole tree, not a subfolder
+        if (owner->path == location.path && owner->recursive) {
+            active.trackedScanLocationId = owner->id;
+        }
+    }
+
+    ScanLimits limits = active.device.limits();
+    active.scanner = std::make_unique<Scanner>();
+    active.scanner->setIndexDatablocks(indexDatablocks);    // Opt-in: reads every block, not just the head
+    active.scanner->setCacheUse(BlendParser::CacheUse::Bulk);   // Keep the user's working set cached
+    active.scanner->setWalkConcurrency(limits.walkConcurrency);
+    active.scanner->setParseThreads(limits.parseThreads);
+    if (active.device.kind == StorageDevice::Kind::Rotational) {
+        // One sweep across the platter instead of a seek per directory
+        active.scanner->setParseOrder(Scanner::ParseOrder::Disk);
+    }
+
+    // Full scans start from no records and save fresh ones when done
+    std::vector<DirectoryRecord> previousDirectories;
+    if (active.trackedScanLocationId > 0) {
+        // An interrupted scan left a journal: what it finished is skipped
+        // and what it found is walked. Journal records go first, so they
+        // win over the older records of the last complete scan.
+        previousDirectories = m_database->getScanJournal(active.trackedScanLocationId);
+        if (!previousDirectories.empty()) {
+            DEBUG_LOG("Resuming scan of " << location.path << " from " << previousDirectories.size()
+                      << " journaled directories");
+        }
+        if (queued.incremental) {
+            auto recorded = m_database->getScanDirectories(active.trackedScanLocationId);
+            previousDirectories.insert(previousDirectories.end(), std::make_move_iterator(recorded.begin()),
+                                       std::make_move_iterator(recorded.end()));
+        }
+    }
+    active.scanner->setPreviousDirectories(std::move(previousDirectories));
+    active.scanner->setPathFilter(std::move(pathFilter));
+
+    // The datablock walk reads previews too; caching them saves parsing
+    // the file again when they are browsed
+    if (indexDatablocks) {
+        active.scanner->setPreviewCallback(previewCacher(m_thumbnailCache.get()));
+    }
+
+    // Parsed files go straight to the database from the scanner's writer
+    // thread; scans running side by side take turns on the connection
+    if (m_scanDatabase) {
+        active.scanner->setBatchCallback([this, db = m_scanDatabase.get(), locationId = active.scanLocationId](
+                                             std::vector<BlendFileInfo>& batch) {
+            std::lock_guard<std::mutex> lock(m_scanWriteMutex);
+            db->addOrUpdateFiles(batch, locationId);
+            m_filesStored = true;
+        });
+
+        // Walk progress is journaled after the files it covers, so a scan
+        // cut short by stopScan() or closing the app resumes from there
+        if (active.trackedScanLocationId > 0) {
+            active.scanner->setCheckpointCallback([this, db = m_scanDatabase.get(),
+                                                   locationId = active.trackedScanLocationId](
+                                                      std::vector<DirectoryRecord>& directories) {
+                std::lock_guard<std::mutex> lock(m_scanWriteMutex);
+                db->appendScanJournal(locationId, directories);
+            });
+        }
+    }
+
+    DEBUG_LOG("Scanning " << location.path << " on " << active.device.key << " (" << active.device.kindName()
+              << "), " << m_activeScans.size() + 1 << " scans running");
+
+    active.scanner->setNoThumbnailFiles(m_database->getNoThumbnailFiles());
+    if (queued.incremental) {
+        // Files stored with their current size and mtime aren't parsed or written again
+        active.scanner->setKnownFiles(m_database->getFileStats(location.path));
+    }
+    active.scanner->startScan(location.path, location.recursive);
+    m_activeScans.push_back(std::move(active));
+}
+
+void App::processScans() {
+    if (!m_isScanning) return;
+
+    for (auto it = m_activeScans.begin(); it != m_activeScans.end();) {
+        Scanner& scanner = *it->scanner;
+
+        // Files are stored in batches from the scanner's writer thread;
+        // results are only handed over here when there is no scan connection
+        bool complete = scanner.isComplete();
+        auto results = scanner.pollResults();
+        if (!results.empty()) {
+            m_database->addOrUpdateFiles(results, it->scanLocationId);
+            m_filesStored = true;
+        }
+
+        if (!complete) {
+            ++it;
+            continue;
+        }
+
+        // A stopped scan walked only part of the tree; keep the old records
+        if (it->trackedScanLocationId > 0 && !scanner.wasStopped()) {
+            m_database->replaceScanDirectories(it->trackedScanLocationId, scanner.takeDirectoryRecords());
+        }
+        auto [scanned, total] = scanner.getProgress();
+        m_finishedScanProgress.first += scanned;
+        m_finishedScanProgress.second += total;
+        ++m_scansFinished;
+        it = m_activeScans.erase(it);
+    }
+
+    // Finished scans free their device for the next location
+    startQueuedScans();
+
+    if (m_activeScans.empty() && m_queuedScans.empty()) {
+        m_isScanning = false;
+        m_filesStored = true;
+    }
+}
+
+std::pair<int, int> App::getScanProgress() const {
+    auto progress = m_finishedScanProgress;
+    for (const auto& active : m_activeScans) {
+        auto [scanned, total] = active.scanner->getProgress();
+        progress.first += scanned;
+        progress.second += total;
+    }
+    return progress;
+}
+
+void App::saveLocationRules(ScanLocation location) {
+    location.excludePatterns = PathFilter::splitPatterns(m_editExcludeRules);
+    location.includePatterns = PathFilter::splitPatterns(m_editIncludeRules);
+    m_database->updateScanLocation(location);
+
+    // Files the new rules exclude leave the library now; files they newly
+    // include arrive with the next scan
+    PathFilter filter(location.path, location.includePatterns, location.excludePatterns);
+    int removed = 0;
+    for (const auto& file : m_database->getFilesByScanLocation(location.id)) {
+        if (!filter.matchesFile(file.path)) {
+            m_database->removeFileByPath(file.path);
+            BlockIndex::remove(file.path);
+            ++removed;
+        }
+    }
+    DEBUG_LOG("Saved rules for " << location.path << ", removed " << removed << " excluded files");
 
-    DEBUG_LOG("Starting scan of " << m_pendingScanLocations.size() << " locations");
+    m_editRulesLocationId = 0;
+    m_locationsUpdateFrame = -1000;  // Force refresh
+    if (removed > 0) m_filesStored = true;
 }
 
 // Helper to escape shell special characters for safe use in double quotes
@@ -1092,12 +1435,129 @@ static std::string escapeShellArg(const std::string& arg) {
     return result;
 }
 
+void App::updateWatcher(const std::vector<ScanLocation>& locations) {
+    if (!m_watchEnabled || !m_watchDatabase) {
+        m_fileWatcher->stop();
+        m_watchedLocations.clear();
+        return;
+    }
+
+    auto sameLocation = [](const ScanLocation& a, const ScanLocation& b) {
+        return a.id == b.id && a.path == b.path && a.recursive == b.recursive && a.enabled == b.enabled &&
+               a.includePatterns == b.includePatterns && a.excludePatterns == b.excludePatterns &&
+               a.indexDatablocks == b.indexDatablocks;
+    };
+    if (m_fileWatcher->isRunning() &&
+        std::equal(locations.begin(), locations.end(), m_watchedLocations.begin(), m_watchedLocations.end(),
+                   sameLocation)) {
+        return;
+    }
+
+    // Copied into the callback: the watcher thread never reads m_watchedLocations
+    std::set<int64_t> indexingLocations;
+    for (const auto& location : locations) {
+        if (location.indexDatablocks) indexingLocations.insert(location.id);
+    }
+
+    m_watchedLocations = locations;
+    m_fileWatcher->start(locations, [this, indexingLocations](std::vector<WatchEvent>& events) {
+        handleWatchEvents(events, indexingLocations);
+    });
+}
+
+void App::handleWatchEvents(std::vector<WatchEvent>& events, const std::set<int64_t>& indexingLocations) {
+    // Runs on the watcher thread; only touches the watch connection
+    std::map<int64_t, std::vector<BlendFileInfo>> changed;
+    bool stored = false;
+
+    for (const auto& event : events) {
+        switch (event.type) {
+            case WatchEvent::Type::Changed: {
+                // Parsed like a scan of the owning location would; Bulk keeps
+                // a large file that was saved from elsewhere out of the cache
+                auto stat = FileStat::read(event.path);
+                if (!stat) break;  // Deleted since it settled; nothing to store
+                bool indexDatablocks = indexingLocations.count(event.scanLocationId) > 0;
+                changed[event.scanLocationId].push_back(
+                    Scanner::parseFile(event.path, *stat, indexDatablocks, BlendParser::CacheUse::Bulk,
+                                       indexDatablocks ? previewCacher(m_thumbnailCache.get()) : nullptr));
+                break;
+            }
+            case WatchEvent::Type::Removed:
+                if (event.isDirectory) {
+                    m_watchDatabase->removeFilesInDirectory(event.path);
+                } else {
+                    m_watchDatabase->removeFileByPath(event.path);
+                    BlockIndex::remove(event.path);
+                }
+                stored = true;
+                break;
+            case WatchEvent::Type::Rescan: {
+                std::lock_guard<std::mutex> lock(m_watchMutex);
+                m_watchRescans.push_back(event.path);
+                break;
+            }
+        }
+    }
+
+    for (const auto& [scanLocationId, files] : changed) {
+        m_watchDatabase->addOrUpdateFiles(files, scanLocationId);
+        stored = true;
+    }
+
+    DEBUG_LOG("Watch: stored " << events.size() << " changes");
+    if (stored) m_filesStored = true;
+}
+
+void App::processWatchChanges() {
+    if (m_isScanning) return;
+
+    std::filesystem::path rescan;
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        if (!m_watchRescans.empty()) {
+            rescan = m_watchRescans.front();
+            m_watchRescans.erase(m_watchRescans.begin());
+        }
+    }
+    if (!rescan.empty()) {
+        startScan(rescan, false);
+    }
+}
+
 void App::openInBlender(const std::filesystem::path& path) {
     std::string escapedPath = escapeShellArg(path.string());
     std::string command = "blender \"" + escapedPath + "\" &";
     std::system(command.c_str());
 }
 
+void App::compareVersions(const BlendFileInfo& older, const BlendFileInfo& newer) {
+    if (m_isDiffing) return;  // One comparison at a time
+    if (m_diffThread.joinable()) {
+        m_diffThread.join();
+    }
+
+    m_diffOlderName = older.filename;
+    m_diffNewerName = newer.filename;
+    {
+        std::lock_guard<std::mutex> lock(m_diffMutex);
+        m_diffResult.reset();
+    }
+    m_isDiffing = true;
+    m_showVersionDiffDialog = true;
+
+    // Hashing reads both files whole unless their digests are cached
+    m_diffThread = std::jthread([this, olderPath = older.path, newerPath = newer.path] {
+        BlockDiff differ;
+        auto result = differ.compare(olderPath, newerPath);
+        {
+            std::lock_guard<std::mutex> lock(m_diffMutex);
+            m_diffResult = std::move(result);
+        }
+        m_isDiffing = false;
+    });
+}
+
 void App::openContainingFolder(const std::filesystem::path& path) {
     std::string escapedPath = escapeShellArg(path.parent_path().string());
     std::string command = "xdg-open \"" + escapedPath + "\" &";
@@ -1308,7 +1768,7 @@ void App::renderPreviewGenerationDialog() {
             }
 
             ImGui::Spacing();
-            ImGui::TextWrapped("This runs Blender in the background to render rotation frames. This may take a while.");
+            ImGui::TextWrapped("Rotation frames are rendered in the background, using Blender for files without meshes. This may take a while.");
 
             ImGui::Spacing();
             if (ImGui::Button("Cancel", ImVec2(120, 0))) {
@@ -1357,6 +1817,7 @@ void App::renderUserGuide() {
 
         if (ImGui::CollapsingHeader("Browsing Files")) {
             ImGui::BulletText("Use the search bar to filter files by name");
+            ImGui::BulletText("Search also finds files by the objects, materials and collections they contain");
             ImGui::BulletText("Click on a file to select it");
             ImGui::BulletText("Double-click to open in Blender");
             ImGui::BulletText("Right-click for context menu options");
@@ -1397,10 +1858,10 @@ void App::renderUserGuide() {
             ImGui::BulletText("Features the 5 largest objects in each scene");
             ImGui::BulletText("Each object is shown individually, fit to frame");
             ImGui::BulletText("Camera rotates around each object in sequence");
-            ImGui::BulletText("Requires Blender to be installed and in your PATH");
+            ImGui::BulletText("Meshes are rendered built-in; other files need Blender in your PATH");
             ImGui::BulletText("Previews are cached in ~/.cache/BlenderFileFinder/");
             ImGui::Spacing();
-            ImGui::TextDisabled("Note: Preview generation can take several seconds per file.");
+            ImGui::TextDisabled("Note: Rendering with Blender can take several seconds per file.");
         }
 
         if (ImGui::CollapsingHeader("Keyboard Shortcuts")) {
@@ -1809,6 +2270,79 @@ void App::renderPreloadDialog() {
     }
 }
 
+void App::renderVersionDiffDialog() {
+    if (!m_showVersionDiffDialog) {
+        return;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetCenter(), ImGuiCond_FirstUseEver, ImVec2(0.5f, 0.5f));
+
+    if (ImGui::Begin("Version Changes", &m_showVersionDiffDialog, ImGuiWindowFlags_NoCollapse)) {
+        ImGui::Text("%s", m_diffNewerName.c_str());
+        ImGui::SameLine();
+        ImGui::TextDisabled("compared with %s", m_diffOlderName.c_str());
+        ImGui::Separator();
+
+        if (m_isDiffing) {
+            ImGui::TextDisabled("Comparing datablocks...");
+        } else {
+            std::lock_guard<std::mutex> lock(m_diffMutex);
+            if (!m_diffResult) {
+                ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Couldn't read the datablocks of both files.");
+            } else if (m_diffResult->changes.empty()) {
+                ImGui::Text("No datablocks changed (%zu unchanged).", m_diffResult->unchangedCount);
+            } else {
+                ImGui::Text("%zu changed, %zu unchanged", m_diffResult->changes.size(), m_diffResult->unchangedCount);
+
+                ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+                if (ImGui::BeginTable("VersionChanges", 4, flags)) {
+                    ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+                    ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 40.0f);
+                    ImGui::TableSetupColumn("Name");
+                    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+                    ImGui::TableHeadersRow();
+
+                    for (const auto& change : m_diffResult->changes) {
+                        ImGui::TableNextRow();
+
+                        ImGui::TableNextColumn();
+                        switch (change.kind) {
+                            case DatablockChange::Kind::Added:
+                                ImGui::TextColored(ImVec4(0.4f, 0.8f, 0.4f, 1.0f), "Added");
+                                break;
+                            case DatablockChange::Kind::Removed:
+                                ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Removed");
+                                break;
+                            case DatablockChange::Kind::Changed:
+                                ImGui::TextColored(ImVec4(0.9f, 0.8f, 0.4f, 1.0f), "Changed");
+                                break;
+                        }
+
+                        ImGui::TableNextColumn();
+                        ImGui::TextDisabled("%s", change.type.c_str());
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%s", change.name.c_str());
+
+                        // Payload bytes, so sizes show how much of a datablock changed
+                        ImGui::TableNextColumn();
+                        if (change.kind == DatablockChange::Kind::Changed) {
+                            ImGui::Text("%llu -> %llu B", static_cast<unsigned long long>(change.oldSize),
+                                        static_cast<unsigned long long>(change.newSize));
+                        } else {
+                            uint64_t size = change.kind == DatablockChange::Kind::Added ? change.newSize : change.oldSize;
+                            ImGui::Text("%llu B", static_cast<unsigned long long>(size));
+                        }
+                    }
+                    ImGui::EndTable();
+                }
+            }
+        }
+    }
+    ImGui::End();
+}
+
 void App::setWindowIcon() {
     // Search for icon in common locations
     std::vector<std::filesystem::path> searchPaths = {
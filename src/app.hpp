@@ -5,11 +5,16 @@
 
 #pragma once
 
+#include "block_diff.hpp"
 #include "database.hpp"
+#include "storage_device.hpp"
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <filesystem>
 #include <thread>
 #include <atomic>
@@ -23,7 +28,9 @@ class Scanner;
 class ThumbnailCache;
 class VersionGrouper;
 class PreviewCache;
+class FileWatcher;
 struct FileGroup;
+struct WatchEvent;
 
 /**
  * @brief Main application controller for Blender File Finder.
@@ -77,6 +84,26 @@ public:
     void shutdown();
 
 private:
+    /**
+     * @brief A location waiting for its device to have a free scan slot.
+     */
+    struct QueuedScan {
+        ScanLocation location;
+        StorageDevice device;
+        bool incremental = false;               ///< Skip directories unchanged since the last scan
+    };
+
+    /**
+     * @brief A location being scanned by its own Scanner.
+     */
+    struct ActiveScan {
+        ScanLocation location;
+        StorageDevice device;
+        int64_t scanLocationId = 0;             ///< Location the scan stores files under
+        int64_t trackedScanLocationId = 0;      ///< Location whose directory mtimes the scan records
+        std::unique_ptr<Scanner> scanner;
+    };
+
     /// @name UI Rendering
     /// @{
     void renderUI();
@@ -93,31 +120,44 @@ private:
     void renderStatisticsDialog();
     void renderBulkTagDialog();
     void renderPreloadDialog();
+    void renderVersionDiffDialog();
     /// @}
 
     /// @name Actions
     /// @{
     void startScan(const std::filesystem::path& path, bool forceRescan = false);
     void scanAllLocations();
+    void queueScan(const ScanLocation& location, bool incremental);
+    void startQueuedScans();
+    void startLocationScan(const QueuedScan& queued);
+    void processScans();
+    std::pair<int, int> getScanProgress() const;
+    void saveLocationRules(ScanLocation location);
     void loadFromDatabase();
     void startBackgroundLoad();
     void checkBackgroundLoadComplete();
     void openInBlender(const std::filesystem::path& path);
     void openContainingFolder(const std::filesystem::path& path);
+    void compareVersions(const BlendFileInfo& older, const BlendFileInfo& newer);
     void checkForNewFiles();
     void startPreviewGeneration(bool forceRegenerate = false);
     void setWindowIcon();
+    void updateWatcher(const std::vector<ScanLocation>& locations);
+    void handleWatchEvents(std::vector<WatchEvent>& events, const std::set<int64_t>& indexingLocations);
+    void processWatchChanges();
     /// @}
 
     GLFWwindow* m_window = nullptr;             ///< GLFW window handle
 
     /// @name Subsystems
     /// @{
-    std::unique_ptr<Scanner> m_scanner;
     std::unique_ptr<ThumbnailCache> m_thumbnailCache;
     std::unique_ptr<VersionGrouper> m_versionGrouper;
     std::unique_ptr<Database> m_database;
+    std::unique_ptr<Database> m_scanDatabase;   ///< Connection for the scanner's writer thread
     std::unique_ptr<PreviewCache> m_previewCache;
+    std::unique_ptr<FileWatcher> m_fileWatcher;
+    std::unique_ptr<Database> m_watchDatabase;  ///< Connection for the file watcher's thread
     /// @}
 
     /// @name File Data
@@ -130,9 +170,23 @@ private:
 
     /// @name Scan State
     /// @{
-    bool m_isScanning = false;
-    int m_scanLocationIndex = 0;
-    std::vector<ScanLocation> m_pendingScanLocations;
+    bool m_isScanning = false;                  ///< Scans running or queued
+    std::vector<QueuedScan> m_queuedScans;      ///< In the order they were requested
+    std::vector<ActiveScan> m_activeScans;
+    int m_scansRequested = 0;                   ///< Locations in the current round of scans
+    int m_scansFinished = 0;
+    std::pair<int, int> m_finishedScanProgress; ///< Files (scanned, found) by finished scans
+    std::mutex m_scanWriteMutex;                ///< Serializes scanner batches on m_scanDatabase
+    std::atomic<bool> m_filesStored{false};     ///< Scan or watcher stored files since the last reload
+    std::chrono::steady_clock::time_point m_lastStoredReload; ///< When those were last loaded into the view
+    /// @}
+
+    /// @name Watch Mode
+    /// @{
+    bool m_watchEnabled = true;                 ///< Watch scan locations for changes
+    std::vector<ScanLocation> m_watchedLocations; ///< Locations the watcher was started with
+    std::mutex m_watchMutex;                    ///< Protects m_watchRescans
+    std::vector<std::filesystem::path> m_watchRescans; ///< Locations whose events were lost
     /// @}
 
     /// @name View Settings
@@ -151,6 +205,13 @@ private:
     bool m_newLocationRecursive = true;
     /// @}
 
+    /// @name Location Rules Editor
+    /// @{
+    int64_t m_editRulesLocationId = 0;          ///< Location whose rules are being edited (0 = none)
+    char m_editIncludeRules[1024] = {0};        ///< One glob per line
+    char m_editExcludeRules[1024] = {0};        ///< One glob per line
+    /// @}
+
     /// @name New Files Dialog
     /// @{
     bool m_showNewFilesDialog = false;
@@ -193,6 +254,17 @@ private:
     std::string m_preloadCurrentFile;
     /// @}
 
+    /// @name Version Diff Dialog
+    /// @{
+    bool m_showVersionDiffDialog = false;
+    std::string m_diffOlderName;
+    std::string m_diffNewerName;
+    std::atomic<bool> m_isDiffing{false};
+    std::mutex m_diffMutex;
+    std::optional<FileDiff> m_diffResult;       ///< Empty while comparing or if a file couldn't be read
+    std::jthread m_diffThread;
+    /// @}
+
     /// @name Background Loading
     /// @{
     std::atomic<bool> m_isLoading{false};
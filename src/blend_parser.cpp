@@ -1,35 +1,179 @@
 #include "blend_parser.hpp"
+#include "compressed_stream.hpp"
 #include "debug.hpp"
+#include "file_stream.hpp"
+#include "page_cache_hints.hpp"
+#include "sdna.hpp"
 #include <fstream>
 #include <cstring>
 #include <algorithm>
 #include <chrono>
+#include <memory>
+#include <sys/stat.h>
 
 namespace BlenderFileFinder {
 
 namespace {
 
-uint32_t swapBytes32(uint32_t val) {
-    return ((val & 0xFF000000) >> 24) |
-           ((val & 0x00FF0000) >> 8) |
-           ((val & 0x0000FF00) << 8) |
-           ((val & 0x000000FF) << 24);
+// Read ahead for bulk parses; Blender writes the thumbnail right after
+// the render info, well within this
+constexpr uint64_t HEAD_READ_AHEAD = 256 * 1024;
+
+// Blender's DNA1 is a few hundred KB; a larger one is a corrupt header,
+// not something to allocate for
+constexpr int64_t MAX_DNA_BLOCK_SIZE = 8 * 1024 * 1024;
+
+// walkBlocks() decompresses each payload whole; packed files make blocks
+// of hundreds of MB legitimate, but not more than this
+constexpr int64_t MAX_WALK_BLOCK_SIZE = 1024 * 1024 * 1024;
+
+// Compressed payloads are read a chunk at a time, so a size from a corrupt
+// header runs into the end of the stream before it is all allocated
+constexpr size_t WALK_READ_CHUNK = 16 * 1024 * 1024;
+
+// File size for the page cache hints: the caller's stat, else one fstat()
+uint64_t hintFileSize(int fd, const FileStat* stat) {
+    if (stat) return stat->size;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    return static_cast<uint64_t>(st.st_size);
+}
+
+// Payload fetchers for parseIndexed, one per way of reading the file
+
+auto streamFetcher(std::istream& file) {
+    return [&file](uint64_t offset, size_t size, std::vector<uint8_t>& scratch) -> const uint8_t* {
+        scratch.resize(size);
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(reinterpret_cast<char*>(scratch.data()), static_cast<std::streamsize>(size));
+        return file ? scratch.data() : nullptr;
+    };
 }
 
-uint64_t swapBytes64(uint64_t val) {
-    return ((val & 0xFF00000000000000ULL) >> 56) |
-           ((val & 0x00FF000000000000ULL) >> 40) |
-           ((val & 0x0000FF0000000000ULL) >> 24) |
-           ((val & 0x000000FF00000000ULL) >> 8) |
-           ((val & 0x00000000FF000000ULL) << 8) |
-           ((val & 0x0000000000FF0000ULL) << 24) |
-           ((val & 0x000000000000FF00ULL) << 40) |
-           ((val & 0x00000000000000FFULL) << 56);
+auto mappedFetcher(const uint8_t* data, size_t dataSize) {
+    return [data, dataSize](uint64_t offset, size_t size, std::vector<uint8_t>&) -> const uint8_t* {
+        if (offset > dataSize || size > dataSize - offset) return nullptr;
+        return data + offset;
+    };
+}
+
+// Index entries are in file order, so the stream only ever moves forward
+auto compressedFetcher(CompressedStream& stream) {
+    return [&stream](uint64_t offset, size_t size, std::vector<uint8_t>& scratch) -> const uint8_t* {
+        if (offset < stream.position() || !stream.skip(offset - stream.position())) return nullptr;
+        scratch.resize(size);
+        return stream.read(scratch.data(), size) ? scratch.data() : nullptr;
+    };
+}
+
+// Compressed streams can't seek back, so a second pass over a compressed
+// file decompresses it again from the start (opened on first use)
+auto reopeningFetcher(const std::filesystem::path& path) {
+    auto stream = std::make_shared<std::unique_ptr<CompressedStream>>();
+    return [path, stream](uint64_t offset, size_t size, std::vector<uint8_t>& scratch) -> const uint8_t* {
+        if (!*stream) *stream = CompressedStream::open(path);
+        if (!*stream) return nullptr;
+        return compressedFetcher(**stream)(offset, size, scratch);
+    };
+}
+
+// Size and mtime from the caller's stat if it has one, otherwise one statx()
+void fillFileStat(const std::filesystem::path& path, const FileStat* stat, BlendFileInfo& info) {
+    std::optional<FileStat> own;
+    if (!stat) {
+        own = FileStat::read(path);
+        if (!own) return;
+        stat = &*own;
+    }
+    info.fileSize = stat->size;
+    info.modifiedTime = stat->modifiedTime;
 }
 
 } // anonymous namespace
 
-bool BlendParser::readHeader(std::ifstream& file, FileHeader& header) {
+std::filesystem::path BlendParser::resolveStoredPath(const std::filesystem::path& blendFile,
+                                                     const std::string& storedPath) {
+    std::string path = storedPath;
+    std::replace(path.begin(), path.end(), '\\', '/');
+
+    std::filesystem::path resolved;
+    if (path.rfind("//", 0) == 0) {
+        resolved = blendFile.parent_path() / path.substr(2);
+    } else {
+        resolved = path;
+    }
+
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(resolved, ec);
+    return (ec ? resolved : absolute).lexically_normal();
+}
+
+bool BlendParser::walkBlocks(const std::filesystem::path& path, BlendFileLayout& layout, const BlockVisitor& visit) {
+    auto setLayout = [&layout](const FileHeader& header) {
+        layout.blenderVersion = std::string(header.version, 3);
+        layout.blenderVersion.insert(1, ".");
+        layout.is64bit = (header.pointerSize == '-');
+        layout.bigEndian = (header.endianness == 'V');
+    };
+
+    MappedFile mapping;
+    if (!mapping.open(path)) {
+        return false;
+    }
+
+    const uint8_t* data = mapping.data();
+    size_t size = mapping.size();
+    FileHeader header;
+    BlockHeader block;
+
+    if (readHeader(data, size, header)) {
+        setLayout(header);
+        layout.compressed = false;
+        BlockHeaderDecoder decoder = selectDecoder(header);
+
+        size_t offset = FILE_HEADER_SIZE;
+        while (readBlockHeader(data, size, offset, block, decoder)) {
+            if (std::strncmp(block.code, "ENDB", 4) == 0) return true;
+            if (block.size < 0 || static_cast<size_t>(block.size) > size - offset) return false;
+            if (!visit(block, data + offset)) return false;
+            offset += static_cast<size_t>(block.size);
+        }
+        return false;
+    }
+
+    mapping.close();
+    auto stream = CompressedStream::open(path);
+    uint8_t headerBytes[FILE_HEADER_SIZE];
+    if (!stream || !stream->read(headerBytes, sizeof(headerBytes)) ||
+        !readHeader(headerBytes, sizeof(headerBytes), header)) {
+        return false;
+    }
+
+    setLayout(header);
+    layout.compressed = true;
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    uint8_t blockBytes[BlockHeaderDecoder::MAX_SIZE];
+    std::vector<uint8_t> payload;
+    while (stream->read(blockBytes, decoder.size)) {
+        decoder.decode(blockBytes, block);
+        if (std::strncmp(block.code, "ENDB", 4) == 0) return true;
+        if (block.size < 0 || block.size > MAX_WALK_BLOCK_SIZE) return false;
+
+        size_t blockSize = static_cast<size_t>(block.size);
+        payload.clear();
+        while (payload.size() < blockSize) {
+            size_t done = payload.size();
+            payload.resize(done + std::min(blockSize - done, WALK_READ_CHUNK));
+            if (!stream->read(payload.data() + done, payload.size() - done)) return false;
+        }
+        if (!visit(block, payload.data())) return false;
+    }
+    return false;
+}
+
+bool BlendParser::readHeader(std::istream& file, FileHeader& header) {
     file.read(header.magic, 7);
     if (std::strncmp(header.magic, "BLENDER", 7) != 0) {
         return false;
@@ -42,33 +186,20 @@ bool BlendParser::readHeader(std::ifstream& file, FileHeader& header) {
     return file.good();
 }
 
-bool BlendParser::readBlockHeader(std::ifstream& file, BlockHeader& block, bool is64bit, bool bigEndian) {
-    file.read(block.code, 4);
-    if (!file.good()) return false;
-
-    file.read(reinterpret_cast<char*>(&block.size), 4);
-    if (bigEndian) block.size = static_cast<int32_t>(swapBytes32(static_cast<uint32_t>(block.size)));
-
-    if (is64bit) {
-        file.read(reinterpret_cast<char*>(&block.oldAddress), 8);
-        if (bigEndian) block.oldAddress = swapBytes64(block.oldAddress);
-    } else {
-        uint32_t addr32;
-        file.read(reinterpret_cast<char*>(&addr32), 4);
-        if (bigEndian) addr32 = swapBytes32(addr32);
-        block.oldAddress = addr32;
-    }
-
-    file.read(reinterpret_cast<char*>(&block.sdnaIndex), 4);
-    if (bigEndian) block.sdnaIndex = static_cast<int32_t>(swapBytes32(static_cast<uint32_t>(block.sdnaIndex)));
+BlockHeaderDecoder BlendParser::selectDecoder(const FileHeader& header) {
+    return BlockHeaderDecoder::select(header.pointerSize == '-', header.endianness == 'V');
+}
 
-    file.read(reinterpret_cast<char*>(&block.count), 4);
-    if (bigEndian) block.count = static_cast<int32_t>(swapBytes32(static_cast<uint32_t>(block.count)));
+bool BlendParser::readBlockHeader(std::istream& file, BlockHeader& block, const BlockHeaderDecoder& decoder) {
+    uint8_t bytes[BlockHeaderDecoder::MAX_SIZE];
+    file.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(decoder.size));
+    if (!file.good()) return false;
 
-    return file.good();
+    decoder.decode(bytes, block);
+    return true;
 }
 
-std::optional<BlendThumbnail> BlendParser::extractThumbnail(std::ifstream& file, const BlockHeader& block) {
+std::optional<BlendThumbnail> BlendParser::extractThumbnail(std::istream& file, const BlockHeader& block) {
     if (block.size < 8) return std::nullopt;
 
     // Read thumbnail dimensions
@@ -93,37 +224,457 @@ std::optional<BlendThumbnail> BlendParser::extractThumbnail(std::ifstream& file,
     thumbnail.height = height;
     thumbnail.pixels.resize(pixelDataSize);
 
-    file.read(reinterpret_cast<char*>(thumbnail.pixels.data()), pixelDataSize);
+    // Blender stores thumbnails flipped vertically - read the rows bottom-up
+    // so they land upright without a second buffer
+    size_t rowSize = static_cast<size_t>(width) * 4;
+    for (int y = height - 1; y >= 0; --y) {
+        file.read(reinterpret_cast<char*>(thumbnail.pixels.data() + y * rowSize),
+                  static_cast<std::streamsize>(rowSize));
+    }
 
     if (!file.good()) return std::nullopt;
 
-    // Blender stores thumbnails flipped vertically - flip them back
-    std::vector<uint8_t> flipped(pixelDataSize);
-    size_t rowSize = width * 4;
-    for (int y = 0; y < height; ++y) {
-        std::memcpy(flipped.data() + y * rowSize,
-                    thumbnail.pixels.data() + (height - 1 - y) * rowSize,
-                    rowSize);
+    return thumbnail;
+}
+
+bool BlendParser::isIdCode(const char* code, const char* id) {
+    // ID block codes are two characters padded with NULs ("ME\0\0"), so a
+    // prefix compare would also match longer codes that start the same way
+    return code[0] == id[0] && code[1] == id[1] && code[2] == '\0' && code[3] == '\0';
+}
+
+bool BlendParser::isPastThumbnail(const BlockHeader& block) {
+    // Blender writes REND, TEST, GLOB and then the ID blocks, each followed
+    // by its DATA blocks. Once any of the later ones shows up there is no
+    // TEST block left to find.
+    if (std::strncmp(block.code, "GLOB", 4) == 0 || std::strncmp(block.code, "DATA", 4) == 0) {
+        return true;
     }
-    thumbnail.pixels = std::move(flipped);
+    return isIdBlock(block);
+}
 
-    return thumbnail;
+void BlendParser::countBlock(const BlockHeader& block, BlendMetadata& metadata) {
+    // OB block = Object
+    if (isIdCode(block.code, "OB")) {
+        metadata.objectCount += block.count;
+    }
+    // ME block = Mesh
+    else if (isIdCode(block.code, "ME")) {
+        metadata.meshCount += block.count;
+    }
+    // MA block = Material
+    else if (isIdCode(block.code, "MA")) {
+        metadata.materialCount += block.count;
+    }
+    // TE block = Texture (TX is a Text datablock, not a texture)
+    else if (isIdCode(block.code, "TE")) {
+        metadata.textureCount += block.count;
+    }
+}
+
+bool BlendParser::isIdBlock(const BlockHeader& block) {
+    return block.code[0] != '\0' && block.code[2] == '\0' && block.code[3] == '\0';
+}
+
+size_t BlendParser::idHeadSize(const BlockHeader& block) {
+    size_t limit = ID_HEAD_BYTES;
+    if (isIdCode(block.code, "ME")) {
+        limit = MESH_HEAD_BYTES;
+    } else if (isIdCode(block.code, "IM") || isIdCode(block.code, "LI")) {
+        limit = REFERENCE_HEAD_BYTES;
+    }
+    return std::min(static_cast<size_t>(block.size), limit);
+}
+
+std::vector<uint8_t>& BlendParser::keepIdBlock(FullParseState& state, const BlockHeader& block,
+                                               uint64_t payloadOffset, size_t headSize) {
+    FullParseState::IdBlock& kept = state.idBlocks.emplace_back();
+    kept.code[0] = block.code[0];
+    kept.code[1] = block.code[1];
+    kept.sdnaIndex = block.sdnaIndex;
+    kept.offset = payloadOffset;
+    kept.head.resize(headSize);
+    return kept.head;
+}
+
+void BlendParser::finishFullParse(const FullParseState& state, const BlockIndex& chain,
+                                  bool is64bit, bool bigEndian, BlendMetadata& metadata) {
+    if (state.dna.empty() || state.idBlocks.empty()) return;
+
+    auto sdna = Sdna::get(metadata.blenderVersion, state.dna.data(), state.dna.size(), is64bit, bigEndian);
+    if (!sdna) return;
+
+    readDatablockNames(*sdna, state, metadata);
+    readMeshTotals(*sdna, state, metadata);
+    readReferences(*sdna, state, metadata);
+    if (state.previews && state.previewFetch) {
+        readPreviews(*sdna, state, chain, *state.previews);
+    }
+}
+
+bool BlendParser::readIdName(const FullParseState::IdBlock& block, size_t nameOffset, size_t nameSize,
+                             BlendDatablock& datablock) {
+    if (block.head.size() <= nameOffset) return false;
+
+    const char* name = reinterpret_cast<const char*>(block.head.data() + nameOffset);
+    size_t available = std::min(nameSize, block.head.size() - nameOffset);
+    size_t length = strnlen(name, available);
+
+    // Names carry the ID code as a prefix ("OBCube"). Blocks where it
+    // doesn't match (e.g. placeholders for linked IDs) aren't local data.
+    if (length <= 2 || name[0] != block.code[0] || name[1] != block.code[1]) return false;
+
+    datablock.type.assign(name, 2);
+    datablock.name.assign(name + 2, length - 2);
+    return true;
+}
+
+void BlendParser::readDatablockNames(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata) {
+    // Every ID type's struct starts with an ID, so ID.name has the same
+    // offset in all of them. Take offset and length from the file's SDNA:
+    // both changed between Blender versions (asset_data, longer names).
+    const Sdna::Struct* id = sdna.findStruct("ID");
+    const Sdna::Field* nameField = id ? id->findField("name") : nullptr;
+    if (!nameField || nameField->isPointer) return;
+
+    metadata.datablocks.reserve(state.idBlocks.size());
+    for (const auto& block : state.idBlocks) {
+        // Window manager, screens and workspaces are UI state, not content
+        if (isIdCode(block.code, "WM") || isIdCode(block.code, "SR") ||
+            isIdCode(block.code, "SN") || isIdCode(block.code, "WS")) {
+            continue;
+        }
+
+        BlendDatablock datablock;
+        if (readIdName(block, nameField->offset, nameField->size, datablock)) {
+            metadata.datablocks.push_back(std::move(datablock));
+        }
+    }
+    metadata.hasDatablocks = true;
+}
+
+void BlendParser::readMeshTotals(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata) {
+    const Sdna::Struct* mesh = sdna.findStruct("Mesh");
+    if (!mesh) return;
+
+    // Members were renamed over time; files keep the old (DNA) names, but
+    // accept the newer spellings too. totface is the pre-2.63 tessface count.
+    auto findAny = [mesh](std::initializer_list<const char*> names) -> const Sdna::Field* {
+        for (const char* name : names) {
+            if (const Sdna::Field* field = mesh->findField(name)) return field;
+        }
+        return nullptr;
+    };
+    const Sdna::Field* vertField = findAny({"totvert", "verts_num"});
+    const Sdna::Field* edgeField = findAny({"totedge", "edges_num"});
+    const Sdna::Field* polyField = findAny({"totpoly", "faces_num"});
+    const Sdna::Field* faceField = findAny({"totface"});
+
+    int32_t meshIndex = sdna.findStructIndex("Mesh");
+    for (const auto& block : state.idBlocks) {
+        if (block.sdnaIndex != meshIndex) continue;
+
+        const std::vector<uint8_t>& data = block.head;
+        int64_t value = 0;
+        if (vertField && sdna.readInt(data.data(), data.size(), *vertField, value) && value > 0) {
+            metadata.totalVertices += value;
+        }
+        if (edgeField && sdna.readInt(data.data(), data.size(), *edgeField, value) && value > 0) {
+            metadata.totalEdges += value;
+        }
+        if (polyField && sdna.readInt(data.data(), data.size(), *polyField, value) && value > 0) {
+            metadata.totalFaces += value;
+        } else if (faceField && sdna.readInt(data.data(), data.size(), *faceField, value) && value > 0) {
+            metadata.totalFaces += value;
+        }
+    }
+}
+
+void BlendParser::readReferences(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata) {
+    for (const auto& block : state.idBlocks) {
+        if (!isIdCode(block.code, "IM") && !isIdCode(block.code, "LI")) continue;
+
+        const Sdna::Struct* st = sdna.structAt(block.sdnaIndex);
+        if (!st) continue;
+
+        // "filepath" since Blender 2.80, "name" before
+        const Sdna::Field* pathField = st->findField("filepath");
+        if (!pathField) pathField = st->findField("name");
+        if (!pathField || pathField->isPointer || block.head.size() <= pathField->offset) continue;
+
+        const char* path = reinterpret_cast<const char*>(block.head.data() + pathField->offset);
+        size_t length = strnlen(path, std::min<size_t>(pathField->size, block.head.size() - pathField->offset));
+        if (length == 0) continue;  // Generated images and the like
+
+        // Images have a list of packed files (one per UDIM tile or view) since
+        // Blender 2.80; libraries and older images a single pointer
+        uint64_t packed = 0;
+        if (const Sdna::Field* packedField = st->findField("packedfile")) {
+            sdna.readPointer(block.head.data(), block.head.size(), *packedField, packed);
+        } else if (const Sdna::Field* packedList = st->findField("packedfiles")) {
+            Sdna::Field first = *packedList;  // ListBase.first
+            first.isPointer = true;
+            first.arrayLength = 1;
+            sdna.readPointer(block.head.data(), block.head.size(), first, packed);
+        }
+
+        BlendReference reference;
+        reference.type.assign(block.code, 2);
+        reference.path.assign(path, length);
+        reference.packed = packed != 0;
+        metadata.references.push_back(std::move(reference));
+    }
+}
+
+void BlendParser::readPreviews(const Sdna& sdna, const FullParseState& state, const BlockIndex& chain,
+                               std::vector<BlendPreview>& previews) {
+    const Sdna::Struct* id = sdna.findStruct("ID");
+    const Sdna::Field* nameField = id ? id->findField("name") : nullptr;
+    const Sdna::Field* assetField = id ? id->findField("asset_data") : nullptr;  // Blender 3.0+
+    if (!nameField || nameField->isPointer) return;
+
+    // PreviewImage { uint w[2]; uint h[2]; ...; uint* rect[2]; ... }, index 0
+    // is the icon and 1 the large preview
+    int32_t previewIndex = sdna.findStructIndex("PreviewImage");
+    const Sdna::Struct* previewStruct = sdna.structAt(previewIndex);
+    const Sdna::Field* widthField = previewStruct ? previewStruct->findField("w") : nullptr;
+    const Sdna::Field* heightField = previewStruct ? previewStruct->findField("h") : nullptr;
+    const Sdna::Field* rectField = previewStruct ? previewStruct->findField("rect") : nullptr;
+    bool canReadPreviews = widthField && heightField && rectField && rectField->arrayLength == 2;
+
+    std::vector<uint8_t> scratch;
+    auto idBlock = state.idBlocks.begin();
+    const FullParseState::IdBlock* owner = nullptr;     // ID the following DATA blocks belong to
+    size_t ownerEntry = SIZE_MAX;                       // Its index in previews, once it has one
+
+    auto addEntry = [&](bool isAsset) {
+        BlendDatablock datablock;
+        if (!readIdName(*owner, nameField->offset, nameField->size, datablock)) return false;
+        BlendPreview& preview = previews.emplace_back();
+        preview.type = std::move(datablock.type);
+        preview.name = std::move(datablock.name);
+        preview.isAsset = isAsset;
+        ownerEntry = previews.size() - 1;
+        return true;
+    };
+
+    // Blender writes each ID block followed by its DATA blocks; the
+    // PreviewImage struct is one of them, directly followed by its pixels
+    for (size_t i = 0; i < chain.blocks.size(); ++i) {
+        const BlockIndexEntry& entry = chain.blocks[i];
+
+        if (entry.code[0] != '\0' && entry.code[2] == '\0' && entry.code[3] == '\0') {
+            owner = nullptr;
+            ownerEntry = SIZE_MAX;
+            while (idBlock != state.idBlocks.end() && idBlock->offset < entry.offset) ++idBlock;
+            if (idBlock == state.idBlocks.end() || idBlock->offset != entry.offset) continue;
+            owner = &*idBlock;
+
+            uint64_t assetData = 0;
+            if (assetField && sdna.readPointer(owner->head.data(), owner->head.size(), *assetField, assetData) &&
+                assetData != 0) {
+                addEntry(true);
+            }
+            continue;
+        }
+
+        if (!owner || !canReadPreviews || entry.sdnaIndex != previewIndex ||
+            std::memcmp(entry.code, "DATA", 4) != 0) {
+            continue;
+        }
+
+        const uint8_t* data = state.previewFetch(entry.offset, static_cast<size_t>(entry.size), scratch);
+        if (!data) return;  // The file can't be read any further
+
+        // Sizes with a non-null rect have their pixels in the next DATA blocks, in order
+        int64_t width[2] = {0, 0}, height[2] = {0, 0};
+        uint64_t rect[2] = {0, 0};
+        for (uint32_t k = 0; k < 2; ++k) {
+            sdna.readInt(data, static_cast<size_t>(entry.size), *widthField, width[k], k);
+            sdna.readInt(data, static_cast<size_t>(entry.size), *heightField, height[k], k);
+            sdna.readPointer(data, static_cast<size_t>(entry.size), *rectField, rect[k], k);
+        }
+
+        uint32_t size = rect[1] != 0 ? 1 : 0;  // Prefer the large preview
+        size_t pixelBlock = i + 1 + (size == 1 && rect[0] != 0 ? 1 : 0);
+        if (rect[size] == 0 || pixelBlock >= chain.blocks.size() ||
+            width[size] <= 0 || width[size] > 1024 || height[size] <= 0 || height[size] > 1024) {
+            continue;
+        }
+
+        const BlockIndexEntry& pixels = chain.blocks[pixelBlock];
+        size_t pixelDataSize = static_cast<size_t>(width[size]) * static_cast<size_t>(height[size]) * 4;
+        if (std::memcmp(pixels.code, "DATA", 4) != 0 || static_cast<size_t>(pixels.size) != pixelDataSize) {
+            continue;
+        }
+        if (ownerEntry == SIZE_MAX && !addEntry(false)) {
+            continue;
+        }
+
+        const uint8_t* pixelData = state.previewFetch(pixels.offset, pixelDataSize, scratch);
+        if (!pixelData) return;
+
+        // Rows are bottom-up, like the file thumbnail
+        BlendThumbnailView view;
+        view.width = static_cast<int>(width[size]);
+        view.height = static_cast<int>(height[size]);
+        view.pixels = pixelData;
+        view.copyTo(previews[ownerEntry].image);
+    }
+}
+
+// ============================================================================
+// Block Index
+// ============================================================================
+
+std::optional<BlockIndex> BlendParser::loadIndex(const BlendFileInfo& info, bool is64bit, bool bigEndian) {
+    if (info.fileSize == 0) return std::nullopt;
+
+    auto index = BlockIndex::load(info.path, info.fileSize, info.modifiedTime.time_since_epoch().count());
+    if (!index || index->is64bit != is64bit || index->bigEndian != bigEndian ||
+        index->compressed != info.metadata.isCompressed) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+void BlendParser::recordBlock(BlockIndex& chain, const BlockHeader& block, uint64_t payloadOffset) {
+    BlockIndexEntry entry;
+    std::memcpy(entry.code, block.code, 4);
+    entry.size = block.size;
+    entry.sdnaIndex = block.sdnaIndex;
+    entry.count = block.count;
+    entry.offset = payloadOffset;
+    chain.blocks.push_back(entry);
+}
+
+void BlendParser::storeIndex(const BlendFileInfo& info, BlockIndex& chain, bool is64bit, bool bigEndian) {
+    if (info.fileSize == 0) return;
+
+    chain.fileSize = info.fileSize;
+    chain.modifiedTime = info.modifiedTime.time_since_epoch().count();
+    chain.is64bit = is64bit;
+    chain.bigEndian = bigEndian;
+    chain.compressed = info.metadata.isCompressed;
+    BlockIndex::save(info.path, chain);
+}
+
+void BlendParser::parseIndexed(const BlockIndex& index, const PayloadFetcher& fetch, bool full, BlendFileInfo& info,
+                               std::vector<BlendPreview>* previews) {
+    std::vector<uint8_t> scratch;
+
+    auto toBlock = [](const BlockIndexEntry& entry) {
+        BlockHeader block{};
+        std::memcpy(block.code, entry.code, 4);
+        block.size = entry.size;
+        block.sdnaIndex = entry.sdnaIndex;
+        block.count = entry.count;
+        return block;
+    };
+
+    auto readThumbnail = [&](const BlockIndexEntry& entry) {
+        if (static_cast<size_t>(entry.size) > MAX_THUMBNAIL_BLOCK_SIZE) return;
+        if (const uint8_t* payload = fetch(entry.offset, static_cast<size_t>(entry.size), scratch)) {
+            if (auto view = extractThumbnailView(payload, toBlock(entry))) {
+                info.thumbnail = view->toThumbnail();
+            }
+        }
+    };
+
+    const BlockIndexEntry* test = index.find("TEST");
+    info.noEmbeddedThumbnail = (test == nullptr);
+
+    if (!full) {
+        if (test) {
+            readThumbnail(*test);
+        }
+        return;
+    }
+
+    FullParseState state;
+    state.previews = previews;
+    state.previewFetch = fetch;
+    for (const auto& entry : index.blocks) {
+        if (std::memcmp(entry.code, "TEST", 4) == 0) {
+            readThumbnail(entry);
+            continue;
+        }
+
+        BlockHeader block = toBlock(entry);
+        countBlock(block, info.metadata);
+
+        if (isIdBlock(block)) {
+            size_t headSize = idHeadSize(block);
+            if (const uint8_t* payload = fetch(entry.offset, headSize, scratch)) {
+                std::memcpy(keepIdBlock(state, block, entry.offset, headSize).data(), payload, headSize);
+            }
+        } else if (std::strncmp(block.code, "DNA1", 4) == 0 && block.size <= MAX_DNA_BLOCK_SIZE) {
+            if (const uint8_t* payload = fetch(entry.offset, static_cast<size_t>(block.size), scratch)) {
+                state.dna.assign(payload, payload + block.size);
+            }
+        }
+    }
+
+    finishFullParse(state, index, index.is64bit, index.bigEndian, info.metadata);
 }
 
 std::optional<BlendFileInfo> BlendParser::parse(const std::filesystem::path& path) {
     return parseQuick(path);
 }
 
-std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path& path) {
+std::optional<BlendFileInfo> BlendParser::parseHeader(const std::filesystem::path& path, const FileStat* stat,
+                                                       CacheUse cacheUse) {
+    FileStream file(path);
+    if (!file) return std::nullopt;
+
+    // One page is read; nothing worth reading ahead
+    std::optional<PageCacheHints> hints;
+    if (cacheUse == CacheUse::Bulk) hints.emplace(file.fd(), hintFileSize(file.fd(), stat), 0);
+
+    BlendFileInfo info;
+    info.path = path;
+    info.filename = path.filename().string();
+
+    fillFileStat(path, stat, info);
+
+    FileHeader header;
+    if (!readHeader(file, header)) {
+        uint8_t headerBytes[FILE_HEADER_SIZE];
+        auto stream = CompressedStream::open(path);
+        if (stream && stream->read(headerBytes, sizeof(headerBytes)) &&
+            readHeader(headerBytes, sizeof(headerBytes), header)) {
+            info.metadata.isCompressed = true;
+        } else if (parseCompressed(path, info, false)) {
+            // Unsupported compression still gets basic file info
+            return info;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    info.metadata.blenderVersion = std::string(header.version, 3);
+    info.metadata.blenderVersion.insert(1, ".");
+    return info;
+}
+
+std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path& path, ParseMode mode,
+                                                      const FileStat* stat, CacheUse cacheUse) {
     auto startTime = std::chrono::steady_clock::now();
     DEBUG_LOG("parseQuick: " << path.string());
 
-    std::ifstream file(path, std::ios::binary);
+    FileStream file(path);
     if (!file) {
         DEBUG_LOG("parseQuick: failed to open file");
         return std::nullopt;
     }
 
+    std::optional<PageCacheHints> hints;
+    if (cacheUse == CacheUse::Bulk) hints.emplace(file.fd(), hintFileSize(file.fd(), stat), HEAD_READ_AHEAD);
+
+    if (mode == ParseMode::Mapped) {
+        return parseMapped(path, file.fd(), false);
+    }
+
     auto openTime = std::chrono::steady_clock::now();
     auto openMs = std::chrono::duration_cast<std::chrono::milliseconds>(openTime - startTime).count();
     if (openMs > 50) {
@@ -134,20 +685,11 @@ std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path
     info.path = path;
     info.filename = path.filename().string();
 
-    std::error_code ec;
-    info.fileSize = std::filesystem::file_size(path, ec);
-    info.modifiedTime = std::filesystem::last_write_time(path, ec);
+    fillFileStat(path, stat, info);
 
     FileHeader header;
     if (!readHeader(file, header)) {
-        // Try to read as compressed file (gzip)
-        file.seekg(0);
-        unsigned char gzMagic[2];
-        file.read(reinterpret_cast<char*>(gzMagic), 2);
-        if (gzMagic[0] == 0x1f && gzMagic[1] == 0x8b) {
-            info.metadata.isCompressed = true;
-            // For compressed files, we can't easily extract metadata
-            // Return basic file info only
+        if (parseCompressed(path, info, false)) {
             return info;
         }
         return std::nullopt;
@@ -158,17 +700,27 @@ std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path
 
     bool is64bit = (header.pointerSize == '-');
     bool bigEndian = (header.endianness == 'V');
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    if (auto index = loadIndex(info, is64bit, bigEndian)) {
+        parseIndexed(*index, streamFetcher(file), false, info);
+        return info;
+    }
 
     // Parse blocks to find thumbnail (TEST block)
     BlockHeader block;
+    BlockIndex chain;
+    uint64_t offset = FILE_HEADER_SIZE;
     int blockCount = 0;
     auto blockStartTime = std::chrono::steady_clock::now();
 
-    while (readBlockHeader(file, block, is64bit, bigEndian)) {
+    while (readBlockHeader(file, block, decoder)) {
         blockCount++;
 
         // Check for end block
         if (std::strncmp(block.code, "ENDB", 4) == 0) {
+            info.noEmbeddedThumbnail = true;
+            storeIndex(info, chain, is64bit, bigEndian);
             break;
         }
 
@@ -179,6 +731,17 @@ std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path
             break;
         }
 
+        // Past the point where Blender writes the thumbnail - there is none
+        if (isPastThumbnail(block)) {
+            info.noEmbeddedThumbnail = true;
+            break;
+        }
+
+        if (block.size < 0) break;
+        offset += decoder.size;
+        recordBlock(chain, block, offset);
+        offset += static_cast<uint64_t>(block.size);
+
         // Skip block data
         file.seekg(block.size, std::ios::cur);
     }
@@ -191,25 +754,29 @@ std::optional<BlendFileInfo> BlendParser::parseQuick(const std::filesystem::path
     return info;
 }
 
-std::optional<BlendFileInfo> BlendParser::parseFull(const std::filesystem::path& path) {
-    std::ifstream file(path, std::ios::binary);
+std::optional<BlendFileInfo> BlendParser::parseFull(const std::filesystem::path& path, ParseMode mode,
+                                                     std::vector<BlendPreview>* previews, const FileStat* stat,
+                                                     CacheUse cacheUse) {
+    if (previews) previews->clear();
+    FileStream file(path);
     if (!file) return std::nullopt;
 
+    std::optional<PageCacheHints> hints;
+    if (cacheUse == CacheUse::Bulk) hints.emplace(file.fd(), hintFileSize(file.fd(), stat), HEAD_READ_AHEAD);
+
+    if (mode == ParseMode::Mapped) {
+        return parseMapped(path, file.fd(), true, previews);
+    }
+
     BlendFileInfo info;
     info.path = path;
     info.filename = path.filename().string();
 
-    std::error_code ec;
-    info.fileSize = std::filesystem::file_size(path, ec);
-    info.modifiedTime = std::filesystem::last_write_time(path, ec);
+    fillFileStat(path, stat, info);
 
     FileHeader header;
     if (!readHeader(file, header)) {
-        file.seekg(0);
-        unsigned char gzMagic[2];
-        file.read(reinterpret_cast<char*>(gzMagic), 2);
-        if (gzMagic[0] == 0x1f && gzMagic[1] == 0x8b) {
-            info.metadata.isCompressed = true;
+        if (parseCompressed(path, info, true, previews)) {
             return info;
         }
         return std::nullopt;
@@ -220,41 +787,483 @@ std::optional<BlendFileInfo> BlendParser::parseFull(const std::filesystem::path&
 
     bool is64bit = (header.pointerSize == '-');
     bool bigEndian = (header.endianness == 'V');
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    if (auto index = loadIndex(info, is64bit, bigEndian)) {
+        parseIndexed(*index, streamFetcher(file), true, info, previews);
+        return info;
+    }
 
     // Parse all blocks to count objects
+    FullParseState state;
+    state.previews = previews;
+    state.previewFetch = streamFetcher(file);
     BlockHeader block;
-    while (readBlockHeader(file, block, is64bit, bigEndian)) {
+    BlockIndex chain;
+    bool sawThumbnail = false;
+    while (readBlockHeader(file, block, decoder)) {
         if (std::strncmp(block.code, "ENDB", 4) == 0) {
+            info.noEmbeddedThumbnail = !sawThumbnail;
+            storeIndex(info, chain, is64bit, bigEndian);
+            break;
+        }
+        // Reads below consume part of the payload, so seek from the payload start
+        auto payloadStart = file.tellg();
+
+        // Truncated or corrupt block - stop rather than allocate for it
+        if (block.size < 0 || payloadStart < 0 ||
+            (info.fileSize > 0 && static_cast<uint64_t>(block.size) > info.fileSize - static_cast<uint64_t>(payloadStart))) {
+            DEBUG_LOG("parseFull: truncated block in " << path.filename() << " at offset " << payloadStart);
             break;
         }
+        recordBlock(chain, block, static_cast<uint64_t>(payloadStart));
 
         // TEST block contains thumbnail
         if (std::strncmp(block.code, "TEST", 4) == 0) {
+            sawThumbnail = true;
             info.thumbnail = extractThumbnail(file, block);
+        } else {
+            countBlock(block, info.metadata);
+
+            if (isIdBlock(block)) {
+                std::vector<uint8_t>& head = keepIdBlock(state, block, static_cast<uint64_t>(payloadStart), idHeadSize(block));
+                file.read(reinterpret_cast<char*>(head.data()), static_cast<std::streamsize>(head.size()));
+            } else if (std::strncmp(block.code, "DNA1", 4) == 0) {
+                if (block.size > MAX_DNA_BLOCK_SIZE) break;
+                state.dna.resize(static_cast<size_t>(block.size));
+                file.read(reinterpret_cast<char*>(state.dna.data()), block.size);
+            }
         }
-        // OB block = Object
-        else if (std::strncmp(block.code, "OB", 2) == 0) {
-            info.metadata.objectCount += block.count;
+
+        // Skip to the next block header
+        file.clear();
+        file.seekg(payloadStart + static_cast<std::streamoff>(block.size));
+    }
+
+    finishFullParse(state, chain, is64bit, bigEndian, info.metadata);
+    return info;
+}
+
+// ============================================================================
+// Mapped Mode
+// ============================================================================
+
+BlendThumbnail BlendThumbnailView::toThumbnail() const {
+    BlendThumbnail thumbnail;
+    copyTo(thumbnail);
+    return thumbnail;
+}
+
+void BlendThumbnailView::copyTo(BlendThumbnail& thumbnail) const {
+    thumbnail.pixels.clear();
+    if (!pixels || width <= 0 || height <= 0) {
+        thumbnail.width = 0;
+        thumbnail.height = 0;
+        return;
+    }
+
+    thumbnail.width = width;
+    thumbnail.height = height;
+
+    // Blender stores thumbnails flipped vertically - flip while copying.
+    // resize() only allocates if the buffer is smaller than any it held before.
+    size_t rowSize = static_cast<size_t>(width) * 4;
+    thumbnail.pixels.resize(rowSize * height);
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(thumbnail.pixels.data() + y * rowSize,
+                    pixels + (height - 1 - y) * rowSize,
+                    rowSize);
+    }
+}
+
+bool BlendParser::readHeader(const uint8_t* data, size_t size, FileHeader& header) {
+    if (size < FILE_HEADER_SIZE) return false;
+
+    std::memcpy(header.magic, data, 7);
+    if (std::strncmp(header.magic, "BLENDER", 7) != 0) {
+        return false;
+    }
+
+    header.pointerSize = static_cast<char>(data[7]);
+    header.endianness = static_cast<char>(data[8]);
+    std::memcpy(header.version, data + 9, 3);
+    return true;
+}
+
+bool BlendParser::readBlockHeader(const uint8_t* data, size_t size, size_t& offset,
+                                  BlockHeader& block, const BlockHeaderDecoder& decoder) {
+    if (offset + decoder.size > size) return false;
+
+    decoder.decode(data + offset, block);
+    offset += decoder.size;
+    return true;
+}
+
+std::optional<BlendThumbnailView> BlendParser::extractThumbnailView(const uint8_t* payload, const BlockHeader& block) {
+    if (block.size < 8) return std::nullopt;
+
+    // Dimensions are written in native (little-endian) int order, same as the stream path
+    int32_t width, height;
+    std::memcpy(&width, payload, 4);
+    std::memcpy(&height, payload + 4, 4);
+
+    if (width <= 0 || width > 1024 || height <= 0 || height > 1024) {
+        return std::nullopt;
+    }
+
+    size_t pixelDataSize = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+    if (static_cast<size_t>(block.size) < 8 + pixelDataSize) {
+        return std::nullopt;
+    }
+
+    BlendThumbnailView view;
+    view.width = width;
+    view.height = height;
+    view.pixels = payload + 8;
+    return view;
+}
+
+std::optional<BlendFileInfo> BlendParser::parseMapped(const std::filesystem::path& path, int fd, bool full,
+                                                       std::vector<BlendPreview>* previews) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    MappedFile mapping;
+    if (!mapping.open(fd)) {
+        DEBUG_LOG("parseMapped: failed to map " << path.filename());
+        return std::nullopt;
+    }
+
+    BlendFileInfo info;
+    info.path = path;
+    info.filename = path.filename().string();
+    info.fileSize = mapping.size();
+    info.modifiedTime = mapping.modifiedTime();
+
+    const uint8_t* data = mapping.data();
+    size_t size = mapping.size();
+
+    FileHeader header;
+    if (!readHeader(data, size, header)) {
+        // Compressed payloads can't be walked in place - decompress instead
+        mapping.close();
+        if (parseCompressed(path, info, full, previews)) {
+            return info;
         }
-        // ME block = Mesh
-        else if (std::strncmp(block.code, "ME", 2) == 0) {
-            info.metadata.meshCount += block.count;
+        return std::nullopt;
+    }
+
+    info.metadata.blenderVersion = std::string(header.version, 3);
+    info.metadata.blenderVersion.insert(1, ".");
+
+    bool is64bit = (header.pointerSize == '-');
+    bool bigEndian = (header.endianness == 'V');
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    if (auto index = loadIndex(info, is64bit, bigEndian)) {
+        parseIndexed(*index, mappedFetcher(data, size), full, info, previews);
+        return info;
+    }
+
+    size_t offset = FILE_HEADER_SIZE;
+    BlockHeader block;
+    BlockIndex chain;
+    int blockCount = 0;
+    bool sawThumbnail = false;
+    FullParseState state;
+    state.previews = previews;
+    state.previewFetch = mappedFetcher(data, size);
+
+    while (readBlockHeader(data, size, offset, block, decoder)) {
+        blockCount++;
+
+        if (std::strncmp(block.code, "ENDB", 4) == 0) {
+            info.noEmbeddedThumbnail = !sawThumbnail;
+            storeIndex(info, chain, is64bit, bigEndian);
+            break;
         }
-        // MA block = Material
-        else if (std::strncmp(block.code, "MA", 2) == 0) {
-            info.metadata.materialCount += block.count;
+
+        // Truncated or corrupt block - stop rather than read past the mapping
+        if (block.size < 0 || static_cast<size_t>(block.size) > size - offset) {
+            DEBUG_LOG("parseMapped: truncated block in " << path.filename() << " at offset " << offset);
+            break;
         }
-        // TE or TX block = Texture
-        else if (std::strncmp(block.code, "TE", 2) == 0 ||
-                 std::strncmp(block.code, "TX", 2) == 0) {
-            info.metadata.textureCount += block.count;
+
+        recordBlock(chain, block, offset);
+
+        if (std::strncmp(block.code, "TEST", 4) == 0) {
+            sawThumbnail = true;
+            // The caller keeps the result, so this is where the pixels get copied
+            if (auto view = extractThumbnailView(data + offset, block)) {
+                info.thumbnail = view->toThumbnail();
+            }
+            if (!full) break;
+        } else if (!full && isPastThumbnail(block)) {
+            info.noEmbeddedThumbnail = true;
+            break;
+        } else if (full) {
+            countBlock(block, info.metadata);
+
+            const uint8_t* payload = data + offset;
+            if (isIdBlock(block)) {
+                size_t headSize = idHeadSize(block);
+                std::memcpy(keepIdBlock(state, block, offset, headSize).data(), payload, headSize);
+            } else if (std::strncmp(block.code, "DNA1", 4) == 0 && block.size <= MAX_DNA_BLOCK_SIZE) {
+                state.dna.assign(payload, payload + block.size);
+            }
         }
 
-        // Skip block data
-        file.seekg(block.size, std::ios::cur);
+        offset += static_cast<size_t>(block.size);
+    }
+
+    if (full) {
+        finishFullParse(state, chain, is64bit, bigEndian, info.metadata);
+    }
+
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    if (totalMs > 100) {
+        DEBUG_LOG("parseMapped: " << path.filename() << " took " << totalMs << "ms, " << blockCount << " blocks scanned");
     }
 
     return info;
 }
 
+std::optional<BlendThumbnailView> BlendParser::findThumbnailView(const std::filesystem::path& path, const MappedFile& mapping,
+                                                                bool* noEmbeddedThumbnail) {
+    const uint8_t* data = mapping.data();
+    size_t size = mapping.size();
+
+    FileHeader header;
+    if (!readHeader(data, size, header)) {
+        return std::nullopt;
+    }
+
+    bool is64bit = (header.pointerSize == '-');
+    bool bigEndian = (header.endianness == 'V');
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    BlendFileInfo info;
+    info.path = path;
+    info.fileSize = size;
+    info.modifiedTime = mapping.modifiedTime();
+
+    if (auto index = loadIndex(info, is64bit, bigEndian)) {
+        const BlockIndexEntry* test = index->find("TEST");
+        if (!test) {
+            if (noEmbeddedThumbnail) *noEmbeddedThumbnail = true;
+            return std::nullopt;
+        }
+        if (test->offset > size || static_cast<uint64_t>(test->size) > size - test->offset) {
+            return std::nullopt;
+        }
+        BlockHeader block{};
+        std::memcpy(block.code, test->code, 4);
+        block.size = test->size;
+        return extractThumbnailView(data + test->offset, block);
+    }
+
+    size_t offset = FILE_HEADER_SIZE;
+    BlockHeader block;
+    BlockIndex chain;
+    while (readBlockHeader(data, size, offset, block, decoder)) {
+        if (std::strncmp(block.code, "ENDB", 4) == 0) {
+            if (noEmbeddedThumbnail) *noEmbeddedThumbnail = true;
+            storeIndex(info, chain, is64bit, bigEndian);
+            break;
+        }
+        if (block.size < 0 || static_cast<size_t>(block.size) > size - offset) break;
+
+        if (std::strncmp(block.code, "TEST", 4) == 0) {
+            return extractThumbnailView(data + offset, block);
+        }
+        if (isPastThumbnail(block)) {
+            if (noEmbeddedThumbnail) *noEmbeddedThumbnail = true;
+            break;
+        }
+
+        recordBlock(chain, block, offset);
+        offset += static_cast<size_t>(block.size);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<MappedThumbnail> BlendParser::mapThumbnail(const std::filesystem::path& path) {
+    MappedThumbnail result;
+    if (!result.file.open(path)) {
+        return std::nullopt;
+    }
+
+    auto view = findThumbnailView(path, result.file);
+    if (!view) {
+        return std::nullopt;
+    }
+
+    result.view = *view;
+    return result;
+}
+
+std::optional<BlendThumbnail> BlendParser::readThumbnail(const std::filesystem::path& path, bool* noEmbeddedThumbnail) {
+    BlendThumbnail thumbnail;
+    if (!readThumbnail(path, thumbnail, noEmbeddedThumbnail)) {
+        return std::nullopt;
+    }
+    return thumbnail;
+}
+
+bool BlendParser::readThumbnail(const std::filesystem::path& path, BlendThumbnail& thumbnail,
+                                bool* noEmbeddedThumbnail) {
+    if (noEmbeddedThumbnail) *noEmbeddedThumbnail = false;
+
+    MappedFile mapping;
+    if (!mapping.open(path)) {
+        return false;
+    }
+
+    if (CompressedStream::detect(mapping.data(), mapping.size()) == CompressedStream::Format::None) {
+        auto view = findThumbnailView(path, mapping, noEmbeddedThumbnail);
+        if (!view) return false;
+        view->copyTo(thumbnail);
+        return true;
+    }
+
+    BlendFileInfo info;
+    info.path = path;
+    info.fileSize = mapping.size();
+    info.modifiedTime = mapping.modifiedTime();
+    mapping.close();
+    if (!parseCompressed(path, info, false)) {
+        return false;
+    }
+    if (noEmbeddedThumbnail) *noEmbeddedThumbnail = info.noEmbeddedThumbnail;
+    if (!info.thumbnail) {
+        return false;
+    }
+    thumbnail = std::move(*info.thumbnail);
+    return true;
+}
+
+// ============================================================================
+// Compressed Files
+// ============================================================================
+
+bool BlendParser::parseCompressed(const std::filesystem::path& path, BlendFileInfo& info, bool full,
+                                  std::vector<BlendPreview>* previews) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    auto stream = CompressedStream::open(path);
+    if (!stream) {
+        // Recognized but unsupported compression still gets basic file info
+        uint8_t magic[4] = {0, 0, 0, 0};
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+        if (CompressedStream::detect(magic, static_cast<size_t>(file.gcount())) != CompressedStream::Format::None) {
+            info.metadata.isCompressed = true;
+            return true;
+        }
+        return false;
+    }
+
+    info.metadata.isCompressed = true;
+
+    uint8_t headerBytes[FILE_HEADER_SIZE];
+    FileHeader header;
+    if (!stream->read(headerBytes, sizeof(headerBytes)) || !readHeader(headerBytes, sizeof(headerBytes), header)) {
+        DEBUG_LOG("parseCompressed: no BLENDER header in " << path.filename());
+        return true;
+    }
+
+    info.metadata.blenderVersion = std::string(header.version, 3);
+    info.metadata.blenderVersion.insert(1, ".");
+
+    bool is64bit = (header.pointerSize == '-');
+    bool bigEndian = (header.endianness == 'V');
+    BlockHeaderDecoder decoder = selectDecoder(header);
+
+    // Previews are read after DNA1, behind the indexed walk's forward-only
+    // stream, so that case walks the file instead
+    if (auto index = previews ? std::nullopt : loadIndex(info, is64bit, bigEndian)) {
+        parseIndexed(*index, compressedFetcher(*stream), full, info);
+        return true;
+    }
+
+    uint8_t blockBytes[BlockHeaderDecoder::MAX_SIZE];
+    BlockHeader block;
+    BlockIndex chain;
+    int blockCount = 0;
+    bool sawThumbnail = false;
+    std::vector<uint8_t> payload;
+    FullParseState state;
+    state.previews = previews;
+    state.previewFetch = reopeningFetcher(path);
+
+    while (stream->read(blockBytes, decoder.size)) {
+        decoder.decode(blockBytes, block);
+        blockCount++;
+
+        if (std::strncmp(block.code, "ENDB", 4) == 0) {
+            info.noEmbeddedThumbnail = !sawThumbnail;
+            storeIndex(info, chain, is64bit, bigEndian);
+            break;
+        }
+        if (block.size < 0) {
+            break;
+        }
+
+        if (!full && isPastThumbnail(block)) {
+            info.noEmbeddedThumbnail = true;
+            break;
+        }
+
+        recordBlock(chain, block, stream->position());
+
+        if (std::strncmp(block.code, "TEST", 4) == 0) {
+            sawThumbnail = true;
+            if (static_cast<size_t>(block.size) <= MAX_THUMBNAIL_BLOCK_SIZE) {
+                payload.resize(static_cast<size_t>(block.size));
+                if (!stream->read(payload.data(), payload.size())) break;
+                if (auto view = extractThumbnailView(payload.data(), block)) {
+                    info.thumbnail = view->toThumbnail();
+                }
+            } else if (!stream->skip(static_cast<uint64_t>(block.size))) {
+                break;
+            }
+            if (!full) break;
+            continue;
+        }
+
+        uint64_t remaining = static_cast<uint64_t>(block.size);
+        if (full) {
+            countBlock(block, info.metadata);
+
+            if (isIdBlock(block)) {
+                size_t headSize = idHeadSize(block);
+                if (!stream->read(keepIdBlock(state, block, stream->position(), headSize).data(), headSize)) break;
+                remaining -= headSize;
+            } else if (std::strncmp(block.code, "DNA1", 4) == 0) {
+                // The decompressed size isn't known up front, so only the cap bounds it
+                if (block.size > MAX_DNA_BLOCK_SIZE) break;
+                state.dna.resize(static_cast<size_t>(block.size));
+                if (!stream->read(state.dna.data(), state.dna.size())) break;
+                remaining = 0;
+            }
+        }
+
+        if (!stream->skip(remaining)) {
+            break;
+        }
+    }
+
+    if (full) {
+        finishFullParse(state, chain, is64bit, bigEndian, info.metadata);
+    }
+
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    if (totalMs > 100) {
+        DEBUG_LOG("parseCompressed: " << path.filename() << " took " << totalMs << "ms, " << blockCount
+                  << " blocks, " << stream->compressedBytesRead() << " compressed bytes read");
+    }
+
+    return true;
+}
+
 } // namespace BlenderFileFinder
@@ -5,14 +5,22 @@
 
 #pragma once
 
+#include "block_header.hpp"
+#include "block_index.hpp"
+#include "file_stat.hpp"
+#include "mapped_file.hpp"
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <iosfwd>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace BlenderFileFinder {
 
+class Sdna;
+
 /**
  * @brief Thumbnail image extracted from a .blend file.
  *
@@ -25,6 +33,86 @@ struct BlendThumbnail {
     std::vector<uint8_t> pixels;    ///< Pixel data in RGBA format
 };
 
+/**
+ * @brief Non-owning view of thumbnail pixels inside a mapped .blend file.
+ *
+ * Rows are in the order Blender stores them (bottom-up). Use
+ * toThumbnail() to get an owned, top-down copy when the pixels need
+ * to outlive the mapping.
+ */
+struct BlendThumbnailView {
+    int width = 0;                  ///< Width of the thumbnail in pixels
+    int height = 0;                 ///< Height of the thumbnail in pixels
+    const uint8_t* pixels = nullptr; ///< RGBA rows, bottom-up, inside the mapping
+
+    /**
+     * @brief Copy the pixels into an owned thumbnail, flipping rows upright.
+     * @return Thumbnail with top-down RGBA pixels
+     */
+    BlendThumbnail toThumbnail() const;
+
+    /**
+     * @brief Copy the pixels into an existing thumbnail, flipping rows upright.
+     *
+     * Reuses the capacity of @p thumbnail.pixels, so a recycled buffer (see
+     * PixelBufferPool) is filled without allocating.
+     *
+     * @param[out] thumbnail Thumbnail to fill with top-down RGBA pixels
+     */
+    void copyTo(BlendThumbnail& thumbnail) const;
+};
+
+/**
+ * @brief Thumbnail view together with the mapping that backs it.
+ *
+ * The view stays valid for as long as this object is alive.
+ */
+struct MappedThumbnail {
+    MappedFile file;                ///< Mapping of the .blend file
+    BlendThumbnailView view;        ///< Thumbnail pixels inside the mapping
+};
+
+/**
+ * @brief Name of one ID datablock (object, mesh, material, ...) in a .blend file.
+ */
+struct BlendDatablock {
+    std::string type;               ///< Two-letter ID code (e.g., "OB", "MA", "GR")
+    std::string name;               ///< Name without the ID code prefix (e.g., "Rig_Hero")
+};
+
+/**
+ * @brief File path referenced by an image or linked library datablock.
+ */
+struct BlendReference {
+    std::string type;               ///< ID code of the referencing datablock: "IM" or "LI"
+    std::string path;               ///< Path as stored; "//" prefixed paths are relative to the .blend file
+    bool packed = false;            ///< True if the file's data is packed into the .blend file
+};
+
+/**
+ * @brief Preview of one ID datablock, or an asset without one.
+ *
+ * Blender stores a preview for materials, worlds, images, collections,
+ * objects and other datablocks the asset browser can show, separately
+ * from the file thumbnail.
+ */
+struct BlendPreview {
+    std::string type;               ///< Two-letter ID code (e.g., "MA", "OB")
+    std::string name;               ///< Name without the ID code prefix
+    bool isAsset = false;           ///< True if the datablock is marked as an asset
+    BlendThumbnail image;           ///< Top-down RGBA pixels; empty if the datablock has no preview
+};
+
+/**
+ * @brief Layout of a file visited by BlendParser::walkBlocks().
+ */
+struct BlendFileLayout {
+    std::string blenderVersion;     ///< Blender version string (e.g., "4.0")
+    bool is64bit = true;            ///< File uses 8-byte pointers
+    bool bigEndian = false;         ///< File is big-endian
+    bool compressed = false;        ///< Payloads are decompressed copies (see walkBlocks())
+};
+
 /**
  * @brief Metadata extracted from a .blend file.
  *
@@ -40,7 +128,10 @@ struct BlendMetadata {
     int64_t totalVertices = 0;      ///< Total vertex count across all meshes
     int64_t totalFaces = 0;         ///< Total face count across all meshes
     int64_t totalEdges = 0;         ///< Total edge count across all meshes
-    bool isCompressed = false;      ///< True if the file is gzip compressed
+    bool isCompressed = false;      ///< True if the file is gzip or zstd compressed
+    std::vector<BlendDatablock> datablocks; ///< Local ID datablocks (parseFull only)
+    bool hasDatablocks = false;     ///< True if datablocks was read, so an empty list means none
+    std::vector<BlendReference> references; ///< Image and library paths (parseFull only, see hasDatablocks)
 };
 
 /**
@@ -55,6 +146,7 @@ struct BlendFileInfo {
     std::filesystem::file_time_type modifiedTime; ///< Last modification time
 
     std::optional<BlendThumbnail> thumbnail;    ///< Embedded thumbnail (if present)
+    bool noEmbeddedThumbnail = false;           ///< The file was searched and has no TEST block
     BlendMetadata metadata;                     ///< Parsed metadata
 };
 
@@ -66,14 +158,49 @@ struct BlendFileInfo {
  *
  * The parser understands the Blender file format including:
  * - File headers (magic number, pointer size, endianness, version)
- * - Block headers (code, size, SDNA index)
+ * - Block headers (code, size, SDNA index), decoded by a BlockHeaderDecoder
+ *   specialized for the file's pointer size and byte order
  * - TEST blocks containing thumbnails
  * - Object counting blocks (OB, ME, MA, TE)
+ * - The DNA1 block (via Sdna), used to read Mesh vertex/edge/face totals
+ *   and the names of all ID datablocks
  *
- * @note Compressed .blend files (gzip) can only have basic file info extracted.
+ * Two I/O strategies are available (see ParseMode). Stream mode reads
+ * through a FileStream; Mapped mode maps the file once and decodes block
+ * headers straight from memory, which avoids a read()/seek() per block
+ * on large files.
+ *
+ * Compressed files (gzip before Blender 3.0, zstd since) are read through
+ * a CompressedStream that decompresses only as far as the parser walks:
+ * up to the TEST block for parseQuick, up to ENDB for parseFull.
+ *
+ * The TEST block is searched for only until blocks that Blender always
+ * writes after it (GLOB, DATA, ID blocks) show up, so a file without a
+ * thumbnail costs a few block reads rather than a walk to ENDB. Such
+ * files are flagged with BlendFileInfo::noEmbeddedThumbnail.
+ *
+ * Whenever a walk reaches ENDB the block chain is stored in a BlockIndex.
+ * Later parses of the unchanged file seek straight to the blocks they
+ * need instead of walking the chain again.
  */
 class BlendParser {
 public:
+    /**
+     * @brief How the parser reads the file.
+     */
+    enum class ParseMode {
+        Stream,     ///< Buffered FileStream reads and seeks
+        Mapped      ///< mmap() the file and walk blocks in place
+    };
+
+    /**
+     * @brief How the parse should use the page cache.
+     */
+    enum class CacheUse {
+        Interactive,    ///< Default kernel caching
+        Bulk            ///< One of many files in a scan: read the head ahead, drop the pages after (see PageCacheHints)
+    };
+
     /**
      * @brief Parse a .blend file (alias for parseQuick).
      * @param path Path to the .blend file
@@ -81,6 +208,21 @@ public:
      */
     static std::optional<BlendFileInfo> parse(const std::filesystem::path& path);
 
+    /**
+     * @brief Header-only parse - file info and Blender version, no blocks.
+     *
+     * For files already known to have no thumbnail, where parseQuick
+     * would have nothing more to find.
+     *
+     * @param path Path to the .blend file
+     * @param stat Size and mtime already read by the caller, or nullptr to stat the file
+     * @param cacheUse Page cache behavior
+     * @return BlendFileInfo without thumbnail if successful, std::nullopt on failure
+     */
+    static std::optional<BlendFileInfo> parseHeader(const std::filesystem::path& path,
+                                                    const FileStat* stat = nullptr,
+                                                    CacheUse cacheUse = CacheUse::Interactive);
+
     /**
      * @brief Quick parse - extracts basic info and thumbnail only.
      *
@@ -88,20 +230,115 @@ public:
      * than parseFull for use cases that only need the preview.
      *
      * @param path Path to the .blend file
+     * @param mode I/O strategy to use
+     * @param stat Size and mtime already read by the caller, or nullptr to stat
+     *        the file (Mapped mode takes them from its own fstat())
+     * @param cacheUse Page cache behavior
      * @return BlendFileInfo with thumbnail if successful, std::nullopt on failure
      */
-    static std::optional<BlendFileInfo> parseQuick(const std::filesystem::path& path);
+    static std::optional<BlendFileInfo> parseQuick(const std::filesystem::path& path,
+                                                   ParseMode mode = ParseMode::Stream,
+                                                   const FileStat* stat = nullptr,
+                                                   CacheUse cacheUse = CacheUse::Interactive);
 
     /**
      * @brief Full parse - extracts all metadata including object counts.
      *
-     * Parses the entire file to count objects, meshes, materials, and textures.
+     * Parses the entire file to count objects, meshes, materials, and textures,
+     * total mesh geometry, and to read the names of all ID datablocks.
      * Slower than parseQuick but provides complete metadata.
      *
+     * With @p previews set, also reads the preview of every datablock that
+     * has one, and lists every asset. For compressed files this
+     * decompresses the file a second time, to reach the pixels after DNA1
+     * has been decoded.
+     *
      * @param path Path to the .blend file
+     * @param mode I/O strategy to use
+     * @param[out] previews If non-null, filled with datablock previews and assets
+     * @param stat Size and mtime already read by the caller, or nullptr to stat
+     *        the file (Mapped mode takes them from its own fstat())
+     * @param cacheUse Page cache behavior
      * @return BlendFileInfo with full metadata if successful, std::nullopt on failure
      */
-    static std::optional<BlendFileInfo> parseFull(const std::filesystem::path& path);
+    static std::optional<BlendFileInfo> parseFull(const std::filesystem::path& path,
+                                                  ParseMode mode = ParseMode::Stream,
+                                                  std::vector<BlendPreview>* previews = nullptr,
+                                                  const FileStat* stat = nullptr,
+                                                  CacheUse cacheUse = CacheUse::Interactive);
+
+    /**
+     * @brief Map a file and locate its thumbnail without copying pixels.
+     *
+     * The returned object owns the mapping; its view points into it.
+     * Call view.toThumbnail() to keep the pixels after it is destroyed.
+     *
+     * @param path Path to the .blend file
+     * @return Mapped thumbnail, or std::nullopt if the file has none
+     */
+    static std::optional<MappedThumbnail> mapThumbnail(const std::filesystem::path& path);
+
+    /**
+     * @brief Read just the embedded thumbnail of a file.
+     *
+     * Uses mapThumbnail() for uncompressed files and decompresses only up
+     * to the TEST block for compressed ones.
+     *
+     * @param path Path to the .blend file
+     * @param[out] noEmbeddedThumbnail If non-null, set to true when the file
+     *             was read successfully and has no TEST block
+     * @return Thumbnail, or std::nullopt if the file has none
+     */
+    static std::optional<BlendThumbnail> readThumbnail(const std::filesystem::path& path,
+                                                       bool* noEmbeddedThumbnail = nullptr);
+
+    /**
+     * @brief Read just the embedded thumbnail of a file into an existing buffer.
+     *
+     * Same as readThumbnail() above, but fills @p thumbnail in place,
+     * reusing the capacity of its pixel buffer for uncompressed files.
+     *
+     * @param path Path to the .blend file
+     * @param[out] thumbnail Thumbnail to fill; unspecified if false is returned
+     * @param[out] noEmbeddedThumbnail If non-null, set to true when the file
+     *             was read successfully and has no TEST block
+     * @return true if the file has a thumbnail and it was read
+     */
+    static bool readThumbnail(const std::filesystem::path& path, BlendThumbnail& thumbnail,
+                              bool* noEmbeddedThumbnail = nullptr);
+
+    /**
+     * @brief Resolve a path stored in a .blend file to an absolute path.
+     *
+     * Blender prefixes paths relative to the .blend file with "//", and
+     * files saved on Windows use backslashes.
+     *
+     * @param blendFile Path to the .blend file the path was read from
+     * @param storedPath Path as stored (see BlendReference::path)
+     * @return Absolute, lexically normalized path
+     */
+    static std::filesystem::path resolveStoredPath(const std::filesystem::path& blendFile,
+                                                   const std::string& storedPath);
+
+    /**
+     * @brief Called for each block by walkBlocks(); return false to stop the walk.
+     */
+    using BlockVisitor = std::function<bool(const BlendBlockHeader& block, const uint8_t* payload)>;
+
+    /**
+     * @brief Visit every block of a file with its payload, in file order.
+     *
+     * Uncompressed files are mapped and payloads point into the mapping,
+     * valid until walkBlocks() returns. Compressed files are decompressed
+     * as a stream and each payload is only valid during its visit.
+     * @p layout is filled in before the first visit.
+     *
+     * @param path Path to the .blend file
+     * @param[out] layout Version, pointer size and byte order of the file
+     * @param visit Called for each block before ENDB
+     * @return true if the walk reached ENDB
+     */
+    static bool walkBlocks(const std::filesystem::path& path, BlendFileLayout& layout, const BlockVisitor& visit);
 
 private:
     /**
@@ -114,21 +351,92 @@ private:
         char version[3];    ///< Version digits (e.g., "400" for 4.0)
     };
 
+    using BlockHeader = BlendBlockHeader;
+
+    static constexpr size_t FILE_HEADER_SIZE = 12;  ///< "BLENDER" + pointer size + endianness + version
+
+    static BlockHeaderDecoder selectDecoder(const FileHeader& header);
+    static bool readHeader(std::istream& file, FileHeader& header);
+    static bool readBlockHeader(std::istream& file, BlockHeader& block, const BlockHeaderDecoder& decoder);
+    static std::optional<BlendThumbnail> extractThumbnail(std::istream& file, const BlockHeader& block);
+    static void extractMetadata(std::istream& file, BlendMetadata& metadata, bool is64bit, bool bigEndian);
+    static void countBlock(const BlockHeader& block, BlendMetadata& metadata);
+
+    /**
+     * @brief Returns @p size payload bytes at @p offset, in place or copied into @p scratch.
+     *
+     * Returns nullptr if the bytes can't be read.
+     */
+    using PayloadFetcher = std::function<const uint8_t*(uint64_t offset, size_t size, std::vector<uint8_t>& scratch)>;
+
     /**
-     * @brief Internal structure for block headers in .blend files.
+     * @brief Block data parseFull keeps until DNA1 (near the end) is decoded.
      */
-    struct BlockHeader {
-        char code[4];           ///< Block type code (e.g., "TEST", "OB", "ME")
-        int32_t size;           ///< Size of block data in bytes
-        uint64_t oldAddress;    ///< Original memory address (for relocation)
-        int32_t sdnaIndex;      ///< SDNA structure index
-        int32_t count;          ///< Number of structures in block
+    struct FullParseState {
+        /**
+         * @brief Leading payload bytes of one ID block.
+         */
+        struct IdBlock {
+            char code[2];                   ///< ID code ("OB", "ME", ...)
+            int32_t sdnaIndex = 0;          ///< SDNA index from the block header
+            uint64_t offset = 0;            ///< Payload offset, as recorded in the block chain
+            std::vector<uint8_t> head;      ///< Leading payload bytes
+        };
+
+        std::vector<IdBlock> idBlocks;      ///< Every ID block, in file order
+        std::vector<uint8_t> dna;           ///< DNA1 payload
+        std::vector<BlendPreview>* previews = nullptr; ///< Previews to read, if requested
+        PayloadFetcher previewFetch;        ///< Reads preview blocks once DNA1 is decoded
     };
 
-    static bool readHeader(std::ifstream& file, FileHeader& header);
-    static bool readBlockHeader(std::ifstream& file, BlockHeader& block, bool is64bit, bool bigEndian);
-    static std::optional<BlendThumbnail> extractThumbnail(std::ifstream& file, const BlockHeader& block);
-    static void extractMetadata(std::ifstream& file, BlendMetadata& metadata, bool is64bit, bool bigEndian);
+    static constexpr size_t MESH_HEAD_BYTES = 16 * 1024; ///< Bytes of each ME block kept (covers the Mesh struct)
+    static constexpr size_t REFERENCE_HEAD_BYTES = 4096; ///< Bytes of IM and LI blocks kept (covers filepath)
+    static constexpr size_t ID_HEAD_BYTES = 320;         ///< Bytes of other ID blocks kept (covers ID.name)
+
+    static bool isIdCode(const char* code, const char* id);
+    static bool isIdBlock(const BlockHeader& block);
+    static bool isPastThumbnail(const BlockHeader& block);
+    static size_t idHeadSize(const BlockHeader& block);
+    static std::vector<uint8_t>& keepIdBlock(FullParseState& state, const BlockHeader& block,
+                                             uint64_t payloadOffset, size_t headSize);
+    static void finishFullParse(const FullParseState& state, const BlockIndex& chain,
+                                bool is64bit, bool bigEndian, BlendMetadata& metadata);
+    static bool readIdName(const FullParseState::IdBlock& block, size_t nameOffset, size_t nameSize,
+                           BlendDatablock& datablock);
+    static void readDatablockNames(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata);
+    static void readMeshTotals(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata);
+    static void readReferences(const Sdna& sdna, const FullParseState& state, BlendMetadata& metadata);
+    static void readPreviews(const Sdna& sdna, const FullParseState& state, const BlockIndex& chain,
+                             std::vector<BlendPreview>& previews);
+
+    /// @name Mapped Mode
+    /// Decoders that work on bytes inside a MappedFile
+    /// @{
+    static bool readHeader(const uint8_t* data, size_t size, FileHeader& header);
+    static bool readBlockHeader(const uint8_t* data, size_t size, size_t& offset,
+                                BlockHeader& block, const BlockHeaderDecoder& decoder);
+    static std::optional<BlendThumbnailView> extractThumbnailView(const uint8_t* payload, const BlockHeader& block);
+    static std::optional<BlendFileInfo> parseMapped(const std::filesystem::path& path, int fd, bool full,
+                                                    std::vector<BlendPreview>* previews = nullptr);
+    static std::optional<BlendThumbnailView> findThumbnailView(const std::filesystem::path& path, const MappedFile& mapping,
+                                                               bool* noEmbeddedThumbnail = nullptr);
+    /// @}
+
+    /// @name Block Index
+    /// Seeking straight to blocks recorded by an earlier walk (see BlockIndex)
+    /// @{
+
+    static constexpr size_t MAX_THUMBNAIL_BLOCK_SIZE = 8 + 1024 * 1024 * 4; ///< Size prefix + 1024x1024 RGBA
+
+    static std::optional<BlockIndex> loadIndex(const BlendFileInfo& info, bool is64bit, bool bigEndian);
+    static void recordBlock(BlockIndex& chain, const BlockHeader& block, uint64_t payloadOffset);
+    static void storeIndex(const BlendFileInfo& info, BlockIndex& chain, bool is64bit, bool bigEndian);
+    static void parseIndexed(const BlockIndex& index, const PayloadFetcher& fetch, bool full, BlendFileInfo& info,
+                             std::vector<BlendPreview>* previews = nullptr);
+    /// @}
+
+    static bool parseCompressed(const std::filesystem::path& path, BlendFileInfo& info, bool full,
+                                std::vector<BlendPreview>* previews = nullptr);
 };
 
 } // namespace BlenderFileFinder
@@ -0,0 +1,587 @@
+#include "blend_scene.hpp"
+#include "blend_parser.hpp"
+#include "debug.hpp"
+#include "sdna.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Object.type of mesh objects
+constexpr int64_t OB_MESH = 1;
+
+// Object.rotmode values; 1-6 are the Euler orders below
+constexpr int64_t ROT_MODE_QUAT = 0;
+constexpr int64_t ROT_MODE_AXISANGLE = -1;
+constexpr const char* EULER_ORDERS[] = {"XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX"};
+
+// Mesh data of compressed files is copied until DNA1 arrives. Past this
+// many bytes the remaining meshes are left out.
+constexpr size_t MAX_COPIED_BYTES = 1024ULL * 1024 * 1024;
+
+constexpr int MAX_PARENT_DEPTH = 32;
+
+using Matrix4 = std::array<float, 16>;  // Column-major, like Blender's float[4][4]
+using Matrix3 = std::array<float, 9>;   // Column-major
+
+constexpr Matrix4 IDENTITY4 = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+constexpr Matrix3 IDENTITY3 = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+Matrix4 multiply(const Matrix4& a, const Matrix4& b) {
+    Matrix4 r{};
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0;
+            for (int k = 0; k < 4; ++k) sum += a[k * 4 + row] * b[c * 4 + k];
+            r[c * 4 + row] = sum;
+        }
+    }
+    return r;
+}
+
+Matrix3 multiply(const Matrix3& a, const Matrix3& b) {
+    Matrix3 r{};
+    for (int c = 0; c < 3; ++c) {
+        for (int row = 0; row < 3; ++row) {
+            float sum = 0;
+            for (int k = 0; k < 3; ++k) sum += a[k * 3 + row] * b[c * 3 + k];
+            r[c * 3 + row] = sum;
+        }
+    }
+    return r;
+}
+
+Matrix3 axisRotation(int axis, float angle) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    Matrix3 m = IDENTITY3;
+    int a = (axis + 1) % 3;
+    int b = (axis + 2) % 3;
+    m[a * 3 + a] = c;
+    m[a * 3 + b] = s;
+    m[b * 3 + a] = -s;
+    m[b * 3 + b] = c;
+    return m;
+}
+
+// Blender applies the first axis of the order first: XYZ is Rz * Ry * Rx
+Matrix3 eulerRotation(const float euler[3], const char* order) {
+    Matrix3 m = IDENTITY3;
+    for (int i = 0; i < 3; ++i) {
+        int axis = order[i] - 'X';
+        m = multiply(axisRotation(axis, euler[axis]), m);
+    }
+    return m;
+}
+
+Matrix3 quaternionRotation(const float quat[4]) {
+    float w = quat[0], x = quat[1], y = quat[2], z = quat[3];
+    float length = std::sqrt(w * w + x * x + y * y + z * z);
+    if (length < 1e-8f) return IDENTITY3;
+    w /= length;
+    x /= length;
+    y /= length;
+    z /= length;
+
+    return {1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y),
+            2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x),
+            2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y)};
+}
+
+Matrix3 axisAngleRotation(const float axis[3], float angle) {
+    float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (length < 1e-8f) return IDENTITY3;
+    float half = angle * 0.5f;
+    float s = std::sin(half) / length;
+    float quat[4] = {std::cos(half), axis[0] * s, axis[1] * s, axis[2] * s};
+    return quaternionRotation(quat);
+}
+
+/**
+ * @brief Block kept from the walk for decoding once DNA1 is known.
+ */
+struct StoredBlock {
+    BlendBlockHeader header{};
+    const uint8_t* payload = nullptr;
+    std::vector<uint8_t> copy;          ///< Payload copy (compressed files only)
+
+    size_t size() const { return static_cast<size_t>(header.size); }
+};
+
+/**
+ * @brief One entry of a CustomData layer array.
+ */
+struct Layer {
+    std::string name;
+    const StoredBlock* data = nullptr;  ///< Block holding the layer's array, if written
+};
+
+/**
+ * @brief Base mesh geometry in object space.
+ */
+struct MeshGeometry {
+    std::vector<float> positions;
+    std::vector<uint32_t> triangles;
+};
+
+/**
+ * @brief Turns the kept OB/ME blocks into SceneMeshes using the file's SDNA.
+ */
+class SceneDecoder {
+public:
+    SceneDecoder(const Sdna& sdna, const std::vector<StoredBlock>& blocks) : m_sdna(sdna), m_blocks(blocks) {
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            m_byAddress.emplace(blocks[i].header.oldAddress, i);
+        }
+    }
+
+    std::vector<SceneMesh> decode() {
+        std::vector<SceneMesh> meshes;
+        for (const auto& block : m_blocks) {
+            if (std::strncmp(block.header.code, "OB", 2) != 0 || block.header.code[2] != '\0') continue;
+
+            const Sdna::Struct* object = m_sdna.structAt(block.header.sdnaIndex);
+            if (!object) continue;
+            if (readInt(*object, block.payload, block.size(), {"type"}, -1) != OB_MESH) continue;
+
+            const StoredBlock* meshBlock = pointee(*object, block.payload, block.size(), {"data"});
+            if (!meshBlock || std::strncmp(meshBlock->header.code, "ME", 2) != 0) continue;
+
+            const MeshGeometry* geometry = meshGeometry(*meshBlock);
+            if (!geometry || geometry->triangles.empty()) continue;
+
+            Matrix4 world = IDENTITY4;
+            objectMatrix(block, world, 0);
+
+            SceneMesh& mesh = meshes.emplace_back();
+            mesh.name = objectName(*object, block);
+            transform(*geometry, world, mesh);
+        }
+        return meshes;
+    }
+
+private:
+    static const Sdna::Field* findField(const Sdna::Struct& st, std::initializer_list<std::string_view> names) {
+        // Members renamed over the years are looked up under every name a
+        // file may store them with
+        for (std::string_view name : names) {
+            if (const Sdna::Field* field = st.findField(name)) return field;
+        }
+        return nullptr;
+    }
+
+    int64_t readInt(const Sdna::Struct& st, const uint8_t* data, size_t size,
+                    std::initializer_list<std::string_view> names, int64_t fallback) const {
+        const Sdna::Field* field = findField(st, names);
+        int64_t value = 0;
+        return field && m_sdna.readInt(data, size, *field, value) ? value : fallback;
+    }
+
+    bool readFloats(const Sdna::Struct& st, const uint8_t* data, size_t size,
+                    std::initializer_list<std::string_view> names, float* out, uint32_t count) const {
+        const Sdna::Field* field = findField(st, names);
+        if (!field || field->arrayLength < count) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!m_sdna.readFloat(data, size, *field, out[i], i)) return false;
+        }
+        return true;
+    }
+
+    const StoredBlock* blockAt(uint64_t address) const {
+        if (address == 0) return nullptr;
+        auto it = m_byAddress.find(address);
+        return it != m_byAddress.end() ? &m_blocks[it->second] : nullptr;
+    }
+
+    const StoredBlock* pointee(const Sdna::Struct& st, const uint8_t* data, size_t size,
+                               std::initializer_list<std::string_view> names) const {
+        const Sdna::Field* field = findField(st, names);
+        uint64_t address = 0;
+        if (!field || !m_sdna.readPointer(data, size, *field, address)) return nullptr;
+        return blockAt(address);
+    }
+
+    const char* structName(const StoredBlock& block) const {
+        const Sdna::Struct* st = m_sdna.structAt(block.header.sdnaIndex);
+        return st ? st->name.c_str() : "";
+    }
+
+    uint32_t rawU32(const StoredBlock& block, size_t index) const {
+        uint32_t value;
+        std::memcpy(&value, block.payload + index * 4, 4);
+        return m_sdna.isBigEndian() ? __builtin_bswap32(value) : value;
+    }
+
+    float rawFloat(const StoredBlock& block, size_t index) const {
+        uint32_t bits = rawU32(block, index);
+        float value;
+        std::memcpy(&value, &bits, 4);
+        return value;
+    }
+
+    std::string objectName(const Sdna::Struct& object, const StoredBlock& block) const {
+        const Sdna::Field* idField = object.findField("id");
+        const Sdna::Struct* id = m_sdna.findStruct("ID");
+        const Sdna::Field* nameField = id ? id->findField("name") : nullptr;
+        if (!idField || !nameField) return {};
+
+        size_t offset = static_cast<size_t>(idField->offset) + nameField->offset;
+        if (offset + nameField->size > block.size() || nameField->size <= 2) return {};
+
+        const char* name = reinterpret_cast<const char*>(block.payload + offset);
+        size_t length = strnlen(name, nameField->size);
+        return length > 2 ? std::string(name + 2, length - 2) : std::string();
+    }
+
+    std::vector<Layer> layers(const Sdna::Struct& mesh, const StoredBlock& block, std::string_view customData) const {
+        std::vector<Layer> result;
+        const Sdna::Field* field = mesh.findField(customData);
+        const Sdna::Struct* cd = field ? m_sdna.findStruct(field->type) : nullptr;
+        const Sdna::Struct* layer = m_sdna.findStruct("CustomDataLayer");
+        if (!cd || !layer || layer->size == 0 || field->offset >= block.size()) return result;
+
+        const uint8_t* cdData = block.payload + field->offset;
+        size_t cdSize = block.size() - field->offset;
+        const StoredBlock* array = pointee(*cd, cdData, cdSize, {"layers"});
+        if (!array) return result;
+
+        int64_t total = readInt(*cd, cdData, cdSize, {"totlayer"}, 0);
+        total = std::clamp<int64_t>(total, 0, static_cast<int64_t>(array->size() / layer->size));
+
+        const Sdna::Field* nameField = layer->findField("name");
+        for (int64_t i = 0; i < total; ++i) {
+            const uint8_t* entry = array->payload + static_cast<size_t>(i) * layer->size;
+            Layer& out = result.emplace_back();
+            if (nameField) {
+                const char* name = reinterpret_cast<const char*>(entry + nameField->offset);
+                out.name.assign(name, strnlen(name, nameField->size));
+            }
+            out.data = pointee(*layer, entry, layer->size, {"data"});
+        }
+        return result;
+    }
+
+    const StoredBlock* layerNamed(const std::vector<Layer>& list, std::string_view name) const {
+        for (const auto& layer : list) {
+            if (layer.data && layer.name == name) return layer.data;
+        }
+        return nullptr;
+    }
+
+    const StoredBlock* layerOfStruct(const std::vector<Layer>& list, std::string_view name) const {
+        for (const auto& layer : list) {
+            if (layer.data && structName(*layer.data) == name) return layer.data;
+        }
+        return nullptr;
+    }
+
+    const StoredBlock* structArray(const Sdna::Struct& mesh, const StoredBlock& block,
+                                   std::string_view pointerName, const std::vector<Layer>& list,
+                                   std::string_view arrayStruct) const {
+        const StoredBlock* array = pointee(mesh, block.payload, block.size(), {pointerName});
+        if (array && structName(*array) == arrayStruct) return array;
+        return layerOfStruct(list, arrayStruct);
+    }
+
+    bool readPositions(const Sdna::Struct& mesh, const StoredBlock& block, std::vector<float>& positions) const {
+        int64_t vertCount = readInt(mesh, block.payload, block.size(), {"totvert", "verts_num"}, 0);
+        if (vertCount <= 0) return false;
+        size_t count = static_cast<size_t>(vertCount);
+        std::vector<Layer> vdata = layers(mesh, block, "vdata");
+
+        // 3.5+: float3 "position" attribute
+        if (const StoredBlock* layer = layerNamed(vdata, "position")) {
+            if (layer->size() < count * 12) return false;
+            positions.resize(count * 3);
+            for (size_t i = 0; i < count * 3; ++i) positions[i] = rawFloat(*layer, i);
+            return true;
+        }
+
+        // Older files: MVert array
+        const StoredBlock* verts = structArray(mesh, block, "mvert", vdata, "MVert");
+        const Sdna::Struct* mvert = verts ? m_sdna.structAt(verts->header.sdnaIndex) : nullptr;
+        if (!mvert || mvert->size == 0 || verts->size() < count * mvert->size) return false;
+
+        positions.resize(count * 3);
+        for (size_t i = 0; i < count; ++i) {
+            if (!readFloats(*mvert, verts->payload + i * mvert->size, mvert->size, {"co"}, &positions[i * 3], 3)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readFaces(const Sdna::Struct& mesh, const StoredBlock& block, std::vector<uint32_t>& faceStarts,
+                   std::vector<uint32_t>& corners) const {
+        int64_t faceCount = readInt(mesh, block.payload, block.size(), {"totpoly", "faces_num"}, 0);
+        int64_t cornerCount = readInt(mesh, block.payload, block.size(), {"totloop", "corners_num"}, 0);
+        if (faceCount <= 0 || cornerCount <= 0) return false;
+        size_t faces = static_cast<size_t>(faceCount);
+        size_t loops = static_cast<size_t>(cornerCount);
+
+        // Corner -> vertex: ".corner_vert" (3.6+) or MLoop.v
+        std::vector<Layer> ldata = layers(mesh, block, "ldata");
+        if (const StoredBlock* layer = layerNamed(ldata, ".corner_vert")) {
+            if (layer->size() < loops * 4) return false;
+            corners.resize(loops);
+            for (size_t i = 0; i < loops; ++i) corners[i] = rawU32(*layer, i);
+        } else {
+            const StoredBlock* array = structArray(mesh, block, "mloop", ldata, "MLoop");
+            const Sdna::Struct* mloop = array ? m_sdna.structAt(array->header.sdnaIndex) : nullptr;
+            if (!mloop || mloop->size == 0 || array->size() < loops * mloop->size) return false;
+            corners.resize(loops);
+            for (size_t i = 0; i < loops; ++i) {
+                corners[i] = static_cast<uint32_t>(
+                    readInt(*mloop, array->payload + i * mloop->size, mloop->size, {"v"}, 0));
+            }
+        }
+
+        // Face -> first corner: offset array (3.6+) or MPoly.loopstart/totloop
+        faceStarts.resize(faces + 1);
+        const StoredBlock* offsets = pointee(mesh, block.payload, block.size(),
+                                             {"poly_offset_indices", "face_offset_indices"});
+        if (offsets) {
+            if (offsets->size() < (faces + 1) * 4) return false;
+            for (size_t i = 0; i <= faces; ++i) faceStarts[i] = rawU32(*offsets, i);
+            return true;
+        }
+
+        std::vector<Layer> pdata = layers(mesh, block, "pdata");
+        const StoredBlock* array = structArray(mesh, block, "mpoly", pdata, "MPoly");
+        const Sdna::Struct* mpoly = array ? m_sdna.structAt(array->header.sdnaIndex) : nullptr;
+        if (!mpoly || mpoly->size == 0 || array->size() < faces * mpoly->size) return false;
+
+        // Faces are contiguous in corner order in every version that wrote MPoly
+        for (size_t i = 0; i < faces; ++i) {
+            const uint8_t* entry = array->payload + i * mpoly->size;
+            faceStarts[i] = static_cast<uint32_t>(readInt(*mpoly, entry, mpoly->size, {"loopstart"}, 0));
+            if (i + 1 == faces) {
+                int64_t last = readInt(*mpoly, entry, mpoly->size, {"totloop"}, 0);
+                faceStarts[faces] = faceStarts[i] + static_cast<uint32_t>(std::max<int64_t>(last, 0));
+            }
+        }
+        return true;
+    }
+
+    bool readLegacyFaces(const Sdna::Struct& mesh, const StoredBlock& block, std::vector<uint32_t>& triangles) const {
+        int64_t faceCount = readInt(mesh, block.payload, block.size(), {"totface"}, 0);
+        if (faceCount <= 0) return false;
+        size_t faces = static_cast<size_t>(faceCount);
+
+        std::vector<Layer> fdata = layers(mesh, block, "fdata");
+        const StoredBlock* array = structArray(mesh, block, "mface", fdata, "MFace");
+        const Sdna::Struct* mface = array ? m_sdna.structAt(array->header.sdnaIndex) : nullptr;
+        if (!mface || mface->size == 0 || array->size() < faces * mface->size) return false;
+
+        for (size_t i = 0; i < faces; ++i) {
+            const uint8_t* entry = array->payload + i * mface->size;
+            uint32_t v[4];
+            const char* names[] = {"v1", "v2", "v3", "v4"};
+            for (int k = 0; k < 4; ++k) {
+                v[k] = static_cast<uint32_t>(readInt(*mface, entry, mface->size, {names[k]}, 0));
+            }
+            triangles.insert(triangles.end(), {v[0], v[1], v[2]});
+            if (v[3] != 0) triangles.insert(triangles.end(), {v[0], v[2], v[3]});  // v4 == 0 marks a triangle
+        }
+        return true;
+    }
+
+    const MeshGeometry* meshGeometry(const StoredBlock& block) {
+        auto cached = m_meshes.find(block.header.oldAddress);
+        if (cached != m_meshes.end()) return cached->second.get();
+
+        auto& slot = m_meshes[block.header.oldAddress];
+        const Sdna::Struct* mesh = m_sdna.structAt(block.header.sdnaIndex);
+        if (!mesh) return nullptr;
+
+        auto geometry = std::make_unique<MeshGeometry>();
+        if (!readPositions(*mesh, block, geometry->positions)) {
+            DEBUG_LOG("BlendScene: no vertex positions for mesh at " << std::hex << block.header.oldAddress);
+            return nullptr;
+        }
+
+        std::vector<uint32_t> faceStarts;
+        std::vector<uint32_t> corners;
+        if (readFaces(*mesh, block, faceStarts, corners)) {
+            for (size_t f = 0; f + 1 < faceStarts.size(); ++f) {
+                uint32_t start = faceStarts[f];
+                uint32_t end = faceStarts[f + 1];
+                if (end > corners.size() || start >= end) continue;
+                for (uint32_t c = start + 1; c + 1 < end; ++c) {
+                    geometry->triangles.insert(geometry->triangles.end(), {corners[start], corners[c], corners[c + 1]});
+                }
+            }
+        } else {
+            readLegacyFaces(*mesh, block, geometry->triangles);
+        }
+
+        // Drop triangles that point past the vertex array
+        uint32_t vertexCount = static_cast<uint32_t>(geometry->positions.size() / 3);
+        auto& tris = geometry->triangles;
+        size_t kept = 0;
+        for (size_t t = 0; t + 2 < tris.size(); t += 3) {
+            if (tris[t] < vertexCount && tris[t + 1] < vertexCount && tris[t + 2] < vertexCount) {
+                std::copy(tris.begin() + t, tris.begin() + t + 3, tris.begin() + kept);
+                kept += 3;
+            }
+        }
+        tris.resize(kept);
+
+        slot = std::move(geometry);
+        return slot.get();
+    }
+
+    Matrix3 rotation(const Sdna::Struct& object, const uint8_t* data, size_t size) const {
+        int64_t mode = readInt(object, data, size, {"rotmode"}, 1);
+
+        if (mode == ROT_MODE_QUAT) {
+            float quat[4] = {1, 0, 0, 0};
+            float delta[4] = {1, 0, 0, 0};
+            readFloats(object, data, size, {"quat"}, quat, 4);
+            readFloats(object, data, size, {"dquat"}, delta, 4);
+            return multiply(quaternionRotation(delta), quaternionRotation(quat));
+        }
+
+        if (mode == ROT_MODE_AXISANGLE) {
+            float axis[3] = {0, 1, 0};
+            float deltaAxis[3] = {0, 1, 0};
+            float angle = 0;
+            float deltaAngle = 0;
+            readFloats(object, data, size, {"rotAxis"}, axis, 3);
+            readFloats(object, data, size, {"rotAngle"}, &angle, 1);
+            readFloats(object, data, size, {"drotAxis"}, deltaAxis, 3);
+            readFloats(object, data, size, {"drotAngle"}, &deltaAngle, 1);
+            return multiply(axisAngleRotation(deltaAxis, deltaAngle), axisAngleRotation(axis, angle));
+        }
+
+        const char* order = EULER_ORDERS[(mode >= 1 && mode <= 6) ? mode - 1 : 0];
+        float euler[3] = {0, 0, 0};
+        float delta[3] = {0, 0, 0};
+        readFloats(object, data, size, {"rot"}, euler, 3);
+        readFloats(object, data, size, {"drot"}, delta, 3);
+        return multiply(eulerRotation(delta, order), eulerRotation(euler, order));
+    }
+
+    void objectMatrix(const StoredBlock& block, Matrix4& out, int depth) const {
+        const Sdna::Struct* object = m_sdna.structAt(block.header.sdnaIndex);
+        if (!object) return;
+        const uint8_t* data = block.payload;
+        size_t size = block.size();
+
+        // Saved world matrix (includes constraints and drivers), up to 4.1
+        Matrix4 stored{};
+        if (readFloats(*object, data, size, {"obmat", "object_to_world"}, stored.data(), 16) &&
+            std::any_of(stored.begin(), stored.end(), [](float v) { return v != 0.0f; })) {
+            out = stored;
+            return;
+        }
+
+        float loc[3] = {0, 0, 0}, dloc[3] = {0, 0, 0};
+        float scale[3] = {1, 1, 1}, dscale[3] = {1, 1, 1};
+        readFloats(*object, data, size, {"loc"}, loc, 3);
+        readFloats(*object, data, size, {"dloc"}, dloc, 3);
+        readFloats(*object, data, size, {"size", "scale"}, scale, 3);
+        if (readFloats(*object, data, size, {"dsize", "dscale"}, dscale, 3) &&
+            dscale[0] == 0 && dscale[1] == 0 && dscale[2] == 0) {
+            std::fill(dscale, dscale + 3, 1.0f);
+        }
+
+        Matrix3 rot = rotation(*object, data, size);
+        Matrix4 local = IDENTITY4;
+        for (int c = 0; c < 3; ++c) {
+            for (int r = 0; r < 3; ++r) local[c * 4 + r] = rot[c * 3 + r] * scale[c] * dscale[c];
+            local[12 + c] = loc[c] + dloc[c];
+        }
+
+        const StoredBlock* parent = pointee(*object, data, size, {"parent"});
+        if (parent && depth < MAX_PARENT_DEPTH && std::strncmp(parent->header.code, "OB", 2) == 0) {
+            Matrix4 parentWorld = IDENTITY4;
+            objectMatrix(*parent, parentWorld, depth + 1);
+            Matrix4 parentInverse = IDENTITY4;
+            readFloats(*object, data, size, {"parentinv"}, parentInverse.data(), 16);
+            local = multiply(multiply(parentWorld, parentInverse), local);
+        }
+        out = local;
+    }
+
+    static void transform(const MeshGeometry& geometry, const Matrix4& m, SceneMesh& mesh) {
+        mesh.positions.resize(geometry.positions.size());
+        mesh.triangles = geometry.triangles;
+        for (int a = 0; a < 3; ++a) {
+            mesh.boundsMin[a] = INFINITY;
+            mesh.boundsMax[a] = -INFINITY;
+        }
+
+        for (size_t i = 0; i + 2 < geometry.positions.size(); i += 3) {
+            const float* p = &geometry.positions[i];
+            for (int a = 0; a < 3; ++a) {
+                float v = m[a] * p[0] + m[4 + a] * p[1] + m[8 + a] * p[2] + m[12 + a];
+                mesh.positions[i + a] = v;
+                mesh.boundsMin[a] = std::min(mesh.boundsMin[a], v);
+                mesh.boundsMax[a] = std::max(mesh.boundsMax[a], v);
+            }
+        }
+    }
+
+    const Sdna& m_sdna;
+    const std::vector<StoredBlock>& m_blocks;
+    std::unordered_map<uint64_t, size_t> m_byAddress;
+    std::unordered_map<uint64_t, std::unique_ptr<MeshGeometry>> m_meshes;
+};
+
+} // anonymous namespace
+
+std::optional<std::vector<SceneMesh>> BlendScene::readMeshObjects(const std::filesystem::path& path) {
+    BlendFileLayout layout;
+    std::vector<StoredBlock> blocks;
+    std::optional<std::vector<SceneMesh>> meshes;
+    size_t copiedBytes = 0;
+    bool inMesh = false;    // DATA blocks after an ME block belong to it
+
+    // Blender writes DNA1 after all data blocks, so everything is decoded
+    // there, while mapped payloads are still valid
+    bool complete = BlendParser::walkBlocks(path, layout, [&](const BlendBlockHeader& block, const uint8_t* payload) {
+        if (std::strncmp(block.code, "DNA1", 4) == 0) {
+            auto sdna = Sdna::get(layout.blenderVersion, payload, static_cast<size_t>(block.size),
+                                  layout.is64bit, layout.bigEndian);
+            if (!sdna) return false;
+            meshes = SceneDecoder(*sdna, blocks).decode();
+            return true;
+        }
+
+        bool isObject = std::strncmp(block.code, "OB", 2) == 0 && block.code[2] == '\0';
+        bool isMesh = std::strncmp(block.code, "ME", 2) == 0 && block.code[2] == '\0';
+        bool isData = std::strncmp(block.code, "DATA", 4) == 0;
+        if (!isData) inMesh = isMesh;
+        if (!isObject && !isMesh && !(isData && inMesh)) return true;
+
+        StoredBlock& stored = blocks.emplace_back();
+        stored.header = block;
+        if (!layout.compressed) {
+            stored.payload = payload;   // Stays mapped for the whole walk
+        } else if (copiedBytes + static_cast<size_t>(block.size) <= MAX_COPIED_BYTES) {
+            stored.copy.assign(payload, payload + block.size);
+            stored.payload = stored.copy.data();
+            copiedBytes += static_cast<size_t>(block.size);
+        } else {
+            blocks.pop_back();
+        }
+        return true;
+    });
+
+    if (!complete || !meshes) {
+        DEBUG_LOG("BlendScene: couldn't read " << path.filename());
+        return std::nullopt;
+    }
+    return meshes;
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,54 @@
+/**
+ * @file blend_scene.hpp
+ * @brief World-space mesh geometry read directly from .blend files.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Triangulated geometry of one mesh object, in world space.
+ */
+struct SceneMesh {
+    std::string name;                   ///< Object name without the "OB" prefix
+    std::vector<float> positions;       ///< Vertex positions (x, y, z per vertex)
+    std::vector<uint32_t> triangles;    ///< Vertex indices, three per triangle
+    float boundsMin[3] = {0, 0, 0};     ///< World-space bounding box minimum
+    float boundsMax[3] = {0, 0, 0};     ///< World-space bounding box maximum
+};
+
+/**
+ * @brief Reads mesh objects from a .blend file without Blender.
+ *
+ * Object (OB) and mesh (ME) blocks are decoded with the file's SDNA, so
+ * the same code reads files from every Blender version:
+ * - Vertex positions come from the "position" attribute (3.5+) or the
+ *   MVert array of older files.
+ * - Faces come from face offsets and ".corner_vert" (3.6+), MPoly/MLoop,
+ *   or the legacy MFace array, and are fan-triangulated.
+ * - Object transforms use the stored world matrix when the file has one
+ *   (before 4.2), otherwise they are rebuilt from location, rotation
+ *   (any rotation mode), scale, delta transforms and the parent chain.
+ *
+ * Only the base mesh is read: modifiers, shape keys, instancing and
+ * non-mesh objects (curves, text, ...) are not evaluated.
+ */
+class BlendScene {
+public:
+    /**
+     * @brief Read every mesh object with geometry.
+     * @param path Path to the .blend file
+     * @return Mesh objects in file order (possibly empty), or std::nullopt
+     *         if the file can't be read
+     */
+    static std::optional<std::vector<SceneMesh>> readMeshObjects(const std::filesystem::path& path);
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,457 @@
+#include "block_diff.hpp"
+#include "blend_parser.hpp"
+#include "block_hash.hpp"
+#include "debug.hpp"
+#include "sdna.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Block payloads with this SDNA index are raw arrays, not structs
+constexpr int32_t RAW_DATA_SDNA_INDEX = 0;
+
+// Struct blocks of compressed files are copied until DNA1 arrives, small
+// raw blocks until the walk ends. Past this many bytes, the rest are
+// hashed as they are, pointers included.
+constexpr size_t MAX_PENDING_COPY_BYTES = 512 * 1024 * 1024;
+
+// Raw DATA blocks up to this size are checked for being pointer arrays
+// (Mesh.mat, Object.mat and the like), which are a few pointers long.
+constexpr size_t MAX_POINTER_ARRAY_BYTES = 64 * 1024;
+
+// Bumped whenever the hashing changes, so older digests are recomputed
+constexpr uint32_t DIGEST_CACHE_VERSION = 2;
+
+/**
+ * @brief Byte ranges of the pointer members of each struct, nested structs included.
+ */
+class PointerRanges {
+public:
+    using Range = std::pair<uint32_t, uint32_t>;  // Offset, length
+
+    explicit PointerRanges(const Sdna& sdna) : m_sdna(sdna) {}
+
+    const std::vector<Range>& get(int32_t sdnaIndex) {
+        auto it = m_ranges.find(sdnaIndex);
+        if (it != m_ranges.end()) return it->second;
+
+        std::vector<Range>& ranges = m_ranges[sdnaIndex];
+        if (const Sdna::Struct* st = m_sdna.structAt(sdnaIndex)) {
+            collect(*st, 0, ranges, 0);
+        }
+        return ranges;
+    }
+
+private:
+    void collect(const Sdna::Struct& st, uint32_t base, std::vector<Range>& ranges, int depth) {
+        if (depth > 16) return;  // Malformed SDNA
+
+        for (const auto& field : st.fields) {
+            if (field.isPointer) {
+                ranges.emplace_back(base + field.offset, field.size);
+            } else if (const Sdna::Struct* nested = m_sdna.findStruct(field.type)) {
+                uint32_t elementSize = field.size / std::max<uint32_t>(field.arrayLength, 1);
+                for (uint32_t e = 0; e < field.arrayLength; ++e) {
+                    collect(*nested, base + field.offset + e * elementSize, ranges, depth + 1);
+                }
+            }
+        }
+    }
+
+    const Sdna& m_sdna;
+    std::unordered_map<int32_t, std::vector<Range>> m_ranges;
+};
+
+/**
+ * @brief One block as recorded during the walk.
+ */
+struct BlockRecord {
+    char code[4];
+    int32_t count = 0;
+    uint64_t size = 0;
+    uint64_t hash = 0;
+    std::string idName;             ///< ID.name with its type prefix, for ID blocks
+};
+
+/**
+ * @brief Struct block waiting for DNA1 to be decoded.
+ */
+struct PendingBlock {
+    size_t record = 0;              ///< Index into the records
+    int32_t sdnaIndex = 0;
+    const uint8_t* payload = nullptr; ///< In the mapping, or copy.data()
+    std::vector<uint8_t> copy;      ///< Payload of a compressed file
+};
+
+/**
+ * @brief True if every element of a raw block is null or the address of a block in the file.
+ *
+ * Blender writes pointer arrays as raw DATA blocks, so SDNA can't tell
+ * them apart from float or int arrays; their contents can.
+ */
+bool isPointerArray(const uint8_t* payload, size_t size, const BlendFileLayout& layout,
+                    const std::unordered_set<uint64_t>& addresses) {
+    constexpr bool hostBigEndian = std::endian::native == std::endian::big;
+    bool swap = layout.bigEndian != hostBigEndian;
+
+    if (layout.is64bit) {
+        for (size_t offset = 0; offset < size; offset += 8) {
+            uint64_t value;
+            std::memcpy(&value, payload + offset, 8);
+            if (swap) value = __builtin_bswap64(value);
+            if (value != 0 && !addresses.count(value)) return false;
+        }
+    } else {
+        for (size_t offset = 0; offset < size; offset += 4) {
+            uint32_t value;
+            std::memcpy(&value, payload + offset, 4);
+            if (swap) value = __builtin_bswap32(value);
+            if (value != 0 && !addresses.count(value)) return false;
+        }
+    }
+    return true;
+}
+
+bool isIdCode(const char* code) {
+    return code[0] != '\0' && code[2] == '\0' && code[3] == '\0';
+}
+
+// UI state, rewritten on every save
+bool isUiIdCode(const char* code) {
+    return (code[0] == 'W' && code[1] == 'M') || (code[0] == 'S' && code[1] == 'R') ||
+           (code[0] == 'S' && code[1] == 'N') || (code[0] == 'W' && code[1] == 'S');
+}
+
+std::string keyOf(const std::string& type, const std::string& name) {
+    std::string key = type;
+    key += '\0';
+    key += name;
+    return key;
+}
+
+} // anonymous namespace
+
+BlockDiff::BlockDiff() {
+    const char* home = std::getenv("HOME");
+    if (home) {
+        m_cacheDir = std::filesystem::path(home) / ".cache" / "BlenderFileFinder" / "digests";
+    } else {
+        m_cacheDir = "/tmp/BlenderFileFinder/digests";
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_cacheDir, ec);
+    if (ec) {
+        DEBUG_LOG("Failed to create digest cache directory: " << ec.message());
+    }
+}
+
+std::optional<FileDiff> BlockDiff::compare(const std::filesystem::path& older, const std::filesystem::path& newer) {
+    auto olderDigest = std::async(std::launch::async, [this, &older] { return getDigest(older); });
+    auto newerDigest = getDigest(newer);
+    auto olderResult = olderDigest.get();
+
+    if (!olderResult || !newerDigest) {
+        return std::nullopt;
+    }
+    return diff(*olderResult, *newerDigest);
+}
+
+std::optional<FileDigest> BlockDiff::getDigest(const std::filesystem::path& path) {
+    FileDigest digest;
+    if (loadFromCache(path, digest)) {
+        return digest;
+    }
+
+    auto computed = computeDigest(path);
+    if (computed) {
+        saveToCache(path, *computed);
+    }
+    return computed;
+}
+
+std::optional<FileDigest> BlockDiff::computeDigest(const std::filesystem::path& path) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    FileDigest digest;
+    std::error_code ec;
+    digest.fileSize = std::filesystem::file_size(path, ec);
+    if (ec) return std::nullopt;
+    digest.modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) return std::nullopt;
+
+    BlendFileLayout layout;
+    std::vector<BlockRecord> records;
+    std::vector<PendingBlock> pending;
+    std::vector<PendingBlock> rawArrays;  // Maybe pointer arrays, checked once every address is known
+    std::unordered_set<uint64_t> addresses;
+    size_t pendingCopyBytes = 0;
+    std::shared_ptr<const Sdna> sdna;
+    std::optional<PointerRanges> pointerRanges;
+    const Sdna::Field* nameField = nullptr;
+    std::vector<uint8_t> scratch;
+
+    auto hashBlock = [&](BlockRecord& record, int32_t sdnaIndex, const uint8_t* payload) {
+        size_t size = static_cast<size_t>(record.size);
+
+        if (isIdCode(record.code) && nameField && !nameField->isPointer && nameField->offset < size) {
+            const char* name = reinterpret_cast<const char*>(payload + nameField->offset);
+            record.idName.assign(name, strnlen(name, std::min<size_t>(nameField->size, size - nameField->offset)));
+        }
+
+        const Sdna::Struct* st = pointerRanges ? sdna->structAt(sdnaIndex) : nullptr;
+        const auto* ranges = st && sdnaIndex != RAW_DATA_SDNA_INDEX ? &pointerRanges->get(sdnaIndex) : nullptr;
+        if (!ranges || ranges->empty() || st->size == 0) {
+            record.hash = BlockHash::compute(payload, size);
+            return;
+        }
+
+        scratch.assign(payload, payload + size);
+        for (size_t element = 0; element + st->size <= size; element += st->size) {
+            for (const auto& [offset, length] : *ranges) {
+                if (offset + length <= st->size) std::memset(scratch.data() + element + offset, 0, length);
+            }
+        }
+        record.hash = BlockHash::compute(scratch.data(), size);
+    };
+
+    bool complete = BlendParser::walkBlocks(path, layout, [&](const BlendBlockHeader& block, const uint8_t* payload) {
+        if (std::strncmp(block.code, "DNA1", 4) == 0) {
+            sdna = Sdna::get(layout.blenderVersion, payload, static_cast<size_t>(block.size),
+                             layout.is64bit, layout.bigEndian);
+            if (!sdna) return false;
+
+            pointerRanges.emplace(*sdna);
+            const Sdna::Struct* id = sdna->findStruct("ID");
+            nameField = id ? id->findField("name") : nullptr;
+
+            for (const auto& waiting : pending) {
+                hashBlock(records[waiting.record], waiting.sdnaIndex, waiting.payload);
+            }
+            pending.clear();
+            return true;
+        }
+
+        BlockRecord& record = records.emplace_back();
+        std::memcpy(record.code, block.code, 4);
+        record.count = block.count;
+        record.size = static_cast<uint64_t>(block.size);
+        addresses.insert(block.oldAddress);
+
+        size_t pointerSize = layout.is64bit ? 8 : 4;
+        if (block.sdnaIndex == RAW_DATA_SDNA_INDEX && std::strncmp(block.code, "DATA", 4) == 0 &&
+            record.size > 0 && record.size <= MAX_POINTER_ARRAY_BYTES && record.size % pointerSize == 0 &&
+            pendingCopyBytes + record.size <= MAX_PENDING_COPY_BYTES) {
+            // Copied even when mapped: they're checked after the walk
+            PendingBlock& raw = rawArrays.emplace_back();
+            raw.record = records.size() - 1;
+            raw.copy.assign(payload, payload + block.size);
+            raw.payload = raw.copy.data();
+            pendingCopyBytes += record.size;
+            return true;
+        }
+
+        // Raw arrays (most of the bytes in a big scene) need no SDNA. ID
+        // blocks always wait, their names are read with it.
+        if (sdna || (block.sdnaIndex == RAW_DATA_SDNA_INDEX && !isIdCode(block.code))) {
+            hashBlock(record, block.sdnaIndex, payload);
+            return true;
+        }
+
+        PendingBlock& waiting = pending.emplace_back();
+        waiting.record = records.size() - 1;
+        waiting.sdnaIndex = block.sdnaIndex;
+        if (!layout.compressed) {
+            waiting.payload = payload;  // Stays mapped for the whole walk
+        } else if (isIdCode(block.code) || pendingCopyBytes + record.size <= MAX_PENDING_COPY_BYTES) {
+            waiting.copy.assign(payload, payload + block.size);
+            waiting.payload = waiting.copy.data();
+            pendingCopyBytes += record.size;
+        } else {
+            pending.pop_back();
+            record.hash = BlockHash::compute(payload, static_cast<size_t>(block.size));
+        }
+        return true;
+    });
+
+    if (!complete || !sdna) {
+        DEBUG_LOG("BlockDiff: couldn't read all blocks of " << path.filename());
+        return std::nullopt;
+    }
+
+    // Pointer arrays change with every save just like pointer members do
+    for (const auto& raw : rawArrays) {
+        BlockRecord& record = records[raw.record];
+        size_t size = static_cast<size_t>(record.size);
+        if (isPointerArray(raw.payload, size, layout, addresses)) {
+            scratch.assign(size, 0);
+            record.hash = BlockHash::compute(scratch.data(), size);
+        } else {
+            record.hash = BlockHash::compute(raw.payload, size);
+        }
+    }
+
+    // Every ID block starts a datablock; the DATA blocks after it belong to it
+    DatablockDigest* current = nullptr;
+    for (const auto& record : records) {
+        if (isIdCode(record.code)) {
+            current = nullptr;
+            if (isUiIdCode(record.code) || record.idName.size() <= 2 ||
+                record.idName[0] != record.code[0] || record.idName[1] != record.code[1]) {
+                continue;
+            }
+
+            current = &digest.datablocks.emplace_back();
+            current->type = record.idName.substr(0, 2);
+            current->name = record.idName.substr(2);
+        } else if (std::strncmp(record.code, "DATA", 4) != 0) {
+            current = nullptr;
+            continue;
+        }
+
+        if (current) {
+            current->hash = BlockHash::combine(current->hash, record.hash);
+            current->hash = BlockHash::combine(current->hash, static_cast<uint64_t>(record.count));
+            current->size += record.size;
+        }
+    }
+
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    DEBUG_LOG("BlockDiff: hashed " << path.filename() << " (" << records.size() << " blocks, "
+              << digest.datablocks.size() << " datablocks) in " << totalMs << "ms using "
+              << BlockHash::implementation());
+
+    return digest;
+}
+
+FileDiff BlockDiff::diff(const FileDigest& older, const FileDigest& newer) {
+    FileDiff result;
+
+    // Linked datablocks can share a local one's name; the first occurrence wins
+    std::unordered_map<std::string, const DatablockDigest*> olderByKey;
+    olderByKey.reserve(older.datablocks.size());
+    for (const auto& datablock : older.datablocks) {
+        olderByKey.emplace(keyOf(datablock.type, datablock.name), &datablock);
+    }
+
+    for (const auto& datablock : newer.datablocks) {
+        auto it = olderByKey.find(keyOf(datablock.type, datablock.name));
+        if (it == olderByKey.end()) {
+            result.changes.push_back({DatablockChange::Kind::Added, datablock.type, datablock.name, 0, datablock.size});
+            continue;
+        }
+
+        const DatablockDigest* previous = it->second;
+        if (previous->hash != datablock.hash) {
+            result.changes.push_back({DatablockChange::Kind::Changed, datablock.type, datablock.name,
+                                      previous->size, datablock.size});
+        } else {
+            result.unchangedCount++;
+        }
+        olderByKey.erase(it);
+    }
+
+    for (const auto& [key, datablock] : olderByKey) {
+        result.changes.push_back({DatablockChange::Kind::Removed, datablock->type, datablock->name, datablock->size, 0});
+    }
+
+    std::sort(result.changes.begin(), result.changes.end(), [](const DatablockChange& a, const DatablockChange& b) {
+        if (a.type != b.type) return a.type < b.type;
+        return a.name < b.name;
+    });
+
+    return result;
+}
+
+std::filesystem::path BlockDiff::getCachePath(const std::filesystem::path& blendFile) const {
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16)
+       << std::hash<std::string>{}(blendFile.string()) << ".digest";
+    return m_cacheDir / ss.str();
+}
+
+bool BlockDiff::loadFromCache(const std::filesystem::path& blendFile, FileDigest& digest) const {
+    std::ifstream file(getCachePath(blendFile), std::ios::binary);
+    if (!file) {
+        return false;  // Cache miss
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&digest.modifiedTime), sizeof(digest.modifiedTime));
+    file.read(reinterpret_cast<char*>(&digest.fileSize), sizeof(digest.fileSize));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, "BFFD", 4) != 0 || version != DIGEST_CACHE_VERSION) {
+        return false;
+    }
+
+    // A digest is only as good as the exact file it was computed from
+    std::error_code ec;
+    auto modTime = std::filesystem::last_write_time(blendFile, ec);
+    if (ec || modTime.time_since_epoch().count() != digest.modifiedTime) return false;
+    auto size = std::filesystem::file_size(blendFile, ec);
+    if (ec || size != digest.fileSize) return false;
+
+    digest.datablocks.clear();
+    digest.datablocks.reserve(std::min<uint32_t>(count, 1u << 20));
+    for (uint32_t i = 0; i < count; ++i) {
+        DatablockDigest& datablock = digest.datablocks.emplace_back();
+        char type[2];
+        uint16_t nameLength = 0;
+        file.read(type, 2);
+        file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        if (!file) return false;
+
+        datablock.type.assign(type, 2);
+        datablock.name.resize(nameLength);
+        file.read(datablock.name.data(), nameLength);
+        file.read(reinterpret_cast<char*>(&datablock.hash), sizeof(datablock.hash));
+        file.read(reinterpret_cast<char*>(&datablock.size), sizeof(datablock.size));
+        if (!file) return false;
+    }
+
+    return true;
+}
+
+void BlockDiff::saveToCache(const std::filesystem::path& blendFile, const FileDigest& digest) const {
+    std::ofstream file(getCachePath(blendFile), std::ios::binary);
+    if (!file) {
+        return;  // Can't write cache
+    }
+
+    // Layout: "BFFD", version, mod time, file size, entry count, then per
+    // entry type[2], name length, name, hash, size
+    file.write("BFFD", 4);
+    uint32_t version = DIGEST_CACHE_VERSION;
+    uint32_t count = static_cast<uint32_t>(digest.datablocks.size());
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&digest.modifiedTime), sizeof(digest.modifiedTime));
+    file.write(reinterpret_cast<const char*>(&digest.fileSize), sizeof(digest.fileSize));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    for (const auto& datablock : digest.datablocks) {
+        uint16_t nameLength = static_cast<uint16_t>(std::min<size_t>(datablock.name.size(), UINT16_MAX));
+        file.write(datablock.type.data(), 2);
+        file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        file.write(datablock.name.data(), nameLength);
+        file.write(reinterpret_cast<const char*>(&datablock.hash), sizeof(datablock.hash));
+        file.write(reinterpret_cast<const char*>(&datablock.size), sizeof(datablock.size));
+    }
+}
+
+} // namespace BlenderFileFinder
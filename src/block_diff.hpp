@@ -0,0 +1,136 @@
+/**
+ * @file block_diff.hpp
+ * @brief Datablock-level comparison of two versions of a .blend file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Content hash of one ID datablock.
+ */
+struct DatablockDigest {
+    std::string type;               ///< Two-letter ID code (e.g., "OB", "MA")
+    std::string name;               ///< Name without the ID code prefix
+    uint64_t hash = 0;              ///< Hash of the ID block and the data blocks written with it
+    uint64_t size = 0;              ///< Payload bytes of those blocks
+};
+
+/**
+ * @brief Datablock hashes of one version of a file.
+ */
+struct FileDigest {
+    int64_t modifiedTime = 0;       ///< File modification time (file_time_type ticks) hashed
+    uint64_t fileSize = 0;          ///< File size on disk hashed
+    std::vector<DatablockDigest> datablocks; ///< In file order
+};
+
+/**
+ * @brief One difference found by BlockDiff.
+ */
+struct DatablockChange {
+    enum class Kind {
+        Added,                      ///< Only in the newer file
+        Removed,                    ///< Only in the older file
+        Changed                     ///< In both, with different content
+    };
+
+    Kind kind = Kind::Changed;
+    std::string type;               ///< Two-letter ID code (e.g., "OB", "MA")
+    std::string name;               ///< Name without the ID code prefix
+    uint64_t oldSize = 0;           ///< Payload bytes in the older file (0 if added)
+    uint64_t newSize = 0;           ///< Payload bytes in the newer file (0 if removed)
+};
+
+/**
+ * @brief Result of comparing two files.
+ */
+struct FileDiff {
+    std::vector<DatablockChange> changes;   ///< Ordered by type, then name
+    size_t unchangedCount = 0;              ///< Datablocks identical in both files
+};
+
+/**
+ * @brief Compares versions of a .blend file datablock by datablock.
+ *
+ * Each file is reduced to a FileDigest: every ID block is hashed together
+ * with the DATA blocks Blender writes after it (BlockHash over the
+ * payloads, mmap'ed for uncompressed files). Two digests are then matched
+ * by type and name.
+ *
+ * Blender writes pointers as the memory addresses they had when the file
+ * was saved, so an untouched datablock would hash differently on every
+ * save. Pointer members are therefore zeroed (using the file's SDNA)
+ * before hashing struct blocks. Pointer arrays such as Mesh.mat are raw
+ * DATA blocks without SDNA; a small raw block holding only nulls and
+ * addresses of other blocks in the file is taken to be one and zeroed too. Window manager, screen and workspace
+ * datablocks are UI state that changes on every save and are left out.
+ *
+ * Digests are cached on disk per (file, modification time) under
+ * ~/.cache/BlenderFileFinder/digests/, so comparing against a version
+ * that was already hashed only reads the other file.
+ *
+ * @par Usage Example:
+ * @code
+ * BlockDiff differ;
+ * if (auto diff = differ.compare("shot_v012.blend", "shot_v013.blend")) {
+ *     for (const auto& change : diff->changes) {
+ *         // change.kind, change.type, change.name
+ *     }
+ * }
+ * @endcode
+ */
+class BlockDiff {
+public:
+    BlockDiff();
+
+    /**
+     * @brief Compare two files.
+     *
+     * Digests missing from the cache are computed in parallel. Blocking;
+     * call from a worker thread.
+     *
+     * @param older Earlier version (e.g. shot_v012.blend or shot.blend1)
+     * @param newer Later version
+     * @return Differences, or std::nullopt if either file can't be read
+     */
+    std::optional<FileDiff> compare(const std::filesystem::path& older, const std::filesystem::path& newer);
+
+    /**
+     * @brief Get the digest of a file, from the cache if it's current.
+     * @param path Path to the .blend file
+     * @return Digest, or std::nullopt if the file can't be read
+     */
+    std::optional<FileDigest> getDigest(const std::filesystem::path& path);
+
+    /**
+     * @brief Hash a file's datablocks, bypassing the cache.
+     * @param path Path to the .blend file
+     * @return Digest, or std::nullopt if the file can't be read
+     */
+    static std::optional<FileDigest> computeDigest(const std::filesystem::path& path);
+
+    /**
+     * @brief Match two digests by datablock type and name.
+     * @param older Digest of the earlier version
+     * @param newer Digest of the later version
+     * @return Differences
+     */
+    static FileDiff diff(const FileDigest& older, const FileDigest& newer);
+
+private:
+    std::filesystem::path getCachePath(const std::filesystem::path& blendFile) const;
+    bool loadFromCache(const std::filesystem::path& blendFile, FileDigest& digest) const;
+    void saveToCache(const std::filesystem::path& blendFile, const FileDigest& digest) const;
+
+    std::filesystem::path m_cacheDir;   ///< Directory for cached digests
+};
+
+} // namespace BlenderFileFinder
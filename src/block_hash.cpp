@@ -0,0 +1,206 @@
+#include "block_hash.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BFF_HASH_X86 1
+#endif
+
+namespace BlenderFileFinder {
+
+namespace {
+
+constexpr size_t STRIPE_SIZE = 64;          // 8 lanes of 64 bits
+constexpr size_t STRIPES_PER_ROUND = 16;    // Accumulators are scrambled every 1 KiB
+
+constexpr uint32_t PRIME32_1 = 0x9E3779B1U;
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+alignas(32) constexpr uint64_t STRIPE_KEY[8] = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL,
+    0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL, 0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL,
+};
+alignas(32) constexpr uint64_t SCRAMBLE_KEY[8] = {
+    0xCB00C391BB52283CULL, 0xA32E531B8B65D088ULL, 0x4EF90DA297486471ULL, 0xD8ACDEA946EF1938ULL,
+    0x3F349CE33F76FAA8ULL, 0x1D4F0BC7C7BBDCF9ULL, 0x3159B4CD4BE0518AULL, 0x647378D9C97E9FC8ULL,
+};
+
+uint64_t readLE64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+// Every implementation defines the same per-lane arithmetic:
+//   acc[i ^ 1] += d[i]
+//   acc[i]     += lo32(d[i] ^ key[i]) * hi32(d[i] ^ key[i])
+// and after each round of STRIPES_PER_ROUND stripes:
+//   acc[i] = (acc[i] ^ (acc[i] >> 47) ^ scrambleKey[i]) * PRIME32_1
+
+void accumulateStripeScalar(uint64_t acc[8], const uint8_t* stripe) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t data = readLE64(stripe + i * 8);
+        uint64_t keyed = data ^ STRIPE_KEY[i];
+        acc[i ^ 1] += data;
+        acc[i] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+    }
+}
+
+void scrambleScalar(uint64_t acc[8]) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= SCRAMBLE_KEY[i];
+        acc[i] = a * PRIME32_1;
+    }
+}
+
+void accumulateScalar(uint64_t acc[8], const uint8_t* data, size_t stripes) {
+    for (size_t s = 0; s < stripes; ++s) {
+        accumulateStripeScalar(acc, data + s * STRIPE_SIZE);
+        if ((s + 1) % STRIPES_PER_ROUND == 0) scrambleScalar(acc);
+    }
+}
+
+#ifdef BFF_HASH_X86
+
+__attribute__((target("sse2")))
+void accumulateSse2(uint64_t acc[8], const uint8_t* data, size_t stripes) {
+    __m128i a[4];
+    for (int k = 0; k < 4; ++k) a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + k);
+
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+    for (size_t s = 0; s < stripes; ++s) {
+        const uint8_t* stripe = data + s * STRIPE_SIZE;
+        for (int k = 0; k < 4; ++k) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe) + k);
+            __m128i key = _mm_load_si128(reinterpret_cast<const __m128i*>(STRIPE_KEY) + k);
+            __m128i keyed = _mm_xor_si128(d, key);
+            __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[k] = _mm_add_epi64(a[k], _mm_add_epi64(product, swapped));
+        }
+
+        if ((s + 1) % STRIPES_PER_ROUND == 0) {
+            for (int k = 0; k < 4; ++k) {
+                __m128i key = _mm_load_si128(reinterpret_cast<const __m128i*>(SCRAMBLE_KEY) + k);
+                __m128i x = _mm_xor_si128(_mm_xor_si128(a[k], _mm_srli_epi64(a[k], 47)), key);
+                __m128i lo = _mm_mul_epu32(x, prime);
+                __m128i hi = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+                a[k] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+            }
+        }
+    }
+
+    for (int k = 0; k < 4; ++k) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + k, a[k]);
+}
+
+__attribute__((target("avx2")))
+void accumulateAvx2(uint64_t acc[8], const uint8_t* data, size_t stripes) {
+    __m256i a[2];
+    for (int k = 0; k < 2; ++k) a[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + k);
+
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+    for (size_t s = 0; s < stripes; ++s) {
+        const uint8_t* stripe = data + s * STRIPE_SIZE;
+        for (int k = 0; k < 2; ++k) {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe) + k);
+            __m256i key = _mm256_load_si256(reinterpret_cast<const __m256i*>(STRIPE_KEY) + k);
+            __m256i keyed = _mm256_xor_si256(d, key);
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[k] = _mm256_add_epi64(a[k], _mm256_add_epi64(product, swapped));
+        }
+
+        if ((s + 1) % STRIPES_PER_ROUND == 0) {
+            for (int k = 0; k < 2; ++k) {
+                __m256i key = _mm256_load_si256(reinterpret_cast<const __m256i*>(SCRAMBLE_KEY) + k);
+                __m256i x = _mm256_xor_si256(_mm256_xor_si256(a[k], _mm256_srli_epi64(a[k], 47)), key);
+                __m256i lo = _mm256_mul_epu32(x, prime);
+                __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), prime);
+                a[k] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+            }
+        }
+    }
+
+    for (int k = 0; k < 2; ++k) _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + k, a[k]);
+}
+
+#endif // BFF_HASH_X86
+
+using AccumulateFn = void (*)(uint64_t acc[8], const uint8_t* data, size_t stripes);
+
+struct Implementation {
+    AccumulateFn accumulate;
+    const char* name;
+};
+
+Implementation selectImplementation() {
+#ifdef BFF_HASH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {accumulateAvx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {accumulateSse2, "sse2"};
+#endif
+    return {accumulateScalar, "scalar"};
+}
+
+const Implementation& selectedImplementation() {
+    static const Implementation selected = selectImplementation();
+    return selected;
+}
+
+uint64_t mulFold64(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+} // anonymous namespace
+
+uint64_t BlockHash::compute(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t acc[8] = {PRIME32_1, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME64_5, PRIME64_1 ^ PRIME64_4,
+                       PRIME64_2 ^ PRIME64_5};
+
+    size_t stripes = size / STRIPE_SIZE;
+    if (stripes > 0) {
+        selectedImplementation().accumulate(acc, bytes, stripes);
+    }
+
+    // The zero padding is told apart from real zeros by the length below
+    size_t tail = size % STRIPE_SIZE;
+    if (tail > 0) {
+        uint8_t last[STRIPE_SIZE] = {};
+        std::memcpy(last, bytes + stripes * STRIPE_SIZE, tail);
+        accumulateStripeScalar(acc, last);
+    }
+
+    uint64_t h = static_cast<uint64_t>(size) * PRIME64_1;
+    for (size_t i = 0; i < 8; i += 2) {
+        h += mulFold64(acc[i] ^ STRIPE_KEY[i], acc[i + 1] ^ SCRAMBLE_KEY[i + 1]);
+    }
+    return avalanche(h);
+}
+
+uint64_t BlockHash::combine(uint64_t seed, uint64_t value) {
+    return avalanche(mulFold64(seed ^ PRIME64_3, value ^ PRIME64_2) + seed);
+}
+
+const char* BlockHash::implementation() {
+    return selectedImplementation().name;
+}
+
+} // namespace BlenderFileFinder
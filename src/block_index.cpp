@@ -0,0 +1,224 @@
+#include "block_index.hpp"
+#include "debug.hpp"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+constexpr char INDEX_MAGIC[4] = {'B', 'F', 'B', 'I'};
+constexpr uint32_t INDEX_VERSION = 1;
+constexpr size_t FILE_HEADER_SIZE = 12;         ///< "BLENDER" + pointer size + endianness + version
+constexpr uint32_t MAX_INDEXED_BLOCKS = 16 * 1024 * 1024;
+
+enum IndexFlags : uint8_t {
+    FLAG_64BIT = 1 << 0,
+    FLAG_BIG_ENDIAN = 1 << 1,
+    FLAG_COMPRESSED = 1 << 2
+};
+
+/**
+ * @brief On-disk form of an entry. Offsets are not stored: blocks are
+ * contiguous, so they follow from the sizes.
+ */
+struct StoredEntry {
+    char code[4];
+    int32_t size;
+    int32_t sdnaIndex;
+    int32_t count;
+};
+static_assert(sizeof(StoredEntry) == 16, "StoredEntry must be packed");
+
+std::mutex s_directoryMutex;
+std::filesystem::path s_directory;
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value) {
+    file.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return static_cast<bool>(file);
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // anonymous namespace
+
+const BlockIndexEntry* BlockIndex::find(const char* code) const {
+    for (const auto& entry : blocks) {
+        if (std::memcmp(entry.code, code, 4) == 0) return &entry;
+    }
+    return nullptr;
+}
+
+void BlockIndex::setStorageDirectory(const std::filesystem::path& directory) {
+    if (!directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            DEBUG_LOG("Failed to create block index directory: " << ec.message());
+            return;
+        }
+        DEBUG_LOG("Block index directory: " << directory);
+    }
+
+    std::lock_guard<std::mutex> lock(s_directoryMutex);
+    s_directory = directory;
+}
+
+std::filesystem::path BlockIndex::storageDirectory() {
+    std::lock_guard<std::mutex> lock(s_directoryMutex);
+    return s_directory;
+}
+
+std::filesystem::path BlockIndex::indexPath(const std::filesystem::path& blendFile) {
+    std::filesystem::path directory = storageDirectory();
+    if (directory.empty()) return {};
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16)
+       << std::hash<std::string>{}(blendFile.string()) << ".bidx";
+    return directory / ss.str();
+}
+
+std::optional<BlockIndex> BlockIndex::load(const std::filesystem::path& blendFile,
+                                           uint64_t fileSize, int64_t modifiedTime) {
+    std::filesystem::path path = indexPath(blendFile);
+    if (path.empty()) return std::nullopt;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;  // Not indexed yet
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    file.read(magic, 4);
+    if (!file || std::memcmp(magic, INDEX_MAGIC, 4) != 0 ||
+        !readValue(file, version) || version != INDEX_VERSION) {
+        return std::nullopt;
+    }
+
+    BlockIndex index;
+    uint8_t flags = 0;
+    uint32_t pathLength = 0;
+    if (!readValue(file, index.fileSize) || !readValue(file, index.modifiedTime) ||
+        !readValue(file, flags) || !readValue(file, pathLength)) {
+        return std::nullopt;
+    }
+
+    // Stale: the file was rewritten since it was indexed
+    if (index.fileSize != fileSize || index.modifiedTime != modifiedTime) {
+        return std::nullopt;
+    }
+
+    // Guard against hash collisions between paths
+    std::string storedPath(pathLength, '\0');
+    file.read(storedPath.data(), pathLength);
+    if (!file || storedPath != blendFile.string()) {
+        return std::nullopt;
+    }
+
+    index.is64bit = (flags & FLAG_64BIT) != 0;
+    index.bigEndian = (flags & FLAG_BIG_ENDIAN) != 0;
+    index.compressed = (flags & FLAG_COMPRESSED) != 0;
+
+    uint32_t blockCount = 0;
+    if (!readValue(file, blockCount) || blockCount > MAX_INDEXED_BLOCKS) {
+        return std::nullopt;
+    }
+
+    std::vector<StoredEntry> stored(blockCount);
+    file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size() * sizeof(StoredEntry)));
+    if (!file) {
+        return std::nullopt;
+    }
+
+    uint64_t headerSize = index.is64bit ? 24 : 20;
+    uint64_t offset = FILE_HEADER_SIZE;
+    index.blocks.resize(blockCount);
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        BlockIndexEntry& entry = index.blocks[i];
+        std::memcpy(entry.code, stored[i].code, 4);
+        entry.size = stored[i].size;
+        entry.sdnaIndex = stored[i].sdnaIndex;
+        entry.count = stored[i].count;
+        entry.offset = offset + headerSize;
+        offset = entry.offset + static_cast<uint64_t>(entry.size);
+    }
+
+    return index;
+}
+
+bool BlockIndex::save(const std::filesystem::path& blendFile, const BlockIndex& index) {
+    std::filesystem::path path = indexPath(blendFile);
+    if (path.empty()) return false;
+
+    // Unique temp name so concurrent parses of the same file don't interleave
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            DEBUG_LOG("Failed to write block index: " << tempPath);
+            return false;
+        }
+
+        uint8_t flags = (index.is64bit ? FLAG_64BIT : 0) |
+                        (index.bigEndian ? FLAG_BIG_ENDIAN : 0) |
+                        (index.compressed ? FLAG_COMPRESSED : 0);
+        std::string pathString = blendFile.string();
+
+        file.write(INDEX_MAGIC, 4);
+        writeValue(file, INDEX_VERSION);
+        writeValue(file, index.fileSize);
+        writeValue(file, index.modifiedTime);
+        writeValue(file, flags);
+        writeValue(file, static_cast<uint32_t>(pathString.size()));
+        file.write(pathString.data(), static_cast<std::streamsize>(pathString.size()));
+        writeValue(file, static_cast<uint32_t>(index.blocks.size()));
+
+        std::vector<StoredEntry> stored(index.blocks.size());
+        for (size_t i = 0; i < index.blocks.size(); ++i) {
+            std::memcpy(stored[i].code, index.blocks[i].code, 4);
+            stored[i].size = index.blocks[i].size;
+            stored[i].sdnaIndex = index.blocks[i].sdnaIndex;
+            stored[i].count = index.blocks[i].count;
+        }
+        file.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size() * sizeof(StoredEntry)));
+
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        DEBUG_LOG("Failed to store block index: " << ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void BlockIndex::remove(const std::filesystem::path& blendFile) {
+    std::filesystem::path path = indexPath(blendFile);
+    if (path.empty()) return;
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+} // namespace BlenderFileFinder
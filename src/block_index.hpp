@@ -0,0 +1,120 @@
+/**
+ * @file block_index.hpp
+ * @brief Persistent per-file index of .blend block locations.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Location and header fields of one block in a .blend file.
+ */
+struct BlockIndexEntry {
+    char code[4];               ///< Block type code (e.g., "TEST", "ME\0\0")
+    int32_t size = 0;           ///< Payload size in bytes
+    int32_t sdnaIndex = 0;      ///< SDNA structure index
+    int32_t count = 0;          ///< Number of structures in block
+    uint64_t offset = 0;        ///< Payload offset (in decompressed bytes for compressed files)
+};
+
+/**
+ * @brief Block chain of a single .blend file, cached on disk.
+ *
+ * Finding a block in a .blend file means walking the chain of block
+ * headers from the start of the file, one seek per block. A full walk of
+ * a production scene is tens of thousands of seeks, which is what makes
+ * files without a thumbnail, or any query for data near the end of the
+ * file (DNA1), slow over network mounts.
+ *
+ * The parser records the chain whenever it walks a file to ENDB and
+ * stores it with save(). Later parses of the same, unmodified file load
+ * it and seek straight to the blocks they need. Entries are keyed by the
+ * file's size and modification time, so any change to the file
+ * invalidates its index.
+ *
+ * Indexes live in one small file per .blend file under the directory set
+ * with setStorageDirectory() (next to the database). With no directory
+ * set, load() and save() do nothing.
+ *
+ * @par Usage Example:
+ * @code
+ * if (auto index = BlockIndex::load(path, fileSize, modifiedTime)) {
+ *     if (const BlockIndexEntry* test = index->find("TEST")) {
+ *         // seek to test->offset and read test->size bytes
+ *     }
+ * }
+ * @endcode
+ */
+class BlockIndex {
+public:
+    uint64_t fileSize = 0;              ///< Size of the indexed file on disk
+    int64_t modifiedTime = 0;           ///< Modification time (file_time_type ticks)
+    bool is64bit = true;                ///< File uses 8-byte pointers
+    bool bigEndian = false;             ///< File is big-endian
+    bool compressed = false;            ///< Offsets refer to decompressed data
+    std::vector<BlockIndexEntry> blocks; ///< Blocks in file order, excluding ENDB
+
+    /**
+     * @brief Find the first block with an exact 4-byte code.
+     * @param code Block code, NUL-padded to 4 bytes for ID codes ("ME\0\0")
+     * @return Entry, or nullptr if the file has no such block
+     */
+    const BlockIndexEntry* find(const char* code) const;
+
+    /**
+     * @brief Set the directory index files are stored in.
+     *
+     * Call once at startup, before any parsing threads run. An empty path
+     * disables the index.
+     *
+     * @param directory Directory to store index files in (created if missing)
+     */
+    static void setStorageDirectory(const std::filesystem::path& directory);
+
+    /**
+     * @brief Get the directory index files are stored in.
+     * @return Directory, or an empty path if the index is disabled
+     */
+    static std::filesystem::path storageDirectory();
+
+    /**
+     * @brief Load the stored index for a file if it is still current.
+     * @param blendFile Path to the .blend file
+     * @param fileSize Current size of the file
+     * @param modifiedTime Current modification time (file_time_type ticks)
+     * @return Index, or std::nullopt if none is stored or it is stale
+     */
+    static std::optional<BlockIndex> load(const std::filesystem::path& blendFile,
+                                          uint64_t fileSize, int64_t modifiedTime);
+
+    /**
+     * @brief Store the index for a file, replacing any previous one.
+     *
+     * The file is written under a temporary name and renamed into place,
+     * so concurrent readers never see a partial index.
+     *
+     * @param blendFile Path to the .blend file
+     * @param index Complete block chain of the file
+     * @return true if written successfully
+     */
+    static bool save(const std::filesystem::path& blendFile, const BlockIndex& index);
+
+    /**
+     * @brief Delete the stored index for a file.
+     * @param blendFile Path to the .blend file
+     */
+    static void remove(const std::filesystem::path& blendFile);
+
+private:
+    static std::filesystem::path indexPath(const std::filesystem::path& blendFile);
+};
+
+} // namespace BlenderFileFinder
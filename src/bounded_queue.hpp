@@ -0,0 +1,123 @@
+/**
+ * @file bounded_queue.hpp
+ * @brief Blocking fixed-capacity queue connecting pipeline stages.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Multi-producer, multi-consumer queue with a capacity limit.
+ *
+ * Producers block while the queue is full, so a fast stage can't run
+ * ahead of a slow one and memory stays bounded. Consumers block until an
+ * item arrives or the queue is closed and drained.
+ *
+ * Blocked calls also return when the given cancel flag is set; they
+ * recheck it every few milliseconds, so the flag can be an ordinary
+ * atomic owned by someone else (e.g. Scanner::stopScan()).
+ *
+ * @tparam T Item type (moved in and out)
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Create a queue.
+     * @param capacity Maximum number of queued items
+     */
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Add an item, waiting while the queue is full.
+     * @param item Item to add
+     * @param cancel Returns early when set
+     * @return false if the queue was closed or @p cancel was set
+     */
+    bool push(T item, const std::atomic<bool>& cancel) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_items.size() >= m_capacity && !m_closed) {
+            if (cancel) return false;
+            m_notFull.wait_for(lock, POLL_INTERVAL);
+        }
+        if (m_closed || cancel) return false;
+
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item, waiting until one arrives.
+     * @param cancel Returns early when set
+     * @return Item, or std::nullopt once the queue is closed and empty or
+     *         @p cancel was set
+     */
+    std::optional<T> pop(const std::atomic<bool>& cancel) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_items.empty() && !m_closed) {
+            if (cancel) return std::nullopt;
+            m_notEmpty.wait_for(lock, POLL_INTERVAL);
+        }
+        return takeLocked();
+    }
+
+    /**
+     * @brief Take the oldest item, waiting at most @p timeout.
+     * @param timeout Longest time to wait for an item
+     * @return Item, or std::nullopt if none arrived in time
+     */
+    std::optional<T> popFor(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait_for(lock, timeout, [this] { return !m_items.empty() || m_closed; });
+        return takeLocked();
+    }
+
+    /**
+     * @brief Stop accepting items; consumers drain what is left.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    /**
+     * @brief Check whether the queue is closed and empty.
+     * @return true once no more items will come out
+     */
+    bool isFinished() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_closed && m_items.empty();
+    }
+
+private:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{20};
+
+    std::optional<T> takeLocked() {
+        if (m_items.empty()) return std::nullopt;
+        T item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return item;
+    }
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<T> m_items;
+    bool m_closed = false;
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,335 @@
+#include "compressed_stream.hpp"
+#include "debug.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <zlib.h>
+
+#ifdef BFF_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace BlenderFileFinder {
+
+namespace {
+
+constexpr uint32_t ZSTD_FRAME_MAGIC = 0xFD2FB528;
+constexpr uint32_t ZSTD_SKIPPABLE_MAGIC = 0x184D2A5E;     ///< Skippable frame holding the seek table
+constexpr uint32_t ZSTD_SEEKABLE_MAGIC = 0x8F92EAB1;      ///< Seek table footer magic
+constexpr size_t ZSTD_SEEKABLE_FOOTER_SIZE = 9;           ///< Frame count + flags + magic
+
+uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/**
+ * @brief Streaming gzip reader for pre-3.0 compressed .blend files.
+ *
+ * gzip has no random access, so skip() inflates into a fixed scratch
+ * buffer and discards it. Memory use is the input buffer, the scratch
+ * buffer and zlib's 32KB window, independent of the file size.
+ */
+class GzipStream : public CompressedStream {
+public:
+    bool open(const std::filesystem::path& path) {
+        m_file.open(path, std::ios::binary);
+        if (!m_file) return false;
+
+        // 16 + MAX_WBITS: expect a gzip header and trailer
+        if (inflateInit2(&m_zstream, 16 + MAX_WBITS) != Z_OK) return false;
+        m_initialized = true;
+
+        m_input.resize(64 * 1024);
+        m_scratch.resize(64 * 1024);
+        return true;
+    }
+
+    ~GzipStream() override {
+        if (m_initialized) {
+            inflateEnd(&m_zstream);
+        }
+    }
+
+    bool read(void* dst, size_t size) override {
+        m_zstream.next_out = static_cast<Bytef*>(dst);
+        m_zstream.avail_out = static_cast<uInt>(size);
+
+        while (m_zstream.avail_out > 0) {
+            if (m_finished) return false;
+
+            if (m_zstream.avail_in == 0 && !refill()) {
+                return false;
+            }
+
+            int ret = inflate(&m_zstream, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                m_finished = true;
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                DEBUG_LOG("GzipStream: inflate failed (" << ret << ")");
+                return false;
+            }
+        }
+
+        m_position += size;
+        return true;
+    }
+
+    bool skip(uint64_t size) override {
+        while (size > 0) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, m_scratch.size()));
+            if (!read(m_scratch.data(), chunk)) {
+                return false;
+            }
+            size -= chunk;
+        }
+        return true;
+    }
+
+    Format format() const override { return Format::Gzip; }
+
+private:
+    bool refill() {
+        m_file.read(reinterpret_cast<char*>(m_input.data()), static_cast<std::streamsize>(m_input.size()));
+        size_t got = static_cast<size_t>(m_file.gcount());
+        if (got == 0) return false;
+
+        m_compressedBytesRead += got;
+        m_zstream.next_in = m_input.data();
+        m_zstream.avail_in = static_cast<uInt>(got);
+        return true;
+    }
+
+    std::ifstream m_file;
+    z_stream m_zstream{};
+    bool m_initialized = false;
+    bool m_finished = false;                ///< Reached the end of the gzip member
+    std::vector<uint8_t> m_input;           ///< Compressed input buffer
+    std::vector<uint8_t> m_scratch;         ///< Discard buffer for skip()
+};
+
+#ifdef BFF_HAVE_ZSTD
+
+/**
+ * @brief Streaming zstd reader with optional seek table support.
+ *
+ * Blender writes each ~1MB chunk of the file as an independent zstd
+ * frame and appends a seek table (the zstd "seekable format") listing
+ * the compressed and decompressed size of every frame. When the table
+ * is present, skip() seeks straight to the frame containing the target
+ * offset instead of decompressing everything in between.
+ */
+class ZstdStream : public CompressedStream {
+public:
+    bool open(const std::filesystem::path& path) {
+        m_file.open(path, std::ios::binary);
+        if (!m_file) return false;
+
+        m_dctx = ZSTD_createDCtx();
+        if (!m_dctx) return false;
+
+        m_input.resize(ZSTD_DStreamInSize());
+        m_scratch.resize(64 * 1024);
+
+        readSeekTable();
+        m_file.clear();
+        m_file.seekg(0);
+        return true;
+    }
+
+    ~ZstdStream() override {
+        if (m_dctx) {
+            ZSTD_freeDCtx(m_dctx);
+        }
+    }
+
+    bool read(void* dst, size_t size) override {
+        ZSTD_outBuffer out{dst, size, 0};
+
+        while (out.pos < out.size) {
+            if (m_inBuf.pos == m_inBuf.size && !refill()) {
+                return false;
+            }
+
+            size_t ret = ZSTD_decompressStream(m_dctx, &out, &m_inBuf);
+            if (ZSTD_isError(ret)) {
+                DEBUG_LOG("ZstdStream: " << ZSTD_getErrorName(ret));
+                return false;
+            }
+        }
+
+        m_position += size;
+        return true;
+    }
+
+    bool skip(uint64_t size) override {
+        uint64_t target = m_position + size;
+
+        // Jump over whole frames when the target is past the current one
+        if (!m_frames.empty()) {
+            size_t current = frameIndexFor(m_position);
+            size_t wanted = frameIndexFor(target);
+            if (wanted < m_frames.size() && wanted > current) {
+                const Frame& frame = m_frames[wanted];
+                m_file.clear();
+                m_file.seekg(static_cast<std::streamoff>(frame.compressedOffset));
+                ZSTD_DCtx_reset(m_dctx, ZSTD_reset_session_only);
+                m_inBuf = ZSTD_inBuffer{m_input.data(), 0, 0};
+                m_position = frame.decompressedOffset;
+            }
+        }
+
+        // Decompress and discard the remainder within the frame
+        while (m_position < target) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(target - m_position, m_scratch.size()));
+            if (!read(m_scratch.data(), chunk)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Format format() const override { return Format::Zstd; }
+
+private:
+    /**
+     * @brief Location of one frame in the compressed and decompressed data.
+     */
+    struct Frame {
+        uint64_t compressedOffset = 0;
+        uint64_t decompressedOffset = 0;
+        uint64_t decompressedSize = 0;
+    };
+
+    bool refill() {
+        m_file.read(reinterpret_cast<char*>(m_input.data()), static_cast<std::streamsize>(m_input.size()));
+        size_t got = static_cast<size_t>(m_file.gcount());
+        if (got == 0) return false;
+
+        m_compressedBytesRead += got;
+        m_inBuf = ZSTD_inBuffer{m_input.data(), got, 0};
+        return true;
+    }
+
+    size_t frameIndexFor(uint64_t offset) const {
+        auto it = std::upper_bound(m_frames.begin(), m_frames.end(), offset,
+            [](uint64_t value, const Frame& frame) { return value < frame.decompressedOffset; });
+        return static_cast<size_t>(it - m_frames.begin()) - 1;
+    }
+
+    void readSeekTable() {
+        m_file.seekg(0, std::ios::end);
+        auto fileSize = static_cast<uint64_t>(m_file.tellg());
+        if (fileSize < ZSTD_SEEKABLE_FOOTER_SIZE + 8) return;
+
+        uint8_t footer[ZSTD_SEEKABLE_FOOTER_SIZE];
+        m_file.seekg(static_cast<std::streamoff>(fileSize - ZSTD_SEEKABLE_FOOTER_SIZE));
+        m_file.read(reinterpret_cast<char*>(footer), sizeof(footer));
+        if (!m_file || readLE32(footer + 5) != ZSTD_SEEKABLE_MAGIC) return;
+
+        uint32_t numFrames = readLE32(footer);
+        bool hasChecksums = (footer[4] & 0x80) != 0;
+        size_t entrySize = hasChecksums ? 12 : 8;
+        uint64_t tableSize = static_cast<uint64_t>(numFrames) * entrySize + ZSTD_SEEKABLE_FOOTER_SIZE;
+        if (numFrames == 0 || tableSize + 8 > fileSize) return;
+
+        // Skippable frame header: magic + payload size, payload is the table
+        uint8_t frameHeader[8];
+        m_file.seekg(static_cast<std::streamoff>(fileSize - tableSize - 8));
+        m_file.read(reinterpret_cast<char*>(frameHeader), sizeof(frameHeader));
+        if (!m_file || readLE32(frameHeader) != ZSTD_SKIPPABLE_MAGIC ||
+            readLE32(frameHeader + 4) != tableSize) {
+            return;
+        }
+
+        std::vector<uint8_t> entries(static_cast<size_t>(numFrames) * entrySize);
+        m_file.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+        if (!m_file) return;
+        m_compressedBytesRead += sizeof(footer) + sizeof(frameHeader) + entries.size();
+
+        m_frames.reserve(numFrames);
+        uint64_t compressedOffset = 0;
+        uint64_t decompressedOffset = 0;
+        for (uint32_t i = 0; i < numFrames; ++i) {
+            const uint8_t* entry = entries.data() + i * entrySize;
+            Frame frame;
+            frame.compressedOffset = compressedOffset;
+            frame.decompressedOffset = decompressedOffset;
+            frame.decompressedSize = readLE32(entry + 4);
+            compressedOffset += readLE32(entry);
+            decompressedOffset += frame.decompressedSize;
+            m_frames.push_back(frame);
+        }
+    }
+
+    std::ifstream m_file;
+    ZSTD_DCtx* m_dctx = nullptr;
+    std::vector<uint8_t> m_input;                       ///< Compressed input buffer
+    ZSTD_inBuffer m_inBuf{nullptr, 0, 0};               ///< Unconsumed part of m_input
+    std::vector<uint8_t> m_scratch;                     ///< Discard buffer for skip()
+    std::vector<Frame> m_frames;                        ///< Seek table (empty if absent)
+};
+
+#endif // BFF_HAVE_ZSTD
+
+} // anonymous namespace
+
+CompressedStream::Format CompressedStream::detect(const uint8_t* data, size_t size) {
+    if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        return Format::Gzip;
+    }
+    if (size >= 4) {
+        uint32_t magic = readLE32(data);
+        // Blender's seek table lives in a trailing skippable frame, but the
+        // file itself always starts with a regular frame
+        if (magic == ZSTD_FRAME_MAGIC) {
+            return Format::Zstd;
+        }
+    }
+    return Format::None;
+}
+
+bool CompressedStream::hasZstdSupport() {
+#ifdef BFF_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<CompressedStream> CompressedStream::open(const std::filesystem::path& path) {
+    uint8_t magic[4] = {0, 0, 0, 0};
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return nullptr;
+        file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+        if (file.gcount() < 2) return nullptr;
+    }
+
+    switch (detect(magic, sizeof(magic))) {
+        case Format::Zstd: {
+#ifdef BFF_HAVE_ZSTD
+            auto stream = std::make_unique<ZstdStream>();
+            if (stream->open(path)) {
+                return stream;
+            }
+#endif
+            return nullptr;
+        }
+        case Format::Gzip: {
+            auto stream = std::make_unique<GzipStream>();
+            if (stream->open(path)) {
+                return stream;
+            }
+            return nullptr;
+        }
+        case Format::None:
+            break;
+    }
+    return nullptr;
+}
+
+} // namespace BlenderFileFinder
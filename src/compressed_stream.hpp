@@ -0,0 +1,111 @@
+/**
+ * @file compressed_stream.hpp
+ * @brief Forward-only decompressing readers for compressed .blend files.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Sequential reader over the decompressed contents of a file.
+ *
+ * Compressed .blend files are decompressed on demand, a small buffer at
+ * a time, so reading the first few blocks of a multi-GB file only
+ * touches the start of it. Callers read block headers and payloads with
+ * read() and step over uninteresting payloads with skip().
+ *
+ * Supported formats:
+ * - gzip (Blender 2.x "Compress" option), inflated through a fixed-size
+ *   window so memory use does not grow with the file
+ * - Zstandard (Blender 3.0+ "Compress" option), including the seek table
+ *   Blender appends, which lets skip() jump over whole frames without
+ *   decompressing them
+ *
+ * @par Usage Example:
+ * @code
+ * auto stream = CompressedStream::open(path);
+ * if (stream) {
+ *     uint8_t header[12];
+ *     stream->read(header, sizeof(header));
+ * }
+ * @endcode
+ */
+class CompressedStream {
+public:
+    /**
+     * @brief Compression format detected from a file's leading bytes.
+     */
+    enum class Format {
+        None,   ///< Not a recognized compressed format
+        Gzip,   ///< gzip (Blender 2.x and earlier "Compress")
+        Zstd    ///< Zstandard frames (Blender 3.0+)
+    };
+
+    virtual ~CompressedStream() = default;
+
+    /**
+     * @brief Detect the compression format from the first bytes of a file.
+     * @param data First bytes of the file
+     * @param size Number of bytes available (4 are needed for zstd)
+     * @return Detected format
+     */
+    static Format detect(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Open a compressed file for sequential reading.
+     * @param path Path to the file
+     * @return Stream, or nullptr if the file is not in a supported format
+     */
+    static std::unique_ptr<CompressedStream> open(const std::filesystem::path& path);
+
+    /**
+     * @brief Check if zstd support was compiled in.
+     * @return true if zstd-compressed files can be read
+     */
+    static bool hasZstdSupport();
+
+    /**
+     * @brief Read exactly @p size decompressed bytes.
+     * @param dst Destination buffer
+     * @param size Number of bytes to read
+     * @return true on success, false on end of data or decode error
+     */
+    virtual bool read(void* dst, size_t size) = 0;
+
+    /**
+     * @brief Skip over @p size decompressed bytes.
+     * @param size Number of bytes to skip
+     * @return true on success, false on end of data or decode error
+     */
+    virtual bool skip(uint64_t size) = 0;
+
+    /**
+     * @brief Get the current offset in the decompressed data.
+     * @return Offset in bytes
+     */
+    uint64_t position() const { return m_position; }
+
+    /**
+     * @brief Get the number of compressed bytes read from disk so far.
+     * @return Byte count
+     */
+    uint64_t compressedBytesRead() const { return m_compressedBytesRead; }
+
+    /**
+     * @brief Get the format of this stream.
+     * @return Compression format
+     */
+    virtual Format format() const = 0;
+
+protected:
+    uint64_t m_position = 0;            ///< Decompressed offset
+    uint64_t m_compressedBytesRead = 0; ///< Bytes read from the file
+};
+
+} // namespace BlenderFileFinder
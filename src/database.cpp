@@ -1,5 +1,6 @@
 #include "database.hpp"
 #include "debug.hpp"
+#include "path_filter.hpp"
 #include <chrono>
 #include <cstring>
 #include <stdexcept>
@@ -40,8 +41,14 @@ bool Database::open(const std::filesystem::path& dbPath) {
     // Enable foreign keys
     execute("PRAGMA foreign_keys = ON;");
 
+    // Scans write through their own connection while the UI reads; WAL
+    // lets both proceed, and the timeout covers the short write locks
+    execute("PRAGMA journal_mode = WAL;");
+    sqlite3_busy_timeout(m_db, 5000);
+
     // Create tables if they don't exist
     createTables();
+    migrateTables();
 
     DEBUG_LOG("Database opened: " << dbPath);
     return true;
@@ -64,6 +71,9 @@ void Database::createTables() {
             recursive INTEGER DEFAULT 1,
             enabled INTEGER DEFAULT 1,
             name TEXT,
+            include_patterns TEXT DEFAULT '',
+            exclude_patterns TEXT DEFAULT '',
+            index_datablocks INTEGER DEFAULT 0,
             created_at DATETIME DEFAULT CURRENT_TIMESTAMP
         );
     )");
@@ -81,6 +91,7 @@ void Database::createTables() {
             object_count INTEGER DEFAULT 0,
             mesh_count INTEGER DEFAULT 0,
             material_count INTEGER DEFAULT 0,
+            no_thumbnail INTEGER DEFAULT 0,
             scan_location_id INTEGER,
             created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
             updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
@@ -109,10 +120,94 @@ void Database::createTables() {
         );
     )");
 
+    // Datablock names per file (objects, materials, collections, ...)
+    execute(R"(
+        CREATE TABLE IF NOT EXISTS datablocks (
+            file_id INTEGER NOT NULL,
+            type TEXT NOT NULL,
+            name TEXT NOT NULL COLLATE NOCASE,
+            FOREIGN KEY (file_id) REFERENCES files(id) ON DELETE CASCADE
+        );
+    )");
+
+    // Image and library paths referenced by each file
+    execute(R"(
+        CREATE TABLE IF NOT EXISTS file_references (
+            file_id INTEGER NOT NULL,
+            type TEXT NOT NULL,
+            path TEXT NOT NULL,
+            resolved_path TEXT NOT NULL,
+            packed INTEGER DEFAULT 0,
+            FOREIGN KEY (file_id) REFERENCES files(id) ON DELETE CASCADE
+        );
+    )");
+
+    // Directory mtimes from each location's last complete scan
+    execute(R"(
+        CREATE TABLE IF NOT EXISTS scan_directories (
+            scan_location_id INTEGER NOT NULL,
+            path TEXT NOT NULL,
+            modified_time INTEGER,
+            entry_count INTEGER,
+            PRIMARY KEY (scan_location_id, path),
+            FOREIGN KEY (scan_location_id) REFERENCES scan_locations(id) ON DELETE CASCADE
+        );
+    )");
+
+    // Directories found or finished by a scan that hasn't completed yet
+    execute(R"(
+        CREATE TABLE IF NOT EXISTS scan_journal (
+            scan_location_id INTEGER NOT NULL,
+            path TEXT NOT NULL,
+            modified_time INTEGER,
+            entry_count INTEGER,
+            PRIMARY KEY (scan_location_id, path),
+            FOREIGN KEY (scan_location_id) REFERENCES scan_locations(id) ON DELETE CASCADE
+        );
+    )");
+
     // Create indexes for performance
     execute("CREATE INDEX IF NOT EXISTS idx_files_path ON files(path);");
     execute("CREATE INDEX IF NOT EXISTS idx_files_scan_location ON files(scan_location_id);");
     execute("CREATE INDEX IF NOT EXISTS idx_tags_name ON tags(name);");
+    execute("CREATE INDEX IF NOT EXISTS idx_datablocks_name ON datablocks(name);");
+    execute("CREATE INDEX IF NOT EXISTS idx_datablocks_file ON datablocks(file_id);");
+    execute("CREATE INDEX IF NOT EXISTS idx_references_resolved ON file_references(resolved_path);");
+    execute("CREATE INDEX IF NOT EXISTS idx_references_file ON file_references(file_id);");
+}
+
+void Database::migrateTables() {
+    // Columns added after the tables were first released
+    if (!hasColumn("files", "no_thumbnail")) {
+        execute("ALTER TABLE files ADD COLUMN no_thumbnail INTEGER DEFAULT 0;");
+    }
+    if (!hasColumn("scan_locations", "include_patterns")) {
+        execute("ALTER TABLE scan_locations ADD COLUMN include_patterns TEXT DEFAULT '';");
+    }
+    if (!hasColumn("scan_locations", "exclude_patterns")) {
+        execute("ALTER TABLE scan_locations ADD COLUMN exclude_patterns TEXT DEFAULT '';");
+    }
+    if (!hasColumn("scan_locations", "index_datablocks")) {
+        execute("ALTER TABLE scan_locations ADD COLUMN index_datablocks INTEGER DEFAULT 0;");
+    }
+}
+
+bool Database::hasColumn(const std::string& table, const std::string& column) {
+    sqlite3_stmt* stmt;
+    std::string sql = "PRAGMA table_info(" + table + ");";
+    bool found = false;
+
+    if (sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (safeColumnText(stmt, 1) == column) {
+                found = true;
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return found;
 }
 
 bool Database::execute(const std::string& sql) {
@@ -176,7 +271,8 @@ void Database::removeScanLocation(int64_t id) {
 
 void Database::updateScanLocation(const ScanLocation& location) {
     sqlite3_stmt* stmt;
-    const char* sql = "UPDATE scan_locations SET path = ?, recursive = ?, enabled = ?, name = ? WHERE id = ?;";
+    const char* sql = "UPDATE scan_locations SET path = ?, recursive = ?, enabled = ?, name = ?, "
+                      "include_patterns = ?, exclude_patterns = ?, index_datablocks = ? WHERE id = ?;";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         std::string pathStr = location.path.string();
@@ -184,17 +280,26 @@ void Database::updateScanLocation(const ScanLocation& location) {
         sqlite3_bind_int(stmt, 2, location.recursive ? 1 : 0);
         sqlite3_bind_int(stmt, 3, location.enabled ? 1 : 0);
         sqlite3_bind_text(stmt, 4, location.name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int64(stmt, 5, location.id);
+        std::string includeStr = PathFilter::joinPatterns(location.includePatterns);
+        std::string excludeStr = PathFilter::joinPatterns(location.excludePatterns);
+        sqlite3_bind_text(stmt, 5, includeStr.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, excludeStr.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 7, location.indexDatablocks ? 1 : 0);
+        sqlite3_bind_int64(stmt, 8, location.id);
         sqlite3_step(stmt);
         sqlite3_finalize(stmt);
     }
+
+    // The path, recursion or rules may have changed; walk everything next time
+    replaceScanDirectories(location.id, {});
 }
 
 std::vector<ScanLocation> Database::getAllScanLocations() {
     auto startTime = std::chrono::steady_clock::now();
     std::vector<ScanLocation> result;
     sqlite3_stmt* stmt;
-    const char* sql = "SELECT id, path, recursive, enabled, name FROM scan_locations ORDER BY name, path;";
+    const char* sql = "SELECT id, path, recursive, enabled, name, include_patterns, exclude_patterns, index_datablocks "
+                      "FROM scan_locations ORDER BY name, path;";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -204,6 +309,9 @@ std::vector<ScanLocation> Database::getAllScanLocations() {
             loc.recursive = sqlite3_column_int(stmt, 2) != 0;
             loc.enabled = sqlite3_column_int(stmt, 3) != 0;
             loc.name = safeColumnText(stmt, 4);
+            loc.includePatterns = PathFilter::splitPatterns(safeColumnText(stmt, 5));
+            loc.excludePatterns = PathFilter::splitPatterns(safeColumnText(stmt, 6));
+            loc.indexDatablocks = sqlite3_column_int(stmt, 7) != 0;
             result.push_back(loc);
         }
         sqlite3_finalize(stmt);
@@ -219,7 +327,8 @@ std::vector<ScanLocation> Database::getAllScanLocations() {
 
 std::optional<ScanLocation> Database::getScanLocation(int64_t id) {
     sqlite3_stmt* stmt;
-    const char* sql = "SELECT id, path, recursive, enabled, name FROM scan_locations WHERE id = ?;";
+    const char* sql = "SELECT id, path, recursive, enabled, name, include_patterns, exclude_patterns, index_datablocks "
+                      "FROM scan_locations WHERE id = ?;";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int64(stmt, 1, id);
@@ -230,6 +339,9 @@ std::optional<ScanLocation> Database::getScanLocation(int64_t id) {
             loc.recursive = sqlite3_column_int(stmt, 2) != 0;
             loc.enabled = sqlite3_column_int(stmt, 3) != 0;
             loc.name = safeColumnText(stmt, 4);
+            loc.includePatterns = PathFilter::splitPatterns(safeColumnText(stmt, 5));
+            loc.excludePatterns = PathFilter::splitPatterns(safeColumnText(stmt, 6));
+            loc.indexDatablocks = sqlite3_column_int(stmt, 7) != 0;
             sqlite3_finalize(stmt);
             return loc;
         }
@@ -239,14 +351,137 @@ std::optional<ScanLocation> Database::getScanLocation(int64_t id) {
     return std::nullopt;
 }
 
+std::vector<DirectoryRecord> Database::getScanDirectories(int64_t scanLocationId) {
+    std::vector<DirectoryRecord> result;
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT path, modified_time, entry_count FROM scan_directories WHERE scan_location_id = ?;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, scanLocationId);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            DirectoryRecord record;
+            record.path = safeColumnText(stmt, 0);
+            record.modifiedTime = sqlite3_column_int64(stmt, 1);
+            record.entryCount = sqlite3_column_int64(stmt, 2);
+            result.push_back(std::move(record));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+void Database::replaceScanDirectories(int64_t scanLocationId, const std::vector<DirectoryRecord>& directories) {
+    sqlite3_stmt* deleteStmt;
+    if (sqlite3_prepare_v2(m_db, "DELETE FROM scan_directories WHERE scan_location_id = ?;", -1,
+                           &deleteStmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+
+    beginTransaction();
+    sqlite3_bind_int64(deleteStmt, 1, scanLocationId);
+    sqlite3_step(deleteStmt);
+    sqlite3_finalize(deleteStmt);
+
+    if (sqlite3_prepare_v2(m_db, "DELETE FROM scan_journal WHERE scan_location_id = ?;", -1,
+                           &deleteStmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(deleteStmt, 1, scanLocationId);
+        sqlite3_step(deleteStmt);
+        sqlite3_finalize(deleteStmt);
+    }
+
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO scan_directories (scan_location_id, path, modified_time, entry_count) VALUES (?, ?, ?, ?);";
+    if (!directories.empty() && sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& record : directories) {
+            std::string pathStr = record.path.string();
+            sqlite3_bind_int64(stmt, 1, scanLocationId);
+            sqlite3_bind_text(stmt, 2, pathStr.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 3, record.modifiedTime);
+            sqlite3_bind_int64(stmt, 4, record.entryCount);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    commitTransaction();
+}
+
+std::vector<DirectoryRecord> Database::getScanJournal(int64_t scanLocationId) {
+    std::vector<DirectoryRecord> result;
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT path, modified_time, entry_count FROM scan_journal WHERE scan_location_id = ?;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, scanLocationId);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            DirectoryRecord record;
+            record.path = safeColumnText(stmt, 0);
+            record.modifiedTime = sqlite3_column_int64(stmt, 1);
+            record.entryCount = sqlite3_column_int64(stmt, 2);
+            result.push_back(std::move(record));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+void Database::appendScanJournal(int64_t scanLocationId, const std::vector<DirectoryRecord>& directories) {
+    if (directories.empty()) return;
+
+    sqlite3_stmt* stmt;
+    const char* sql = R"(
+        INSERT INTO scan_journal (scan_location_id, path, modified_time, entry_count) VALUES (?, ?, ?, ?)
+        ON CONFLICT(scan_location_id, path) DO UPDATE SET
+            modified_time = excluded.modified_time,
+            entry_count = excluded.entry_count
+        WHERE excluded.modified_time != 0;
+    )";
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+
+    beginTransaction();
+    for (const auto& record : directories) {
+        std::string pathStr = record.path.string();
+        sqlite3_bind_int64(stmt, 1, scanLocationId);
+        sqlite3_bind_text(stmt, 2, pathStr.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 3, record.modifiedTime);
+        sqlite3_bind_int64(stmt, 4, record.entryCount);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    commitTransaction();
+}
+
 // === Files ===
 
 int64_t Database::addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocationId) {
     sqlite3_stmt* stmt;
+    std::string pathStr = file.path.string();
+    int64_t modifiedTime = file.modifiedTime.time_since_epoch().count();
+
+    if (!file.metadata.hasDatablocks) {
+        // Names and references recorded for an older version of the file no longer apply
+        for (const char* staleSql : {
+                 "DELETE FROM datablocks WHERE file_id = (SELECT id FROM files WHERE path = ? AND modified_time != ?);",
+                 "DELETE FROM file_references WHERE file_id = (SELECT id FROM files WHERE path = ? AND modified_time != ?);"}) {
+            if (sqlite3_prepare_v2(m_db, staleSql, -1, &stmt, nullptr) == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, pathStr.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int64(stmt, 2, modifiedTime);
+                sqlite3_step(stmt);
+                sqlite3_finalize(stmt);
+            }
+        }
+    }
+
     const char* sql = R"(
         INSERT INTO files (path, filename, file_size, modified_time, blender_version,
-                          is_compressed, object_count, mesh_count, material_count, scan_location_id)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+                          is_compressed, object_count, mesh_count, material_count, scan_location_id,
+                          no_thumbnail)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
         ON CONFLICT(path) DO UPDATE SET
             filename = excluded.filename,
             file_size = excluded.file_size,
@@ -256,6 +491,7 @@ int64_t Database::addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocatio
             object_count = excluded.object_count,
             mesh_count = excluded.mesh_count,
             material_count = excluded.material_count,
+            no_thumbnail = excluded.no_thumbnail,
             scan_location_id = excluded.scan_location_id,
             updated_at = CURRENT_TIMESTAMP;
     )";
@@ -264,11 +500,10 @@ int64_t Database::addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocatio
         return -1;
     }
 
-    std::string pathStr = file.path.string();
     sqlite3_bind_text(stmt, 1, pathStr.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 2, file.filename.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int64(stmt, 3, static_cast<int64_t>(file.fileSize));
-    sqlite3_bind_int64(stmt, 4, file.modifiedTime.time_since_epoch().count());
+    sqlite3_bind_int64(stmt, 4, modifiedTime);
     sqlite3_bind_text(stmt, 5, file.metadata.blenderVersion.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 6, file.metadata.isCompressed ? 1 : 0);
     sqlite3_bind_int(stmt, 7, file.metadata.objectCount);
@@ -279,6 +514,7 @@ int64_t Database::addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocatio
     } else {
         sqlite3_bind_null(stmt, 10);
     }
+    sqlite3_bind_int(stmt, 11, file.noEmbeddedThumbnail ? 1 : 0);
 
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -287,9 +523,93 @@ int64_t Database::addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocatio
         return -1;
     }
 
+    if (file.metadata.hasDatablocks) {
+        // last_insert_rowid() isn't set when the upsert took the UPDATE path
+        int64_t fileId = getFileId(file.path);
+        if (fileId > 0) {
+            replaceDatablocks(fileId, file.metadata.datablocks);
+            replaceReferences(fileId, file.path, file.metadata.references);
+        }
+        return fileId;
+    }
+
     return sqlite3_last_insert_rowid(m_db);
 }
 
+void Database::addOrUpdateFiles(const std::vector<BlendFileInfo>& files, int64_t scanLocationId) {
+    beginTransaction();
+    for (const auto& file : files) {
+        addOrUpdateFile(file, scanLocationId);
+    }
+    commitTransaction();
+}
+
+void Database::replaceDatablocks(int64_t fileId, const std::vector<BlendDatablock>& datablocks) {
+    sqlite3_stmt* deleteStmt;
+    sqlite3_stmt* insertStmt;
+    if (sqlite3_prepare_v2(m_db, "DELETE FROM datablocks WHERE file_id = ?;", -1, &deleteStmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+    if (sqlite3_prepare_v2(m_db, "INSERT INTO datablocks (file_id, type, name) VALUES (?, ?, ?);",
+                           -1, &insertStmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(deleteStmt);
+        return;
+    }
+
+    // Batch inserts already run in a transaction
+    bool ownTransaction = sqlite3_get_autocommit(m_db) != 0;
+    if (ownTransaction) beginTransaction();
+    sqlite3_bind_int64(deleteStmt, 1, fileId);
+    sqlite3_step(deleteStmt);
+
+    for (const auto& datablock : datablocks) {
+        sqlite3_bind_int64(insertStmt, 1, fileId);
+        sqlite3_bind_text(insertStmt, 2, datablock.type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt, 3, datablock.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(insertStmt);
+        sqlite3_reset(insertStmt);
+    }
+    if (ownTransaction) commitTransaction();
+
+    sqlite3_finalize(deleteStmt);
+    sqlite3_finalize(insertStmt);
+}
+
+void Database::replaceReferences(int64_t fileId, const std::filesystem::path& filePath,
+                                 const std::vector<BlendReference>& references) {
+    sqlite3_stmt* deleteStmt;
+    sqlite3_stmt* insertStmt;
+    if (sqlite3_prepare_v2(m_db, "DELETE FROM file_references WHERE file_id = ?;", -1, &deleteStmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+    const char* insertSql =
+        "INSERT INTO file_references (file_id, type, path, resolved_path, packed) VALUES (?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(m_db, insertSql, -1, &insertStmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(deleteStmt);
+        return;
+    }
+
+    bool ownTransaction = sqlite3_get_autocommit(m_db) != 0;
+    if (ownTransaction) beginTransaction();
+    sqlite3_bind_int64(deleteStmt, 1, fileId);
+    sqlite3_step(deleteStmt);
+
+    for (const auto& reference : references) {
+        std::string resolved = BlendParser::resolveStoredPath(filePath, reference.path).string();
+        sqlite3_bind_int64(insertStmt, 1, fileId);
+        sqlite3_bind_text(insertStmt, 2, reference.type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt, 3, reference.path.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt, 4, resolved.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(insertStmt, 5, reference.packed ? 1 : 0);
+        sqlite3_step(insertStmt);
+        sqlite3_reset(insertStmt);
+    }
+    if (ownTransaction) commitTransaction();
+
+    sqlite3_finalize(deleteStmt);
+    sqlite3_finalize(insertStmt);
+}
+
 void Database::removeFile(int64_t fileId) {
     sqlite3_stmt* stmt;
     const char* sql = "DELETE FROM files WHERE id = ?;";
@@ -334,7 +654,7 @@ std::optional<BlendFileInfo> Database::getFileByPath(const std::filesystem::path
     sqlite3_stmt* stmt;
     const char* sql = R"(
         SELECT path, filename, file_size, modified_time, blender_version,
-               is_compressed, object_count, mesh_count, material_count
+               is_compressed, object_count, mesh_count, material_count, no_thumbnail
         FROM files WHERE path = ?;
     )";
 
@@ -354,6 +674,7 @@ std::optional<BlendFileInfo> Database::getFileByPath(const std::filesystem::path
             file.metadata.objectCount = sqlite3_column_int(stmt, 6);
             file.metadata.meshCount = sqlite3_column_int(stmt, 7);
             file.metadata.materialCount = sqlite3_column_int(stmt, 8);
+            file.noEmbeddedThumbnail = sqlite3_column_int(stmt, 9) != 0;
 
             sqlite3_finalize(stmt);
             return file;
@@ -372,7 +693,7 @@ std::vector<BlendFileInfo> Database::getAllFiles() {
     sqlite3_stmt* stmt;
     const char* sql = R"(
         SELECT path, filename, file_size, modified_time, blender_version,
-               is_compressed, object_count, mesh_count, material_count
+               is_compressed, object_count, mesh_count, material_count, no_thumbnail
         FROM files ORDER BY filename;
     )";
 
@@ -394,6 +715,7 @@ std::vector<BlendFileInfo> Database::getAllFiles() {
             file.metadata.objectCount = sqlite3_column_int(stmt, 6);
             file.metadata.meshCount = sqlite3_column_int(stmt, 7);
             file.metadata.materialCount = sqlite3_column_int(stmt, 8);
+            file.noEmbeddedThumbnail = sqlite3_column_int(stmt, 9) != 0;
             result.push_back(file);
         }
         auto fetchMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - fetchStart).count();
@@ -414,7 +736,7 @@ std::vector<BlendFileInfo> Database::getFilesByScanLocation(int64_t scanLocation
     sqlite3_stmt* stmt;
     const char* sql = R"(
         SELECT path, filename, file_size, modified_time, blender_version,
-               is_compressed, object_count, mesh_count, material_count
+               is_compressed, object_count, mesh_count, material_count, no_thumbnail
         FROM files WHERE scan_location_id = ? ORDER BY filename;
     )";
 
@@ -432,6 +754,7 @@ std::vector<BlendFileInfo> Database::getFilesByScanLocation(int64_t scanLocation
             file.metadata.objectCount = sqlite3_column_int(stmt, 6);
             file.metadata.meshCount = sqlite3_column_int(stmt, 7);
             file.metadata.materialCount = sqlite3_column_int(stmt, 8);
+            file.noEmbeddedThumbnail = sqlite3_column_int(stmt, 9) != 0;
             result.push_back(file);
         }
         sqlite3_finalize(stmt);
@@ -445,7 +768,7 @@ std::vector<BlendFileInfo> Database::searchFiles(const std::string& query) {
     sqlite3_stmt* stmt;
     const char* sql = R"(
         SELECT path, filename, file_size, modified_time, blender_version,
-               is_compressed, object_count, mesh_count, material_count
+               is_compressed, object_count, mesh_count, material_count, no_thumbnail
         FROM files WHERE filename LIKE ? ORDER BY filename;
     )";
 
@@ -465,6 +788,7 @@ std::vector<BlendFileInfo> Database::searchFiles(const std::string& query) {
             file.metadata.objectCount = sqlite3_column_int(stmt, 6);
             file.metadata.meshCount = sqlite3_column_int(stmt, 7);
             file.metadata.materialCount = sqlite3_column_int(stmt, 8);
+            file.noEmbeddedThumbnail = sqlite3_column_int(stmt, 9) != 0;
             result.push_back(file);
         }
         sqlite3_finalize(stmt);
@@ -501,6 +825,70 @@ bool Database::isFileUpToDate(const std::filesystem::path& path) {
     return false;
 }
 
+std::unordered_map<std::string, FileStat> Database::getFileStats(const std::filesystem::path& directory) {
+    std::unordered_map<std::string, FileStat> result;
+    sqlite3_stmt* stmt;
+    // Everything from "dir/" up to "dir0" ('0' follows '/'), a range on the path index
+    const char* sql = "SELECT path, file_size, modified_time FROM files WHERE path >= ? AND path < ?;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        std::string prefix = directory.string();
+        while (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+        std::string begin = prefix + '/';
+        std::string end = prefix + '0';
+        sqlite3_bind_text(stmt, 1, begin.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, end.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            FileStat stat;
+            stat.size = static_cast<uintmax_t>(sqlite3_column_int64(stmt, 1));
+            auto duration = std::filesystem::file_time_type::duration(sqlite3_column_int64(stmt, 2));
+            stat.modifiedTime = std::filesystem::file_time_type(duration);
+            result.emplace(safeColumnText(stmt, 0), stat);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+std::unordered_map<std::string, int64_t> Database::getNoThumbnailFiles() {
+    std::unordered_map<std::string, int64_t> result;
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT path, modified_time FROM files WHERE no_thumbnail = 1;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            result.emplace(safeColumnText(stmt, 0), sqlite3_column_int64(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+void Database::markNoThumbnail(const std::vector<std::pair<std::filesystem::path, int64_t>>& files) {
+    if (files.empty()) return;
+
+    sqlite3_stmt* stmt;
+    // Only flag the version that was read; a newer save may have a thumbnail
+    const char* sql = "UPDATE files SET no_thumbnail = 1 WHERE path = ? AND modified_time = ?;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+
+    beginTransaction();
+    for (const auto& [path, modifiedTime] : files) {
+        std::string pathStr = path.string();
+        sqlite3_bind_text(stmt, 1, pathStr.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, modifiedTime);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    commitTransaction();
+    sqlite3_finalize(stmt);
+}
+
 int Database::cleanupMissingFiles() {
     std::vector<std::string> pathsToRemove;
     sqlite3_stmt* stmt;
@@ -518,11 +906,193 @@ int Database::cleanupMissingFiles() {
 
     for (const auto& path : pathsToRemove) {
         removeFileByPath(path);
+        BlockIndex::remove(path);
     }
 
     return static_cast<int>(pathsToRemove.size());
 }
 
+int Database::removeFilesInDirectory(const std::filesystem::path& directory) {
+    std::vector<std::string> pathsToRemove;
+    sqlite3_stmt* stmt;
+    // Paths under "dir/" sort between "dir/" and "dir0" ('0' follows '/')
+    const char* sql = "SELECT path FROM files WHERE path > ? AND path < ?;";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        std::string prefix = directory.string();
+        if (prefix.empty() || prefix.back() != '/') prefix += '/';
+        std::string end = prefix.substr(0, prefix.size() - 1) + '0';
+        sqlite3_bind_text(stmt, 1, prefix.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, end.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            pathsToRemove.push_back(safeColumnText(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    beginTransaction();
+    for (const auto& path : pathsToRemove) {
+        removeFileByPath(path);
+        BlockIndex::remove(path);
+    }
+    commitTransaction();
+
+    return static_cast<int>(pathsToRemove.size());
+}
+
+// === Datablocks ===
+
+std::vector<DatablockMatch> Database::searchDatablocks(const std::string& query, const std::string& type, int limit) {
+    std::vector<DatablockMatch> result;
+    if (query.empty()) return result;
+
+    sqlite3_stmt* stmt;
+    // A prefix LIKE on the NOCASE name column is answered from idx_datablocks_name
+    const char* sql = R"(
+        SELECT f.path, d.type, d.name
+        FROM datablocks d
+        JOIN files f ON f.id = d.file_id
+        WHERE d.name LIKE ? ESCAPE '\' AND (? = '' OR d.type = ?)
+        ORDER BY d.name, f.path
+        LIMIT ?;
+    )";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        // Names often contain '_', which LIKE would treat as a wildcard
+        std::string pattern;
+        pattern.reserve(query.size() + 1);
+        for (char c : query) {
+            if (c == '%' || c == '_' || c == '\\') pattern += '\\';
+            pattern += c;
+        }
+        pattern += '%';
+
+        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, limit);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            DatablockMatch match;
+            match.filePath = safeColumnText(stmt, 0);
+            match.type = safeColumnText(stmt, 1);
+            match.name = safeColumnText(stmt, 2);
+            result.push_back(std::move(match));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+std::vector<BlendDatablock> Database::getDatablocksForFile(const std::filesystem::path& filePath) {
+    std::vector<BlendDatablock> result;
+    sqlite3_stmt* stmt;
+    const char* sql = R"(
+        SELECT d.type, d.name FROM datablocks d
+        JOIN files f ON f.id = d.file_id
+        WHERE f.path = ?
+        ORDER BY d.rowid;
+    )";
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        std::string pathStr = filePath.string();
+        sqlite3_bind_text(stmt, 1, pathStr.c_str(), -1, SQLITE_TRANSIENT);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            BlendDatablock datablock;
+            datablock.type = safeColumnText(stmt, 0);
+            datablock.name = safeColumnText(stmt, 1);
+            result.push_back(std::move(datablock));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+// === External References ===
+
+std::vector<ReferenceMatch> Database::queryReferences(const char* sql, const std::vector<std::string>& params) {
+    std::vector<ReferenceMatch> result;
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        for (size_t i = 0; i < params.size(); ++i) {
+            sqlite3_bind_text(stmt, static_cast<int>(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+        }
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ReferenceMatch match;
+            match.filePath = safeColumnText(stmt, 0);
+            match.type = safeColumnText(stmt, 1);
+            match.path = safeColumnText(stmt, 2);
+            match.resolvedPath = safeColumnText(stmt, 3);
+            match.packed = sqlite3_column_int(stmt, 4) != 0;
+            result.push_back(std::move(match));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+std::vector<ReferenceMatch> Database::getReferencingFiles(const std::filesystem::path& target,
+                                                          const std::string& type) {
+    const char* sql = R"(
+        SELECT f.path, r.type, r.path, r.resolved_path, r.packed
+        FROM file_references r
+        JOIN files f ON f.id = r.file_id
+        WHERE r.resolved_path = ? AND (? = '' OR r.type = ?)
+        ORDER BY f.path;
+    )";
+
+    // Stored paths are absolute and normalized (see BlendParser::resolveStoredPath)
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(target, ec);
+    std::string targetStr = (ec ? target : absolute).lexically_normal().string();
+    return queryReferences(sql, {targetStr, type, type});
+}
+
+std::vector<ReferenceMatch> Database::getMissingReferences(const std::string& type) {
+    // Walk references in resolved path order, so each distinct path is
+    // stat'ed once however many files share it
+    const char* sql = R"(
+        SELECT f.path, r.type, r.path, r.resolved_path, r.packed
+        FROM file_references r
+        JOIN files f ON f.id = r.file_id
+        WHERE r.packed = 0 AND (? = '' OR r.type = ?)
+        ORDER BY r.resolved_path, f.path;
+    )";
+
+    std::vector<ReferenceMatch> result = queryReferences(sql, {type, type});
+
+    std::string checkedPath;
+    bool checkedExists = true;
+    std::erase_if(result, [&](const ReferenceMatch& match) {
+        if (match.resolvedPath.string() != checkedPath) {
+            checkedPath = match.resolvedPath.string();
+            std::error_code ec;
+            checkedExists = std::filesystem::exists(match.resolvedPath, ec) || ec;  // Unreadable isn't missing
+        }
+        return checkedExists;
+    });
+
+    return result;
+}
+
+std::vector<ReferenceMatch> Database::getReferencesForFile(const std::filesystem::path& filePath) {
+    const char* sql = R"(
+        SELECT f.path, r.type, r.path, r.resolved_path, r.packed
+        FROM file_references r
+        JOIN files f ON f.id = r.file_id
+        WHERE f.path = ?
+        ORDER BY r.rowid;
+    )";
+
+    return queryReferences(sql, {filePath.string()});
+}
+
 // === Tags ===
 
 int64_t Database::addTag(const std::string& tagName) {
@@ -681,7 +1251,7 @@ std::vector<BlendFileInfo> Database::getFilesWithTag(const std::string& tagName)
     sqlite3_stmt* stmt;
     const char* sql = R"(
         SELECT f.path, f.filename, f.file_size, f.modified_time, f.blender_version,
-               f.is_compressed, f.object_count, f.mesh_count, f.material_count
+               f.is_compressed, f.object_count, f.mesh_count, f.material_count, f.no_thumbnail
         FROM files f
         INNER JOIN file_tags ft ON f.id = ft.file_id
         INNER JOIN tags t ON t.id = ft.tag_id
@@ -704,6 +1274,7 @@ std::vector<BlendFileInfo> Database::getFilesWithTag(const std::string& tagName)
             file.metadata.objectCount = sqlite3_column_int(stmt, 6);
             file.metadata.meshCount = sqlite3_column_int(stmt, 7);
             file.metadata.materialCount = sqlite3_column_int(stmt, 8);
+            file.noEmbeddedThumbnail = sqlite3_column_int(stmt, 9) != 0;
             result.push_back(file);
         }
         sqlite3_finalize(stmt);
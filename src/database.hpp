@@ -6,10 +6,12 @@
 #pragma once
 
 #include "blend_parser.hpp"
+#include "directory_index.hpp"
 #include <filesystem>
 #include <string>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <optional>
 #include <sqlite3.h>
 
@@ -28,6 +30,29 @@ struct ScanLocation {
     bool recursive = true;               ///< Whether to scan subdirectories
     bool enabled = true;                 ///< Whether this location is active
     std::string name;                    ///< Optional display name for UI
+    std::vector<std::string> includePatterns; ///< Globs files must match (empty = all), see PathFilter
+    std::vector<std::string> excludePatterns; ///< Globs of files and directories to skip
+    bool indexDatablocks = false;        ///< Read datablock names and references while scanning (reads whole files)
+};
+
+/**
+ * @brief A datablock found by Database::searchDatablocks().
+ */
+struct DatablockMatch {
+    std::filesystem::path filePath;      ///< .blend file containing the datablock
+    std::string type;                    ///< Two-letter ID code (e.g., "OB", "MA")
+    std::string name;                    ///< Datablock name without the ID code prefix
+};
+
+/**
+ * @brief An image or library path referenced by a file, from Database queries.
+ */
+struct ReferenceMatch {
+    std::filesystem::path filePath;      ///< .blend file containing the reference
+    std::string type;                    ///< ID code of the referencing datablock: "IM" or "LI"
+    std::string path;                    ///< Path as stored in the file
+    std::filesystem::path resolvedPath;  ///< Absolute path the reference points to
+    bool packed = false;                 ///< True if the data is packed into the file
 };
 
 /**
@@ -36,6 +61,8 @@ struct ScanLocation {
  * Provides persistent storage for:
  * - Scan locations (directories to monitor)
  * - File information (path, size, metadata, thumbnail status)
+ * - Names of the datablocks (objects, materials, collections, ...) in each file
+ * - Image and linked library paths each file references
  * - User-defined tags and file-tag associations
  *
  * The database is stored at ~/.local/share/BlenderFileFinder/database.db
@@ -103,6 +130,42 @@ public:
      */
     std::optional<ScanLocation> getScanLocation(int64_t id);
 
+    /**
+     * @brief Get the directories recorded by a location's last complete scan.
+     * @param scanLocationId Location ID
+     * @return Directory records (empty if the location was never fully walked)
+     */
+    std::vector<DirectoryRecord> getScanDirectories(int64_t scanLocationId);
+
+    /**
+     * @brief Replace a location's directory records in one transaction.
+     *
+     * Also drops the location's scan journal, which a complete walk
+     * supersedes.
+     *
+     * @param scanLocationId Location ID
+     * @param directories Records from Scanner::takeDirectoryRecords()
+     */
+    void replaceScanDirectories(int64_t scanLocationId, const std::vector<DirectoryRecord>& directories);
+
+    /**
+     * @brief Get the walk progress saved by an unfinished scan of a location.
+     * @param scanLocationId Location ID
+     * @return Journaled directories (empty if the last scan completed)
+     */
+    std::vector<DirectoryRecord> getScanJournal(int64_t scanLocationId);
+
+    /**
+     * @brief Add walk progress to a location's scan journal in one transaction.
+     *
+     * Found directories (modifiedTime 0) don't replace directories already
+     * journaled; finished ones replace whatever is there.
+     *
+     * @param scanLocationId Location ID
+     * @param directories Records from a Scanner checkpoint callback
+     */
+    void appendScanJournal(int64_t scanLocationId, const std::vector<DirectoryRecord>& directories);
+
     /// @}
 
     /// @name File Management
@@ -110,12 +173,29 @@ public:
 
     /**
      * @brief Add a new file or update an existing one.
+     *
+     * If file.metadata.hasDatablocks is set, the file's datablock names and
+     * references are replaced with file.metadata.datablocks and
+     * file.metadata.references. Otherwise they are kept, unless the file's
+     * modification time changed, in which case they are dropped.
+     *
      * @param file File information to store
      * @param scanLocationId Optional ID of the containing scan location
      * @return ID of the file record, or -1 on failure
      */
     int64_t addOrUpdateFile(const BlendFileInfo& file, int64_t scanLocationId = 0);
 
+    /**
+     * @brief Add or update several files in one transaction.
+     *
+     * Same as calling addOrUpdateFile() for each file, but with a single
+     * commit, which is what makes inserting a scan's results fast.
+     *
+     * @param files File information to store
+     * @param scanLocationId Optional ID of the containing scan location
+     */
+    void addOrUpdateFiles(const std::vector<BlendFileInfo>& files, int64_t scanLocationId = 0);
+
     /**
      * @brief Remove a file by its database ID.
      * @param fileId File ID to remove
@@ -162,12 +242,109 @@ public:
      */
     bool isFileUpToDate(const std::filesystem::path& path);
 
+    /**
+     * @brief Get the stored size and mtime of every file under a directory.
+     *
+     * One query for a whole location, so a scan can tell which files are
+     * unchanged without a lookup per file.
+     *
+     * @param directory Directory whose files (at any depth) to return
+     * @return Map of path to stored size and mtime
+     */
+    std::unordered_map<std::string, FileStat> getFileStats(const std::filesystem::path& directory);
+
+    /**
+     * @brief Get files recorded as having no embedded thumbnail.
+     * @return Map of path to the modification time the flag applies to
+     */
+    std::unordered_map<std::string, int64_t> getNoThumbnailFiles();
+
+    /**
+     * @brief Record that files have no embedded thumbnail.
+     *
+     * Each flag applies only while the stored modification time matches,
+     * so a later save of the file is searched again.
+     *
+     * @param files Pairs of (path, modification time the file was read at)
+     */
+    void markNoThumbnail(const std::vector<std::pair<std::filesystem::path, int64_t>>& files);
+
     /**
      * @brief Remove database entries for files that no longer exist on disk.
      * @return Number of files removed
      */
     int cleanupMissingFiles();
 
+    /**
+     * @brief Remove database entries for every file under a directory.
+     * @param directory Directory that was deleted or moved away
+     * @return Number of files removed
+     */
+    int removeFilesInDirectory(const std::filesystem::path& directory);
+
+    /// @}
+
+    /// @name Datablock Names
+    /// @{
+
+    /**
+     * @brief Find datablocks by name across all files.
+     *
+     * Matches names starting with @p query, ignoring ASCII case. The match
+     * uses the name index, so it stays fast with millions of datablocks.
+     *
+     * @param query Name or name prefix (e.g., "Rig_Hero")
+     * @param type Optional two-letter ID code to restrict to (e.g., "OB")
+     * @param limit Maximum number of matches to return
+     * @return Matches ordered by name, then file path
+     */
+    std::vector<DatablockMatch> searchDatablocks(const std::string& query, const std::string& type = "",
+                                                 int limit = 1000);
+
+    /**
+     * @brief Get the datablocks recorded for a file.
+     * @param filePath Path to the file
+     * @return Datablocks in file order
+     */
+    std::vector<BlendDatablock> getDatablocksForFile(const std::filesystem::path& filePath);
+
+    /// @}
+
+    /// @name External References
+    /// Image and linked library paths, stored resolved so they can be
+    /// looked up in reverse
+    /// @{
+
+    /**
+     * @brief Find the files that reference a path (e.g. link a library).
+     *
+     * Answered from the resolved path index.
+     *
+     * @param target Referenced file (e.g. /projects/lib/props_lib.blend)
+     * @param type Optional ID code to restrict to: "IM" or "LI"
+     * @return References to @p target, ordered by file path
+     */
+    std::vector<ReferenceMatch> getReferencingFiles(const std::filesystem::path& target,
+                                                    const std::string& type = "");
+
+    /**
+     * @brief Find references to files that don't exist.
+     *
+     * Packed references are skipped. Each distinct referenced path is
+     * checked on disk once, however many files reference it.
+     *
+     * @param type Optional ID code to restrict to: "IM" or "LI"
+     * @return Broken references, ordered by referenced path
+     */
+    std::vector<ReferenceMatch> getMissingReferences(const std::string& type = "");
+
+    /**
+     * @brief Get the references recorded for a file.
+     * @param filePath Path to the file
+     * @return References in file order
+     */
+    std::vector<ReferenceMatch> getReferencesForFile(const std::filesystem::path& filePath);
+
     /// @}
 
     /// @name Tag Management
@@ -296,11 +473,17 @@ public:
 
 private:
     void createTables();
+    void migrateTables();
+    bool hasColumn(const std::string& table, const std::string& column);
     void beginTransaction();
     void commitTransaction();
     void rollbackTransaction();
 
     int64_t getFileId(const std::filesystem::path& path);
+    void replaceDatablocks(int64_t fileId, const std::vector<BlendDatablock>& datablocks);
+    void replaceReferences(int64_t fileId, const std::filesystem::path& filePath,
+                           const std::vector<BlendReference>& references);
+    std::vector<ReferenceMatch> queryReferences(const char* sql, const std::vector<std::string>& params);
     bool execute(const std::string& sql);
 
     sqlite3* m_db = nullptr;            ///< SQLite database handle
@@ -0,0 +1,75 @@
+#include "directory_index.hpp"
+#include <chrono>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Changes this close to the listing may share the directory's timestamp
+constexpr auto RACY_WINDOW = std::chrono::seconds(2);
+
+} // anonymous namespace
+
+DirectoryIndex::DirectoryIndex(const std::vector<DirectoryRecord>& previous) {
+    for (const auto& record : previous) {
+        m_previous.emplace(record.path.string(), record);
+    }
+
+    // Only directories listed last time have their subdirectories on record
+    for (const auto& [path, record] : m_previous) {
+        std::filesystem::path parent = record.path.parent_path();
+        if (parent != record.path && m_previous.count(parent.string())) {
+            m_children[parent.string()].push_back(record.path);
+        }
+    }
+}
+
+const DirectoryRecord* DirectoryIndex::reuse(const std::filesystem::path& directory, int64_t modifiedTime,
+                                             std::vector<std::filesystem::path>& subdirectories) {
+    auto it = m_previous.find(directory.string());
+    if (it == m_previous.end() || it->second.modifiedTime == 0 || it->second.modifiedTime != modifiedTime) {
+        return nullptr;
+    }
+
+    auto children = m_children.find(it->first);
+    if (children != m_children.end()) {
+        subdirectories = children->second;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_current[it->first] = it->second;
+    ++m_reused;
+    return &it->second;
+}
+
+DirectoryRecord DirectoryIndex::record(const std::filesystem::path& directory, int64_t modifiedTime,
+                                       int64_t entryCount) {
+    auto now = std::filesystem::file_time_type::clock::now().time_since_epoch();
+    auto modified = std::filesystem::file_time_type::duration(modifiedTime);
+    if (now - modified < RACY_WINDOW) {
+        modifiedTime = 0;
+    }
+
+    DirectoryRecord result{directory, modifiedTime, entryCount};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_current[directory.string()] = result;
+    ++m_listed;
+    return result;
+}
+
+std::vector<DirectoryRecord> DirectoryIndex::records() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DirectoryRecord> result;
+    result.reserve(m_current.size());
+    for (const auto& [path, record] : m_current) {
+        result.push_back(record);
+    }
+    return result;
+}
+
+std::pair<size_t, size_t> DirectoryIndex::counts() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {m_reused, m_listed};
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,105 @@
+/**
+ * @file directory_index.hpp
+ * @brief Directory modification times remembered between scans.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief State of one directory when it was last listed.
+ */
+struct DirectoryRecord {
+    std::filesystem::path path;     ///< Directory path
+    int64_t modifiedTime = 0;       ///< Directory mtime (file_time_type ticks); 0 = list again
+    int64_t entryCount = 0;         ///< Entries (files and subdirectories) listed
+};
+
+/**
+ * @brief Lets a rescan skip listing directories that haven't changed.
+ *
+ * A directory's modification time changes whenever an entry is created,
+ * deleted or renamed in it. Blender saves by writing "file.blend@" and
+ * renaming it over the original, so saving a file also touches its
+ * directory. A directory whose mtime matches the previous scan therefore
+ * has the same entries as then: it isn't listed again, and the walk
+ * continues into the subdirectories recorded for it (each of which is
+ * checked the same way).
+ *
+ * Files rewritten in place (without a rename) don't touch the directory
+ * and are only picked up by a full rescan.
+ *
+ * Directories modified within a couple of seconds of being listed are
+ * recorded with modifiedTime 0: on filesystems with coarse timestamps a
+ * later change in the same tick would go unnoticed otherwise.
+ *
+ * All methods are thread-safe; DirectoryWalker workers call them
+ * concurrently.
+ */
+class DirectoryIndex {
+public:
+    /**
+     * @brief Create an index from the records of the previous scan.
+     *
+     * If a path has several records, the first one counts, so a resumed
+     * scan can put its journal in front of older records.
+     *
+     * @param previous Records saved after the last complete walk (empty for a full scan)
+     */
+    explicit DirectoryIndex(const std::vector<DirectoryRecord>& previous = {});
+
+    /**
+     * @brief Check whether a directory can be skipped.
+     *
+     * On success the directory's previous record is carried over into
+     * records().
+     *
+     * @param directory Directory about to be listed
+     * @param modifiedTime Its current mtime (file_time_type ticks)
+     * @param[out] subdirectories Subdirectories it had when last listed
+     * @return The previous record if unchanged since the previous scan,
+     *         otherwise nullptr (valid as long as the index)
+     */
+    const DirectoryRecord* reuse(const std::filesystem::path& directory, int64_t modifiedTime,
+                                 std::vector<std::filesystem::path>& subdirectories);
+
+    /**
+     * @brief Record a directory that was listed.
+     * @param directory Directory that was listed
+     * @param modifiedTime Its mtime, read before listing (file_time_type ticks)
+     * @param entryCount Number of entries listed
+     * @return The record as kept (modifiedTime 0 if it changed too recently)
+     */
+    DirectoryRecord record(const std::filesystem::path& directory, int64_t modifiedTime, int64_t entryCount);
+
+    /**
+     * @brief Get the state of every directory seen by the walk.
+     * @return Records to save for the next scan
+     */
+    std::vector<DirectoryRecord> records() const;
+
+    /**
+     * @brief Get how many directories were skipped and listed.
+     * @return Pair of (skipped, listed)
+     */
+    std::pair<size_t, size_t> counts() const;
+
+private:
+    std::unordered_map<std::string, DirectoryRecord> m_previous;    ///< Path -> last scan's record
+    std::unordered_map<std::string, std::vector<std::filesystem::path>> m_children; ///< Path -> subdirectories
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, DirectoryRecord> m_current;     ///< Path -> this walk's record
+    size_t m_reused = 0;
+    size_t m_listed = 0;
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,283 @@
+#include "directory_walker.hpp"
+#include "debug.hpp"
+#include "directory_index.hpp"
+#include "path_filter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Idle workers recheck for work and cancellation at least this often
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(20);
+
+// getdents64() buffer; a few hundred entries per call
+constexpr size_t DIRENT_BUFFER_SIZE = 32 * 1024;
+
+std::filesystem::file_type fileType(unsigned char dirType) {
+    using std::filesystem::file_type;
+    switch (dirType) {
+        case DT_REG: return file_type::regular;
+        case DT_DIR: return file_type::directory;
+        case DT_LNK: return file_type::symlink;
+        case DT_FIFO: return file_type::fifo;
+        case DT_SOCK: return file_type::socket;
+        case DT_BLK: return file_type::block;
+        case DT_CHR: return file_type::character;
+        default: return file_type::unknown;
+    }
+}
+
+/**
+ * @brief List one directory with getdents64().
+ *
+ * Entries whose type the filesystem doesn't report get one fstatat()
+ * (not following symlinks); all others need no stat at all.
+ *
+ * @param directory Directory to list
+ * @param cancel Stops the listing when set
+ * @param visit Called with each entry's name and type ("." and ".." skipped)
+ * @return true if the whole directory was listed
+ */
+template <typename Visitor>
+bool listDirectory(const std::filesystem::path& directory, const std::atomic<bool>& cancel, Visitor&& visit) {
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        DEBUG_LOG("DirectoryWalker: can't list " << directory << ": " << std::strerror(errno));
+        return false;
+    }
+
+    alignas(dirent64) char buffer[DIRENT_BUFFER_SIZE];
+    bool complete = true;
+    for (;;) {
+        ssize_t length = ::getdents64(fd, buffer, sizeof(buffer));
+        if (length == 0) break;
+        if (length < 0) {
+            DEBUG_LOG("DirectoryWalker: error listing " << directory << ": " << std::strerror(errno));
+            complete = false;
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* entry = reinterpret_cast<const dirent64*>(buffer + offset);
+            offset += entry->d_reclen;
+
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            std::filesystem::file_type type = fileType(entry->d_type);
+            if (type == std::filesystem::file_type::unknown) {
+                struct stat st;
+                if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                    type = fileType(IFTODT(st.st_mode));
+                }
+            }
+            visit(name, type);
+        }
+        if (cancel) {
+            complete = false;
+            break;
+        }
+    }
+
+    ::close(fd);
+    return complete;
+}
+
+/**
+ * @brief Directories waiting to be listed by one worker.
+ *
+ * The owner pushes and pops at the back; thieves take from the front,
+ * which holds the shallowest (largest) subtrees.
+ */
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::filesystem::path> directories;
+};
+
+/**
+ * @brief State shared by the workers of one walk.
+ */
+class Walk {
+public:
+    Walk(unsigned workers, DirectoryIndex* index, const PathFilter* filter,
+         const DirectoryWalker::EntryVisitor& visit, const DirectoryWalker::DirectoryVisitor& visitDirectory,
+         const std::atomic<bool>& cancel)
+        : m_index(index), m_filter(filter), m_visit(visit), m_visitDirectory(visitDirectory), m_cancel(cancel) {
+        for (unsigned i = 0; i < workers; ++i) {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+    }
+
+    void push(unsigned worker, std::filesystem::path directory) {
+        ++m_outstanding;
+        {
+            std::lock_guard<std::mutex> lock(m_queues[worker]->mutex);
+            m_queues[worker]->directories.push_back(std::move(directory));
+        }
+        ++m_queued;
+        if (m_sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_idle.notify_one();
+        }
+    }
+
+    void run(unsigned worker) {
+        while (!m_cancel) {
+            std::optional<std::filesystem::path> directory = take(worker);
+            if (!directory) {
+                if (m_outstanding.load() == 0) break;
+
+                std::unique_lock<std::mutex> lock(m_idleMutex);
+                ++m_sleeping;
+                m_idle.wait_for(lock, IDLE_WAIT, [this] {
+                    return m_queued.load() > 0 || m_outstanding.load() == 0 || m_cancel.load();
+                });
+                --m_sleeping;
+                continue;
+            }
+
+            list(worker, *directory);
+
+            if (--m_outstanding == 0) {
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                m_idle.notify_all();
+            }
+        }
+    }
+
+private:
+    std::optional<std::filesystem::path> take(unsigned worker) {
+        // Own queue first, newest directory (depth first)
+        {
+            WorkQueue& own = *m_queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.directories.empty()) {
+                std::filesystem::path directory = std::move(own.directories.back());
+                own.directories.pop_back();
+                --m_queued;
+                return directory;
+            }
+        }
+
+        // Then steal the oldest directory of another worker
+        size_t count = m_queues.size();
+        for (size_t i = 1; i < count; ++i) {
+            WorkQueue& victim = *m_queues[(worker + i) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.directories.empty()) {
+                std::filesystem::path directory = std::move(victim.directories.front());
+                victim.directories.pop_front();
+                --m_queued;
+                return directory;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void list(unsigned worker, const std::filesystem::path& directory) {
+        // The mtime is read before listing, so changes made during the
+        // listing show up as a newer mtime next time
+        int64_t modifiedTime = 0;
+        if (m_index) {
+            std::error_code timeEc;
+            auto time = std::filesystem::last_write_time(directory, timeEc);
+            if (!timeEc) {
+                modifiedTime = time.time_since_epoch().count();
+                std::vector<std::filesystem::path> subdirectories;
+                if (const DirectoryRecord* previous = m_index->reuse(directory, modifiedTime, subdirectories)) {
+                    std::erase_if(subdirectories, [this](const auto& subdirectory) { return excluded(subdirectory); });
+                    for (const auto& subdirectory : subdirectories) push(worker, subdirectory);
+                    if (m_visitDirectory) m_visitDirectory(*previous, subdirectories);
+                    return;
+                }
+            }
+        }
+
+        int64_t entryCount = 0;
+        std::vector<std::filesystem::path> subdirectories;
+        bool complete = listDirectory(directory, m_cancel, [&](const char* name, std::filesystem::file_type type) {
+            ++entryCount;
+            if (type == std::filesystem::file_type::directory) {
+                std::filesystem::path subdirectory = directory / name;
+                if (excluded(subdirectory)) return;
+                if (m_visitDirectory) subdirectories.push_back(subdirectory);
+                push(worker, std::move(subdirectory));
+            } else {
+                m_visit(WalkEntry{directory / name, type});
+            }
+        });
+
+        // Incomplete listings are left out, so they are listed again next time
+        if (!complete) return;
+        DirectoryRecord record{directory, modifiedTime, entryCount};
+        if (m_index) record = m_index->record(directory, modifiedTime, entryCount);
+        if (m_visitDirectory) m_visitDirectory(record, subdirectories);
+    }
+
+    bool excluded(const std::filesystem::path& directory) const {
+        return m_filter && m_filter->excludesDirectory(directory);
+    }
+
+    DirectoryIndex* m_index;
+    const PathFilter* m_filter;
+    const DirectoryWalker::EntryVisitor& m_visit;
+    const DirectoryWalker::DirectoryVisitor& m_visitDirectory;
+    const std::atomic<bool>& m_cancel;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::atomic<size_t> m_outstanding{0};   ///< Directories queued or being listed
+    std::atomic<size_t> m_queued{0};        ///< Directories waiting in a queue
+    std::atomic<unsigned> m_sleeping{0};    ///< Workers waiting for work
+
+    std::mutex m_idleMutex;
+    std::condition_variable m_idle;
+};
+
+} // anonymous namespace
+
+DirectoryWalker::DirectoryWalker(unsigned concurrency)
+    : m_concurrency(concurrency > 0 ? concurrency : defaultConcurrency()) {}
+
+unsigned DirectoryWalker::defaultConcurrency() {
+    return std::clamp(2 * std::thread::hardware_concurrency(), 4u, 32u);
+}
+
+bool DirectoryWalker::walk(const std::filesystem::path& root, bool recursive, const EntryVisitor& visit,
+                           const std::atomic<bool>& cancel) {
+    if (!recursive) {
+        listDirectory(root, cancel, [&](const char* name, std::filesystem::file_type type) {
+            if (type != std::filesystem::file_type::directory) visit(WalkEntry{root / name, type});
+        });
+        return !cancel;
+    }
+
+    Walk walk(m_concurrency, m_index, m_filter, visit, m_visitDirectory, cancel);
+    walk.push(0, root);
+
+    // The calling thread is worker 0
+    std::vector<std::jthread> workers;
+    for (unsigned i = 1; i < m_concurrency; ++i) {
+        workers.emplace_back([&walk, i] { walk.run(i); });
+    }
+    walk.run(0);
+    workers.clear();    // Joins
+
+    return !cancel;
+}
+
+} // namespace BlenderFileFinder
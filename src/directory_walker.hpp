@@ -0,0 +1,159 @@
+/**
+ * @file directory_walker.hpp
+ * @brief Parallel recursive directory enumeration.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+class DirectoryIndex;
+class PathFilter;
+struct DirectoryRecord;
+
+/**
+ * @brief A non-directory entry found by DirectoryWalker.
+ */
+struct WalkEntry {
+    std::filesystem::path path;
+    std::filesystem::file_type type;    ///< From the directory listing, not a stat; symlinks aren't followed
+
+    /**
+     * @brief Check whether the entry may be (or link to) a regular file.
+     * @return false for entries that are certainly devices, sockets, ...
+     */
+    bool mayBeRegularFile() const {
+        return type == std::filesystem::file_type::regular || type == std::filesystem::file_type::symlink ||
+               type == std::filesystem::file_type::unknown;
+    }
+};
+
+/**
+ * @brief Enumerates a directory tree with several threads at once.
+ *
+ * On network filesystems every directory listing is a round trip to the
+ * server, so a single-threaded walk spends most of its time waiting.
+ * DirectoryWalker keeps many listings in flight: each worker owns a
+ * queue of directories, pushes the subdirectories it finds onto its own
+ * queue and, when that runs dry, steals from the other end of another
+ * worker's queue. Workers stay on their own part of the tree (depth
+ * first) while idle ones pick up whole untouched subtrees.
+ *
+ * Directories are read with getdents64(), whose d_type tells files from
+ * directories without a stat() per entry; only filesystems that don't
+ * fill d_type cost an fstatat(). Visitors get the type and stat just the
+ * entries they are interested in.
+ *
+ * Directory symlinks are not followed, like recursive_directory_iterator.
+ * Directories that can't be read are skipped.
+ *
+ * @par Usage Example:
+ * @code
+ * std::atomic<bool> cancel{false};
+ * DirectoryWalker walker(16);
+ * walker.walk("/mnt/projects", true, [](const WalkEntry& entry) {
+ *     // Called concurrently from several threads
+ * }, cancel);
+ * @endcode
+ */
+class DirectoryWalker {
+public:
+    /**
+     * @brief Called for every non-directory entry, from any worker thread.
+     */
+    using EntryVisitor = std::function<void(const WalkEntry& entry)>;
+
+    /**
+     * @brief Called once a directory is done, from any worker thread.
+     * @param directory The directory, with its mtime if an index is set
+     * @param subdirectories Subdirectories queued for listing
+     */
+    using DirectoryVisitor = std::function<void(const DirectoryRecord& directory,
+                                                const std::vector<std::filesystem::path>& subdirectories)>;
+
+    /**
+     * @brief Create a walker.
+     * @param concurrency Directories listed at once (0 = defaultConcurrency())
+     */
+    explicit DirectoryWalker(unsigned concurrency = 0);
+
+    /**
+     * @brief Walk a directory tree.
+     *
+     * Blocks until every directory has been listed or @p cancel is set.
+     * Cancellation is noticed between directory entries, so the walk
+     * returns as soon as the listings in progress return.
+     *
+     * @param root Directory to walk
+     * @param recursive If false, only @p root itself is listed
+     * @param visit Called for each file, concurrently from several threads
+     * @param cancel Set to stop the walk
+     * @return true if the whole tree was walked, false if cancelled
+     */
+    bool walk(const std::filesystem::path& root, bool recursive, const EntryVisitor& visit,
+              const std::atomic<bool>& cancel);
+
+    /**
+     * @brief Skip directories unchanged since a previous walk.
+     *
+     * With an index set, recursive walks read each directory's mtime
+     * before listing it. Directories the index reports as unchanged are
+     * not listed (their files are not visited) and the walk continues into
+     * their recorded subdirectories. Listed directories are recorded in
+     * the index.
+     *
+     * @param index Index to consult and update, or nullptr to list everything
+     */
+    void setDirectoryIndex(DirectoryIndex* index) { m_index = index; }
+
+    /**
+     * @brief Skip the subtrees of excluded directories.
+     *
+     * Directories the filter excludes are neither listed nor recorded in
+     * the index. Files are still passed to the visitor unfiltered.
+     *
+     * @param filter Rules of the walked location, or nullptr to walk everything
+     */
+    void setPathFilter(const PathFilter* filter) { m_filter = filter; }
+
+    /**
+     * @brief Report each directory of a recursive walk once it is done.
+     *
+     * A directory is done when it was listed completely, after all its
+     * files were passed to the entry visitor, or when the index let it be
+     * skipped. Directories whose listing failed or was cancelled are not
+     * reported.
+     *
+     * @param visit Called per directory, or nullptr
+     */
+    void setDirectoryVisitor(DirectoryVisitor visit) { m_visitDirectory = std::move(visit); }
+
+    /**
+     * @brief Get the number of directories listed at once.
+     * @return Worker thread count
+     */
+    unsigned concurrency() const { return m_concurrency; }
+
+    /**
+     * @brief Default concurrency: twice the hardware threads, 4 to 32.
+     *
+     * Listings mostly wait on I/O, so more workers than cores pays off on
+     * network mounts without flooding local disks.
+     *
+     * @return Worker thread count
+     */
+    static unsigned defaultConcurrency();
+
+private:
+    unsigned m_concurrency;     ///< Worker threads per walk
+    DirectoryIndex* m_index = nullptr; ///< Previous directory state, if incremental
+    const PathFilter* m_filter = nullptr; ///< Excluded directories, if any
+    DirectoryVisitor m_visitDirectory;  ///< Told about finished directories, if set
+};
+
+} // namespace BlenderFileFinder
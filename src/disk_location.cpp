@@ -0,0 +1,43 @@
+#include "disk_location.hpp"
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+DiskLocation DiskLocation::of(const std::filesystem::path& path) {
+    DiskLocation location;
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+    if (fd < 0) fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);   // O_NOATIME needs ownership
+    if (fd < 0) return location;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        location.inode = st.st_ino;
+    }
+
+    // Room for the first extent only; no FIEMAP_FLAG_SYNC, which would
+    // flush dirty data first
+    alignas(struct fiemap) unsigned char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    auto* map = reinterpret_cast<struct fiemap*>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+    if (::ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents > 0) {
+        const struct fiemap_extent& extent = map->fm_extents[0];
+        constexpr uint32_t NO_FIXED_PLACE = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC |
+                                            FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_NOT_ALIGNED;
+        if (!(extent.fe_flags & NO_FIXED_PLACE)) {
+            location.physicalOffset = extent.fe_physical;
+        }
+    }
+
+    ::close(fd);
+    return location;
+}
+
+} // namespace BlenderFileFinder
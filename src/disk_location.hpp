@@ -0,0 +1,53 @@
+/**
+ * @file disk_location.hpp
+ * @brief Where a file's data is stored, for reading many files in disk order.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <tuple>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Sort key placing files in the order their data lies on disk.
+ *
+ * Reading files in the order a directory walk finds them makes a spinning
+ * disk seek back and forth across the platter. Sorted by DiskLocation,
+ * the head sweeps across it once instead.
+ *
+ * The key is the physical offset of the file's first extent, from the
+ * FIEMAP ioctl. Filesystems without FIEMAP (and files whose data has no
+ * fixed place yet, e.g. inline or delayed allocation) sort after the rest
+ * by inode number, which most filesystems allocate near the data.
+ *
+ * @par Usage Example:
+ * @code
+ * std::vector<std::pair<DiskLocation, std::filesystem::path>> files;
+ * for (const auto& path : paths) files.emplace_back(DiskLocation::of(path), path);
+ * std::sort(files.begin(), files.end());
+ * @endcode
+ */
+struct DiskLocation {
+    uint64_t physicalOffset = std::numeric_limits<uint64_t>::max(); ///< First extent's byte offset on the device (max = unknown)
+    uint64_t inode = 0;
+
+    /**
+     * @brief Look up where a file is stored.
+     *
+     * Opens the file for one fstat() and one FIEMAP ioctl; no data is read.
+     *
+     * @param path Regular file
+     * @return Location; unknown fields keep their defaults
+     */
+    static DiskLocation of(const std::filesystem::path& path);
+
+    bool operator<(const DiskLocation& other) const {
+        return std::tie(physicalOffset, inode) < std::tie(other.physicalOffset, other.inode);
+    }
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,30 @@
+#include "file_stat.hpp"
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace BlenderFileFinder {
+
+std::optional<FileStat> FileStat::read(const std::filesystem::path& path) {
+    struct statx info;
+    if (::statx(AT_FDCWD, path.c_str(), AT_STATX_SYNC_AS_STAT | AT_NO_AUTOMOUNT,
+                STATX_TYPE | STATX_SIZE | STATX_MTIME, &info) == 0) {
+        if (!S_ISREG(info.stx_mode)) return std::nullopt;
+        return FileStat{info.stx_size, fromUnixTime(info.stx_mtime.tv_sec, info.stx_mtime.tv_nsec)};
+    }
+    if (errno != ENOSYS) return std::nullopt;
+
+    // Kernels older than 4.11
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return std::nullopt;
+    return FileStat{static_cast<uintmax_t>(st.st_size),
+                    fromUnixTime(st.st_mtim.tv_sec, static_cast<uint32_t>(st.st_mtim.tv_nsec))};
+}
+
+std::filesystem::file_time_type FileStat::fromUnixTime(int64_t seconds, uint32_t nanoseconds) {
+    auto sysTime = std::chrono::sys_seconds(std::chrono::seconds(seconds)) + std::chrono::nanoseconds(nanoseconds);
+    return std::chrono::file_clock::from_sys(sysTime);
+}
+
+} // namespace BlenderFileFinder
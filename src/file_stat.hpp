@@ -0,0 +1,51 @@
+/**
+ * @file file_stat.hpp
+ * @brief Size and modification time of a file from a single statx().
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Metadata the scanner needs about a file, read once.
+ *
+ * The scanner stats each .blend candidate when the walker finds it and
+ * hands the result through to BlendParser, so parsing doesn't stat the
+ * file again.
+ */
+struct FileStat {
+    uintmax_t size = 0;                             ///< File size in bytes
+    std::filesystem::file_time_type modifiedTime{}; ///< Last modification time
+
+    bool operator==(const FileStat&) const = default;
+
+    /**
+     * @brief Stat a regular file, following symlinks.
+     *
+     * Asks statx() for the type, size and mtime only, which network
+     * filesystems can answer without fetching the rest of the inode.
+     *
+     * @param path File path
+     * @return Size and mtime, or std::nullopt if missing or not a regular file
+     */
+    static std::optional<FileStat> read(const std::filesystem::path& path);
+
+    /**
+     * @brief Convert a Unix timestamp the way std::filesystem::last_write_time does.
+     *
+     * Values from either source compare equal, so mtimes stored by one
+     * can be checked against the other.
+     *
+     * @param seconds Seconds since the Unix epoch
+     * @param nanoseconds Nanoseconds within the second
+     * @return Equivalent file_time_type
+     */
+    static std::filesystem::file_time_type fromUnixTime(int64_t seconds, uint32_t nanoseconds);
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,117 @@
+#include "file_stream.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+ssize_t readAt(int fd, char* buffer, size_t size, off_t offset) {
+    ssize_t n;
+    do {
+        n = ::pread(fd, buffer, size, offset);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+} // anonymous namespace
+
+FileStream::FileStream(const std::filesystem::path& path) : std::istream(nullptr) {
+    rdbuf(&m_buffer);
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        setstate(std::ios::failbit);
+        return;
+    }
+    m_buffer.setFd(fd);
+}
+
+FileStream::~FileStream() {
+    if (m_buffer.fd() >= 0) {
+        ::close(m_buffer.fd());
+    }
+}
+
+FileStream::Buffer::int_type FileStream::Buffer::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (m_fd < 0) return traits_type::eof();
+
+    off_type next = position();
+    ssize_t n = readAt(m_fd, m_data, BUFFER_SIZE, static_cast<off_t>(next));
+    m_start = next;
+    if (n <= 0) {
+        setg(m_data, m_data, m_data);
+        return traits_type::eof();
+    }
+    setg(m_data, m_data, m_data + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize FileStream::Buffer::xsgetn(char_type* s, std::streamsize count) {
+    std::streamsize done = 0;
+
+    // Buffered bytes first
+    std::streamsize buffered = std::min<std::streamsize>(count, egptr() - gptr());
+    if (buffered > 0) {
+        std::memcpy(s, gptr(), static_cast<size_t>(buffered));
+        gbump(static_cast<int>(buffered));
+        done = buffered;
+    }
+
+    // Large reads (thumbnails, payloads) go straight into the caller's memory
+    if (count - done >= static_cast<std::streamsize>(BUFFER_SIZE) && m_fd >= 0) {
+        off_type next = position();
+        while (done < count) {
+            ssize_t n = readAt(m_fd, s + done, static_cast<size_t>(count - done), static_cast<off_t>(next));
+            if (n <= 0) break;
+            done += n;
+            next += n;
+        }
+        m_start = next;
+        setg(m_data, m_data, m_data);
+        return done;
+    }
+
+    while (done < count && underflow() != traits_type::eof()) {
+        std::streamsize chunk = std::min<std::streamsize>(count - done, egptr() - gptr());
+        std::memcpy(s + done, gptr(), static_cast<size_t>(chunk));
+        gbump(static_cast<int>(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+FileStream::Buffer::pos_type FileStream::Buffer::seekoff(off_type offset, std::ios_base::seekdir dir,
+                                                         std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in) || m_fd < 0) return pos_type(off_type(-1));
+
+    off_type target;
+    if (dir == std::ios_base::beg) {
+        target = offset;
+    } else if (dir == std::ios_base::cur) {
+        target = position() + offset;
+    } else {
+        off_t end = ::lseek(m_fd, 0, SEEK_END);
+        if (end < 0) return pos_type(off_type(-1));
+        target = end + offset;
+    }
+    if (target < 0) return pos_type(off_type(-1));
+
+    // Seeks within the buffer keep it; others empty it for the next read
+    if (target >= m_start && target <= m_start + (egptr() - eback())) {
+        setg(eback(), eback() + (target - m_start), egptr());
+    } else {
+        m_start = target;
+        setg(m_data, m_data, m_data);
+    }
+    return pos_type(target);
+}
+
+FileStream::Buffer::pos_type FileStream::Buffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,78 @@
+/**
+ * @file file_stream.hpp
+ * @brief Buffered input stream over a file descriptor.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <istream>
+#include <streambuf>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief std::istream that reads a file through a descriptor it owns.
+ *
+ * Reads and seeks like std::ifstream, but fd() exposes the descriptor,
+ * so the parser can give page cache hints (PageCacheHints) or map the
+ * file (MappedFile) without opening it a second time.
+ *
+ * @par Usage Example:
+ * @code
+ * FileStream file(path);
+ * if (!file) return;
+ * PageCacheHints hints(file.fd(), stat.size, 256 * 1024);
+ * file.read(buffer, size);
+ * @endcode
+ */
+class FileStream : public std::istream {
+public:
+    /**
+     * @brief Open a file for reading; the stream fails if it can't be opened.
+     * @param path File to read
+     */
+    explicit FileStream(const std::filesystem::path& path);
+    ~FileStream() override;
+
+    FileStream(const FileStream&) = delete;
+    FileStream& operator=(const FileStream&) = delete;
+
+    /**
+     * @brief Get the descriptor the stream reads from.
+     * @return Open descriptor, or -1 if the file couldn't be opened
+     */
+    int fd() const { return m_buffer.fd(); }
+
+private:
+    /**
+     * @brief Read buffer filled with pread(), so seeks are only bookkeeping.
+     */
+    class Buffer : public std::streambuf {
+    public:
+        Buffer() { setg(m_data, m_data, m_data); }
+
+        void setFd(int fd) { m_fd = fd; }
+        int fd() const { return m_fd; }
+
+    protected:
+        int_type underflow() override;
+        std::streamsize xsgetn(char_type* s, std::streamsize count) override;
+        pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 8192;  ///< Same as std::filebuf
+
+        /// File offset of the next byte to read
+        off_type position() const { return m_start + (gptr() - eback()); }
+
+        int m_fd = -1;
+        off_type m_start = 0;       ///< File offset of m_data[0]
+        char m_data[BUFFER_SIZE];
+    };
+
+    Buffer m_buffer;
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,431 @@
+#include "file_watcher.hpp"
+#include "debug.hpp"
+#include "directory_walker.hpp"
+#include "file_stat.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <unordered_set>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// A path is reported once no event arrived for it for this long
+constexpr auto DEBOUNCE = std::chrono::seconds(1);
+
+// Network locations are walked this often
+constexpr auto POLL_INTERVAL = std::chrono::seconds(60);
+
+// The watcher thread checks for stop requests and settled paths this often
+constexpr int WAKE_INTERVAL_MS = 250;
+
+// Directory entries that can add, replace or remove a .blend file. Files
+// are reported when closed after writing, not when created, so partly
+// copied files aren't parsed.
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+// statfs() f_type of filesystems whose remote changes inotify doesn't see
+constexpr long NETWORK_FILESYSTEMS[] = {
+    0x6969,         // NFS
+    0x517B,         // SMB
+    0xFF534D42,     // CIFS
+    0xFE534D42,     // SMB2
+    0x65735546,     // FUSE (sshfs, rclone, ...)
+    0x01021997,     // 9P
+    0x00C36400,     // Ceph
+    0x5346414F,     // AFS
+    0x73757245,     // Coda
+    0x564C,         // NCP
+    0x0BD00BD0,     // Lustre
+};
+
+} // anonymous namespace
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+void FileWatcher::start(const std::vector<ScanLocation>& locations, EventCallback callback) {
+    stop();
+
+    m_stopRequested = false;
+    m_callback = std::move(callback);
+    m_thread = std::jthread([this, locations]() {
+        run(locations);
+    });
+}
+
+void FileWatcher::stop() {
+    m_stopRequested = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool FileWatcher::isNetworkFilesystem(const std::filesystem::path& path) {
+    struct statfs info;
+    if (statfs(path.c_str(), &info) != 0) {
+        return false;
+    }
+    long type = static_cast<long>(info.f_type);
+    return std::find(std::begin(NETWORK_FILESYSTEMS), std::end(NETWORK_FILESYSTEMS), type) !=
+           std::end(NETWORK_FILESYSTEMS);
+}
+
+void FileWatcher::run(std::vector<ScanLocation> locations) {
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        DEBUG_LOG("FileWatcher: inotify unavailable, polling all locations");
+    }
+
+    for (const auto& location : locations) {
+        m_filters[location.id] = PathFilter(location.path, location.includePatterns, location.excludePatterns);
+    }
+
+    for (const auto& location : locations) {
+        if (m_stopRequested) break;
+        std::error_code ec;
+        if (!location.enabled || !std::filesystem::is_directory(location.path, ec)) continue;
+
+        bool watched = m_inotifyFd >= 0 && !isNetworkFilesystem(location.path) &&
+                       addWatchTree(location.path, location.recursive, location.id);
+        if (watched) {
+            m_inotifyLocations.push_back(location);
+            continue;
+        }
+
+        PolledLocation polled;
+        polled.location = location;
+        poll(polled, false);
+        polled.nextPoll = std::chrono::steady_clock::now() + POLL_INTERVAL;
+        m_polledLocations.push_back(std::move(polled));
+    }
+
+    DEBUG_LOG("FileWatcher: " << m_watches.size() << " directories watched in " << m_inotifyLocations.size()
+              << " locations, " << m_polledLocations.size() << " locations polled");
+
+    while (!m_stopRequested) {
+        pollfd descriptor{m_inotifyFd, POLLIN, 0};
+        int ready = ::poll(&descriptor, m_inotifyFd >= 0 ? 1 : 0, WAKE_INTERVAL_MS);
+        if (m_stopRequested) break;
+        if (ready > 0 && (descriptor.revents & POLLIN)) {
+            readEvents();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto& polled : m_polledLocations) {
+            if (now < polled.nextPoll) continue;
+            poll(polled, true);
+            polled.nextPoll = std::chrono::steady_clock::now() + POLL_INTERVAL;
+        }
+
+        flushSettled();
+    }
+
+    // Unsettled paths are dropped; the next scan picks them up
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    m_watches.clear();
+    m_inotifyLocations.clear();
+    m_polledLocations.clear();
+    m_filters.clear();
+    m_pending.clear();
+}
+
+bool FileWatcher::addWatchTree(const std::filesystem::path& root, bool recursive, int64_t scanLocationId) {
+    std::vector<int> added;
+    bool limitReached = false;
+
+    auto addWatch = [&](const std::filesystem::path& directory) {
+        int wd = inotify_add_watch(m_inotifyFd, directory.c_str(), WATCH_MASK);
+        if (wd < 0) {
+            // Unreadable or already gone directories are skipped
+            limitReached = errno == ENOSPC || errno == ENOMEM;
+            return;
+        }
+        m_watches[wd] = Watch{directory, recursive, scanLocationId};
+        added.push_back(wd);
+    };
+
+    addWatch(root);
+    if (recursive) {
+        const PathFilter& filter = filterFor(scanLocationId);
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it(
+            root, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && !limitReached && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (m_stopRequested) break;
+            std::error_code typeEc;
+            if (it->is_directory(typeEc) && !it->is_symlink(typeEc)) {
+                if (filter.excludesDirectory(it->path())) {
+                    it.disable_recursion_pending();
+                    continue;
+                }
+                addWatch(it->path());
+            }
+        }
+    }
+
+    if (limitReached) {
+        DEBUG_LOG("FileWatcher: inotify watch limit reached under " << root
+                  << " (raise fs.inotify.max_user_watches), polling instead");
+        for (int wd : added) {
+            inotify_rm_watch(m_inotifyFd, wd);
+            m_watches.erase(wd);
+        }
+        return false;
+    }
+    return true;
+}
+
+void FileWatcher::removeWatchTree(const std::filesystem::path& root) {
+    std::string prefix = root.string() + '/';
+    for (auto it = m_watches.begin(); it != m_watches.end();) {
+        const std::string directory = it->second.directory.string();
+        if (directory == root.string() || directory.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(m_inotifyFd, it->first);
+            it = m_watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileWatcher::fallBackToPolling(int64_t scanLocationId) {
+    auto location = std::find_if(m_inotifyLocations.begin(), m_inotifyLocations.end(),
+                                 [&](const ScanLocation& loc) { return loc.id == scanLocationId; });
+    if (location == m_inotifyLocations.end()) return;
+
+    for (auto it = m_watches.begin(); it != m_watches.end();) {
+        if (it->second.scanLocationId == scanLocationId) {
+            inotify_rm_watch(m_inotifyFd, it->first);
+            it = m_watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    PolledLocation polled;
+    polled.location = *location;
+    m_inotifyLocations.erase(location);
+    poll(polled, false);
+    polled.nextPoll = std::chrono::steady_clock::now() + POLL_INTERVAL;
+
+    // Changes between the last event and the baseline poll may be missed
+    std::vector<WatchEvent> events{WatchEvent{WatchEvent::Type::Rescan, polled.location.path, false, scanLocationId}};
+    m_polledLocations.push_back(std::move(polled));
+    if (m_callback) m_callback(events);
+}
+
+void FileWatcher::readEvents() {
+    alignas(inotify_event) char buffer[16384];
+    bool overflow = false;
+    std::vector<int64_t> fallBack;
+
+    for (;;) {
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;     // EAGAIN: drained
+
+        for (char* p = buffer; p < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+
+            auto watch = m_watches.find(event->wd);
+            if (watch == m_watches.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                m_watches.erase(watch);
+                continue;
+            }
+            if (event->len == 0) continue;
+
+            std::filesystem::path path = watch->second.directory / event->name;
+            bool recursive = watch->second.recursive;
+            int64_t scanLocationId = watch->second.scanLocationId;
+
+            const PathFilter& filter = filterFor(scanLocationId);
+            if (event->mask & IN_ISDIR) {
+                if (!recursive || filter.excludesDirectory(path)) continue;
+                if (event->mask & IN_MOVED_FROM) {
+                    // Watches follow the directory; drop them in case it left the tree
+                    removeWatchTree(path);
+                }
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !addWatchTree(path, true, scanLocationId)) {
+                    fallBack.push_back(scanLocationId);
+                    continue;
+                }
+                pend(path, true, scanLocationId);
+            } else if (!(event->mask & IN_CREATE) && filter.matchesFile(path)) {
+                pend(path, false, scanLocationId);
+            }
+        }
+    }
+
+    for (int64_t scanLocationId : fallBack) {
+        fallBackToPolling(scanLocationId);
+    }
+
+    if (overflow) {
+        // The kernel queue overflowed and events were dropped
+        DEBUG_LOG("FileWatcher: inotify queue overflowed, requesting rescans");
+        std::vector<WatchEvent> events;
+        for (const auto& location : m_inotifyLocations) {
+            events.push_back(WatchEvent{WatchEvent::Type::Rescan, location.path, false, location.id});
+        }
+        if (m_callback && !events.empty()) m_callback(events);
+    }
+}
+
+void FileWatcher::poll(PolledLocation& polled, bool report) {
+    const ScanLocation& location = polled.location;
+
+    // Files of every directory that had to be listed
+    std::mutex listedMutex;
+    std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> listed;
+
+    const PathFilter& filter = filterFor(location.id);
+    DirectoryIndex index(polled.directories);
+    DirectoryWalker walker;
+    walker.setDirectoryIndex(&index);
+    walker.setPathFilter(&filter);
+    bool complete = walker.walk(location.path, location.recursive, [&](const WalkEntry& entry) {
+        if (!entry.mayBeRegularFile() || !filter.matchesFile(entry.path)) return;
+        auto stat = FileStat::read(entry.path);
+        if (!stat) return;
+
+        std::lock_guard<std::mutex> lock(listedMutex);
+        listed[entry.path.parent_path().string()][entry.path.string()] = stat->modifiedTime.time_since_epoch().count();
+    }, m_stopRequested);
+    if (!complete) return;
+
+    std::unordered_map<std::string, int64_t> previousTimes;
+    for (const auto& record : polled.directories) {
+        previousTimes.emplace(record.path.string(), record.modifiedTime);
+    }
+
+    // Reused records are copied unchanged; any other record was listed now.
+    // Non-recursive walks don't use the index and always list the root.
+    std::vector<DirectoryRecord> records = location.recursive
+        ? index.records()
+        : std::vector<DirectoryRecord>{DirectoryRecord{location.path, 0, 0}};
+
+    std::unordered_set<std::string> seen;
+    for (const auto& record : records) {
+        std::string directory = record.path.string();
+        seen.insert(directory);
+
+        auto previous = previousTimes.find(directory);
+        bool wasListed = previous == previousTimes.end() || previous->second == 0 ||
+                         previous->second != record.modifiedTime;
+        if (!wasListed) continue;
+
+        auto& known = polled.files[directory];
+        auto& current = listed[directory];
+        if (report) {
+            for (const auto& [path, modifiedTime] : current) {
+                auto old = known.find(path);
+                if (old == known.end() || old->second != modifiedTime) {
+                    pend(path, false, location.id);
+                }
+            }
+            for (const auto& [path, modifiedTime] : known) {
+                if (!current.count(path)) pend(path, false, location.id);
+            }
+        }
+        known = std::move(current);
+        if (known.empty()) polled.files.erase(directory);
+    }
+
+    // Directories that disappeared take their files with them
+    for (auto it = polled.files.begin(); it != polled.files.end();) {
+        if (seen.count(it->first)) {
+            ++it;
+            continue;
+        }
+        if (report) {
+            for (const auto& [path, modifiedTime] : it->second) pend(path, false, location.id);
+        }
+        it = polled.files.erase(it);
+    }
+
+    polled.directories = std::move(records);
+}
+
+void FileWatcher::pend(const std::filesystem::path& path, bool isDirectory, int64_t scanLocationId) {
+    auto now = std::chrono::steady_clock::now();
+    PendingPath& pending = m_pending[path.string()];
+    pending.lastEvent = now;
+    pending.isDirectory = pending.isDirectory || isDirectory;
+    pending.scanLocationId = scanLocationId;
+
+    // A directory being copied in settles only when its contents do
+    for (auto parent = path.parent_path(); parent.has_relative_path(); parent = parent.parent_path()) {
+        auto it = m_pending.find(parent.string());
+        if (it != m_pending.end() && it->second.isDirectory) it->second.lastEvent = now;
+    }
+}
+
+void FileWatcher::flushSettled() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<WatchEvent> events;
+    std::unordered_set<std::string> reported;
+
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (now - it->second.lastEvent < DEBOUNCE) {
+            ++it;
+            continue;
+        }
+
+        // Report the path's current state, however many events led to it
+        std::filesystem::path path = it->first;
+        const PendingPath& pending = it->second;
+        std::error_code ec;
+        if (pending.isDirectory && std::filesystem::is_directory(path, ec)) {
+            // Created or moved in: everything inside is new here
+            const PathFilter& filter = filterFor(pending.scanLocationId);
+            std::filesystem::recursive_directory_iterator entries(
+                path, std::filesystem::directory_options::skip_permission_denied, ec);
+            for (; !ec && entries != std::filesystem::recursive_directory_iterator(); entries.increment(ec)) {
+                std::error_code typeEc;
+                if (entries->is_directory(typeEc) && filter.excludesDirectory(entries->path())) {
+                    entries.disable_recursion_pending();
+                } else if (entries->is_regular_file(typeEc) && filter.matchesFile(entries->path()) &&
+                           reported.insert(entries->path().string()).second) {
+                    events.push_back(WatchEvent{WatchEvent::Type::Changed, entries->path(), false, pending.scanLocationId});
+                }
+            }
+        } else if (std::filesystem::is_regular_file(path, ec)) {
+            if (reported.insert(it->first).second) {
+                events.push_back(WatchEvent{WatchEvent::Type::Changed, path, false, pending.scanLocationId});
+            }
+        } else if (reported.insert(it->first).second) {
+            events.push_back(WatchEvent{WatchEvent::Type::Removed, path, pending.isDirectory, pending.scanLocationId});
+        }
+        it = m_pending.erase(it);
+    }
+
+    if (!events.empty() && m_callback) {
+        DEBUG_LOG("FileWatcher: " << events.size() << " changes settled");
+        m_callback(events);
+    }
+}
+
+const PathFilter& FileWatcher::filterFor(int64_t scanLocationId) const {
+    static const PathFilter everyBlendFile;
+    auto it = m_filters.find(scanLocationId);
+    return it != m_filters.end() ? it->second : everyBlendFile;
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,167 @@
+/**
+ * @file file_watcher.hpp
+ * @brief Live change notifications for scan locations.
+ */
+
+#pragma once
+
+#include "database.hpp"
+#include "directory_index.hpp"
+#include "path_filter.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief A settled change to a .blend file under a watched location.
+ */
+struct WatchEvent {
+    enum class Type {
+        Changed,    ///< File was created or saved; parse it again
+        Removed,    ///< File (or, with isDirectory, a whole directory) is gone
+        Rescan      ///< Events were lost; rescan the location
+    };
+
+    Type type = Type::Changed;
+    std::filesystem::path path;         ///< File, removed directory, or location root (Rescan)
+    bool isDirectory = false;           ///< Removed: everything under path is gone
+    int64_t scanLocationId = 0;         ///< Location the path belongs to
+};
+
+/**
+ * @brief Watches scan locations and reports .blend files as they change.
+ *
+ * Local filesystems are watched with inotify: one watch per directory,
+ * added as directories appear. Network mounts (NFS, SMB/CIFS, FUSE, ...)
+ * don't deliver inotify events for changes made by other machines, so
+ * they are polled instead: every POLL_INTERVAL the location is walked
+ * with a DirectoryIndex, which only lists directories whose mtime
+ * changed, and the files found are compared with the previous poll.
+ * Locations also fall back to polling when the inotify watch limit
+ * (fs.inotify.max_user_watches) is reached.
+ *
+ * Events are debounced per path: a path is reported once it has been
+ * quiet for a second, with its state at that moment. Blender saves by
+ * writing "file.blend@" (ignored, not a .blend name) and then renaming
+ * file.blend to file.blend1 and file.blend@ to file.blend, so a save
+ * yields exactly one Changed event for each of file.blend and
+ * file.blend1. Files being written are only reported once closed.
+ *
+ * Directories excluded by a location's rules get no watch and aren't
+ * polled, and only files its PathFilter matches are reported.
+ *
+ * Files rewritten in place on a network mount don't change their
+ * directory's mtime and are not noticed by polling.
+ *
+ * @par Usage Example:
+ * @code
+ * FileWatcher watcher;
+ * watcher.start(database.getAllScanLocations(), [](std::vector<WatchEvent>& events) {
+ *     // Called from the watcher thread
+ * });
+ * @endcode
+ */
+class FileWatcher {
+public:
+    /**
+     * @brief Callback for settled events, called from the watcher thread.
+     * @param events Events since the previous call (may be moved from)
+     */
+    using EventCallback = std::function<void(std::vector<WatchEvent>& events)>;
+
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Start watching, replacing any previous set of locations.
+     *
+     * Disabled and missing locations are skipped. Changes made before
+     * start() are not reported; a scan catches up on those.
+     *
+     * @param locations Locations to watch
+     * @param callback Receives settled events
+     */
+    void start(const std::vector<ScanLocation>& locations, EventCallback callback);
+
+    /**
+     * @brief Stop watching and join the watcher thread.
+     */
+    void stop();
+
+    /**
+     * @brief Check whether the watcher thread is running.
+     * @return true between start() and stop()
+     */
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /**
+     * @brief Check whether a path is on a network or FUSE filesystem.
+     * @param path Existing path
+     * @return true if inotify can't be relied on for it
+     */
+    static bool isNetworkFilesystem(const std::filesystem::path& path);
+
+private:
+    /**
+     * @brief Inotify watch on one directory.
+     */
+    struct Watch {
+        std::filesystem::path directory;
+        bool recursive = true;          ///< Watch subdirectories as they appear
+        int64_t scanLocationId = 0;
+    };
+
+    /**
+     * @brief Location that is polled instead of watched.
+     */
+    struct PolledLocation {
+        ScanLocation location;
+        std::vector<DirectoryRecord> directories;   ///< Directory mtimes of the last poll
+        std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> files; ///< Directory -> file -> mtime
+        std::chrono::steady_clock::time_point nextPoll;
+    };
+
+    /**
+     * @brief Path waiting for its events to settle.
+     */
+    struct PendingPath {
+        std::chrono::steady_clock::time_point lastEvent;
+        bool isDirectory = false;
+        int64_t scanLocationId = 0;
+    };
+
+    void run(std::vector<ScanLocation> locations);
+    bool addWatchTree(const std::filesystem::path& root, bool recursive, int64_t scanLocationId);
+    void removeWatchTree(const std::filesystem::path& root);
+    void fallBackToPolling(int64_t scanLocationId);
+    void readEvents();
+    void poll(PolledLocation& polled, bool report);
+    void pend(const std::filesystem::path& path, bool isDirectory, int64_t scanLocationId);
+    void flushSettled();
+    const PathFilter& filterFor(int64_t scanLocationId) const;
+
+    std::jthread m_thread;
+    std::atomic<bool> m_stopRequested{false};
+    EventCallback m_callback;
+
+    // Watcher thread only
+    int m_inotifyFd = -1;
+    std::unordered_map<int, Watch> m_watches;                   ///< Watch descriptor -> directory
+    std::vector<ScanLocation> m_inotifyLocations;
+    std::vector<PolledLocation> m_polledLocations;
+    std::unordered_map<int64_t, PathFilter> m_filters;          ///< Location ID -> compiled rules
+    std::unordered_map<std::string, PendingPath> m_pending;     ///< Path -> last event
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,77 @@
+#include "mapped_file.hpp"
+#include "debug.hpp"
+#include "file_stat.hpp"
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_modifiedTime(other.m_modifiedTime) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_modifiedTime = other.m_modifiedTime;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        close();
+        return false;
+    }
+
+    bool mapped = open(fd);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+
+    if (!mapped) {
+        DEBUG_LOG("MappedFile: couldn't map " << path.filename());
+    }
+    return mapped;
+}
+
+bool MappedFile::open(int fd) {
+    close();
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        return false;
+    }
+
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(addr);
+    m_size = static_cast<size_t>(st.st_size);
+
+    m_modifiedTime = FileStat::fromUnixTime(st.st_mtim.tv_sec, static_cast<uint32_t>(st.st_mtim.tv_nsec));
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+} // namespace BlenderFileFinder
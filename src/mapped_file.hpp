@@ -0,0 +1,83 @@
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only memory mapping of a file on disk.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief RAII wrapper around a read-only mmap() of a whole file.
+ *
+ * The file descriptor is closed as soon as the mapping is established,
+ * so an open MappedFile only holds address space, not a descriptor.
+ * Size and modification time are taken from the same fstat() call used
+ * to size the mapping, so callers don't need to stat the file again.
+ *
+ * @note Empty files cannot be mapped; open() fails for them.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Map a file into memory (read-only).
+     * @param path Path to the file
+     * @return true if the file was mapped, false on error
+     */
+    bool open(const std::filesystem::path& path);
+
+    /**
+     * @brief Map a file the caller already opened (read-only).
+     * @param fd Open descriptor; stays open and owned by the caller
+     * @return true if the file was mapped, false on error
+     */
+    bool open(int fd);
+
+    /**
+     * @brief Unmap the file (no-op if nothing is mapped).
+     */
+    void close();
+
+    /**
+     * @brief Check if a file is currently mapped.
+     * @return true if mapped
+     */
+    bool isOpen() const { return m_data != nullptr; }
+
+    /**
+     * @brief Get a pointer to the first byte of the mapping.
+     * @return Mapped bytes, or nullptr if not open
+     */
+    const uint8_t* data() const { return m_data; }
+
+    /**
+     * @brief Get the size of the mapping.
+     * @return Size in bytes (the file size at open time)
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief Get the file's modification time as seen at open time.
+     * @return Modification time in std::filesystem clock units
+     */
+    std::filesystem::file_time_type modifiedTime() const { return m_modifiedTime; }
+
+private:
+    const uint8_t* m_data = nullptr;                    ///< Start of the mapping
+    size_t m_size = 0;                                  ///< Mapping length in bytes
+    std::filesystem::file_time_type m_modifiedTime{};   ///< st_mtime at open
+};
+
+} // namespace BlenderFileFinder
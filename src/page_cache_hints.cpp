@@ -0,0 +1,53 @@
+#include "page_cache_hints.hpp"
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Pages checked to tell whether a file was in use before the scan read it
+constexpr size_t RESIDENCY_CHECK_BYTES = 64 * 1024;
+
+/**
+ * @brief Check whether any of the first pages of a file are in the page cache.
+ *
+ * Mapping without touching the pages reads nothing; mincore() only
+ * reports what is resident. (A RWF_NOWAIT read would be one call, but
+ * on a miss it starts readahead that DONTNEED can't drop later.)
+ */
+bool headIsCached(int fd, size_t fileSize) {
+    size_t length = std::min(fileSize, RESIDENCY_CHECK_BYTES);
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) return false;
+
+    size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> resident((length + pageSize - 1) / pageSize);
+    bool cached = ::mincore(addr, length, resident.data()) == 0 &&
+                  std::any_of(resident.begin(), resident.end(), [](unsigned char page) { return page & 1; });
+    ::munmap(addr, length);
+    return cached;
+}
+
+} // anonymous namespace
+
+PageCacheHints::PageCacheHints(int fd, uint64_t fileSize, uint64_t readAheadBytes) {
+    if (fd < 0 || fileSize == 0) return;
+    m_fd = fd;
+
+    m_wasCached = headIsCached(m_fd, static_cast<size_t>(fileSize));
+    if (readAheadBytes > 0 && !m_wasCached) {
+        ::posix_fadvise(m_fd, 0, static_cast<off_t>(std::min(readAheadBytes, fileSize)), POSIX_FADV_WILLNEED);
+    }
+}
+
+PageCacheHints::~PageCacheHints() {
+    if (m_fd >= 0 && !m_wasCached) {
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+}
+
+} // namespace BlenderFileFinder
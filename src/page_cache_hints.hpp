@@ -0,0 +1,62 @@
+/**
+ * @file page_cache_hints.hpp
+ * @brief posix_fadvise() hints that keep bulk reads out of the page cache.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Page cache hints around one read of a file during a bulk scan.
+ *
+ * A scan touches the head of every .blend file once and never again, but
+ * the kernel keeps those pages and evicts older ones to make room: after
+ * indexing a large library, the files people are actually working on
+ * have to be read from disk again.
+ *
+ * Constructing PageCacheHints asks the kernel to read the head of the
+ * file ahead (POSIX_FADV_WILLNEED), so the parser's first reads don't
+ * wait for one small request after another. Destroying it drops the
+ * file's pages (POSIX_FADV_DONTNEED), unless the head was already cached
+ * when the scan got to it: then someone is using the file and it stays.
+ *
+ * The hints go through the descriptor the parser reads with (see
+ * FileStream), so they cost no extra open. They apply to the file, not
+ * the descriptor, and also cover a mapping or decompressor reading it.
+ *
+ * @par Usage Example:
+ * @code
+ * {
+ *     FileStream file(path);
+ *     PageCacheHints hints(file.fd(), stat.size, 256 * 1024);
+ *     auto info = parse(file);
+ * }   // Pages read by parse() are released here
+ * @endcode
+ */
+class PageCacheHints {
+public:
+    /**
+     * @brief Read ahead the head of a file.
+     * @param fd Descriptor of the file about to be read; must outlive the hints
+     * @param fileSize Size of the file, as already stat()ed by the caller
+     * @param readAheadBytes Bytes from the start to read ahead (0 = none)
+     */
+    PageCacheHints(int fd, uint64_t fileSize, uint64_t readAheadBytes);
+
+    /**
+     * @brief Drop the file's pages, unless they were cached beforehand.
+     */
+    ~PageCacheHints();
+
+    PageCacheHints(const PageCacheHints&) = delete;
+    PageCacheHints& operator=(const PageCacheHints&) = delete;
+
+private:
+    int m_fd = -1;              ///< Caller's descriptor, -1 if no hints were given
+    bool m_wasCached = false;   ///< Head was resident before the read
+};
+
+} // namespace BlenderFileFinder
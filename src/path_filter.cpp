@@ -0,0 +1,263 @@
+#include "path_filter.hpp"
+#include <algorithm>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+bool hasWildcard(std::string_view pattern) {
+    return pattern.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+/**
+ * @brief Match one character against a "[...]" class.
+ * @param pattern Pattern starting at '['; on success advanced past ']'
+ * @param c Character to test
+ * @param[out] matched Whether the class contains @p c
+ * @return false if the class isn't closed (then '[' is an ordinary character)
+ */
+bool matchClass(std::string_view& pattern, char c, bool& matched) {
+    size_t i = 1;
+    bool negate = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+    if (negate) ++i;
+
+    bool found = false;
+    bool first = true;
+    for (; i < pattern.size() && (first || pattern[i] != ']'); first = false) {
+        char low = pattern[i++];
+        char high = low;
+        if (i + 1 < pattern.size() && pattern[i] == '-' && pattern[i + 1] != ']') {
+            high = pattern[i + 1];
+            i += 2;
+        }
+        if (low <= c && c <= high) found = true;
+    }
+    if (i >= pattern.size()) return false;
+
+    pattern.remove_prefix(i + 1);
+    matched = found != negate;
+    return true;
+}
+
+/**
+ * @brief Match a path against a glob.
+ *
+ * '*' and '?' stop at '/' and "**" doesn't; a "**" directory component
+ * also matches no directory at all.
+ */
+bool globMatch(std::string_view pattern, std::string_view text) {
+    while (!pattern.empty()) {
+        char p = pattern.front();
+
+        if (p == '*') {
+            if (pattern.size() > 1 && pattern[1] == '*') {
+                std::string_view rest = pattern.substr(2);
+                if (!rest.empty() && rest.front() == '/') {
+                    // Zero or more whole directories
+                    rest.remove_prefix(1);
+                    for (size_t i = 0;;) {
+                        if (globMatch(rest, text.substr(i))) return true;
+                        i = text.find('/', i);
+                        if (i == std::string_view::npos) return false;
+                        ++i;
+                    }
+                }
+                for (size_t i = 0; i <= text.size(); ++i) {
+                    if (globMatch(rest, text.substr(i))) return true;
+                }
+                return false;
+            }
+
+            std::string_view rest = pattern.substr(1);
+            for (size_t i = 0; i <= text.size(); ++i) {
+                if (globMatch(rest, text.substr(i))) return true;
+                if (i < text.size() && text[i] == '/') break;
+            }
+            return false;
+        }
+
+        if (text.empty()) return false;
+        char c = text.front();
+
+        if (p == '?') {
+            if (c == '/') return false;
+            pattern.remove_prefix(1);
+        } else if (p == '[') {
+            bool matched = false;
+            if (matchClass(pattern, c, matched)) {
+                if (!matched || c == '/') return false;
+            } else {
+                if (c != '[') return false;
+                pattern.remove_prefix(1);
+            }
+        } else {
+            if (p == '\\' && pattern.size() > 1) {
+                pattern.remove_prefix(1);
+                p = pattern.front();
+            }
+            if (p != c) return false;
+            pattern.remove_prefix(1);
+        }
+        text.remove_prefix(1);
+    }
+    return text.empty();
+}
+
+std::string_view trim(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // anonymous namespace
+
+PathFilter::PathFilter(const std::filesystem::path& root, const std::vector<std::string>& includePatterns,
+                       const std::vector<std::string>& excludePatterns)
+    : m_root(root.string()) {
+    while (!m_root.empty() && m_root.back() == '/') m_root.pop_back();
+
+    for (const auto& pattern : includePatterns) m_include.add(pattern);
+    for (const auto& pattern : excludePatterns) m_exclude.add(pattern);
+}
+
+bool PathFilter::excludesDirectory(const std::filesystem::path& directory) const {
+    if (m_exclude.patterns.empty()) return false;
+
+    std::string_view relative = relativePath(directory);
+    size_t slash = relative.rfind('/');
+    std::string_view name = slash == std::string_view::npos ? relative : relative.substr(slash + 1);
+    return m_exclude.matches(relative, name, true);
+}
+
+bool PathFilter::matchesFile(const std::filesystem::path& file) const {
+    const std::string& path = file.native();
+    size_t slash = path.rfind('/');
+    if (!isBlendName(slash == std::string::npos ? std::string_view(path) : std::string_view(path).substr(slash + 1))) {
+        return false;
+    }
+    if (empty()) return true;
+
+    // Directories were pruned by the walk, but files reported on their own
+    // (e.g. by the watcher) are checked against their parents as well
+    std::string_view relative = relativePath(file);
+    if (m_exclude.matchesWithin(relative)) return false;
+    return m_include.patterns.empty() || m_include.matchesWithin(relative);
+}
+
+bool PathFilter::isBlendName(std::string_view name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos) return false;
+    std::string_view extension = name.substr(dot + 1);
+
+    // "blend" in any case, then only digits (backups: .blend1, .blend2, ...)
+    constexpr std::string_view BLEND = "blend";
+    if (extension.size() < BLEND.size()) return false;
+    for (size_t i = 0; i < BLEND.size(); ++i) {
+        if ((extension[i] | 0x20) != BLEND[i]) return false;
+    }
+    return std::all_of(extension.begin() + BLEND.size(), extension.end(),
+                       [](char c) { return c >= '0' && c <= '9'; });
+}
+
+std::vector<std::string> PathFilter::splitPatterns(std::string_view text) {
+    std::vector<std::string> patterns;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        std::string_view line = trim(text.substr(0, end));
+        if (!line.empty() && line.front() != '#') patterns.emplace_back(line);
+        if (end == std::string_view::npos) break;
+        text.remove_prefix(end + 1);
+    }
+    return patterns;
+}
+
+std::string PathFilter::joinPatterns(const std::vector<std::string>& patterns) {
+    std::string text;
+    for (const auto& pattern : patterns) {
+        if (!text.empty()) text += '\n';
+        text += pattern;
+    }
+    return text;
+}
+
+std::string_view PathFilter::relativePath(const std::filesystem::path& path) const {
+    std::string_view full = path.native();
+    if (full.size() > m_root.size() && full.compare(0, m_root.size(), m_root) == 0 && full[m_root.size()] == '/') {
+        return full.substr(m_root.size() + 1);
+    }
+    return full;
+}
+
+void PathFilter::Rules::add(std::string_view pattern) {
+    pattern = trim(pattern);
+    if (pattern.empty() || pattern == "/") return;
+    patterns.emplace_back(pattern);
+
+    Pattern compiledPattern;
+
+    // "dir/**" covers the same files as pruning "dir/" itself
+    if (pattern.size() > 3 && pattern.substr(pattern.size() - 3) == "/**") {
+        compiledPattern.anchored = true;
+        pattern.remove_suffix(2);
+    }
+    if (pattern.size() > 1 && pattern.back() == '/') {
+        compiledPattern.directoryOnly = true;
+        pattern.remove_suffix(1);
+    }
+    if (pattern.front() == '/') {
+        compiledPattern.anchored = true;
+        pattern.remove_prefix(1);
+    }
+    if (pattern.find('/') != std::string_view::npos) {
+        compiledPattern.anchored = true;
+    }
+
+    if (!compiledPattern.anchored && !hasWildcard(pattern)) {
+        (compiledPattern.directoryOnly ? directoryNames : names).emplace(pattern);
+        return;
+    }
+
+    if (!compiledPattern.anchored && pattern.size() > 1 && pattern.front() == '*' && !hasWildcard(pattern.substr(1))) {
+        compiledPattern.kind = Pattern::Kind::Suffix;
+        compiledPattern.text = pattern.substr(1);
+    } else {
+        compiledPattern.text = pattern;
+    }
+    compiled.push_back(std::move(compiledPattern));
+}
+
+bool PathFilter::Rules::matches(std::string_view relativePath, std::string_view name, bool isDirectory) const {
+    if (!names.empty() || (isDirectory && !directoryNames.empty())) {
+        std::string key(name);
+        if (names.count(key) || (isDirectory && directoryNames.count(key))) return true;
+    }
+
+    for (const auto& pattern : compiled) {
+        if (pattern.directoryOnly && !isDirectory) continue;
+        if (pattern.kind == Pattern::Kind::Suffix) {
+            if (name.size() >= pattern.text.size() &&
+                name.compare(name.size() - pattern.text.size(), pattern.text.size(), pattern.text) == 0) {
+                return true;
+            }
+        } else if (globMatch(pattern.text, pattern.anchored ? relativePath : name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PathFilter::Rules::matchesWithin(std::string_view relativePath) const {
+    // Each parent directory, then the file itself
+    size_t nameStart = 0;
+    for (size_t slash = relativePath.find('/'); slash != std::string_view::npos;
+         slash = relativePath.find('/', slash + 1)) {
+        if (matches(relativePath.substr(0, slash), relativePath.substr(nameStart, slash - nameStart), true)) {
+            return true;
+        }
+        nameStart = slash + 1;
+    }
+    return matches(relativePath, relativePath.substr(nameStart), false);
+}
+
+} // namespace BlenderFileFinder
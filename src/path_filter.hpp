@@ -0,0 +1,150 @@
+/**
+ * @file path_filter.hpp
+ * @brief Include/exclude rules deciding which files a scan visits.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Compiled glob rules of one scan location.
+ *
+ * Rules use gitignore-like globs:
+ * - A pattern without '/' matches a file or directory name at any depth
+ *   (".git", "node_modules", "*_autosave.blend").
+ * - A pattern with '/' matches the path relative to the location root
+ *   ("renders/final", "/cache"; a leading '/' is optional).
+ * - A trailing '/' only matches directories ("tmp/").
+ * - '*' and '?' don't cross '/', "**" does; "[abc]" and "[!a-z]" match
+ *   one character; '\' escapes the next character.
+ *
+ * A directory matching an exclude rule is not listed at all, so whole
+ * subtrees (.git, render output, node_modules) cost nothing. Files must be
+ * .blend files or backups, must not be excluded, and, if there are
+ * include rules, must match one of them or be inside a directory that
+ * does.
+ *
+ * Patterns are compiled once: plain names go into a hash set and "*.ext"
+ * patterns become suffix checks, so most rules are matched without
+ * running the glob matcher. A default-constructed filter accepts every
+ * .blend file. Matching is thread-safe.
+ *
+ * @par Usage Example:
+ * @code
+ * PathFilter filter(location.path, {}, {".git", "renders/"});
+ * walker.setPathFilter(&filter);
+ * walker.walk(location.path, true, [&](const WalkEntry& entry) {
+ *     if (filter.matchesFile(entry.path)) { ... }
+ * }, cancel);
+ * @endcode
+ */
+class PathFilter {
+public:
+    /**
+     * @brief Create a filter that accepts every .blend file.
+     */
+    PathFilter() = default;
+
+    /**
+     * @brief Compile a location's rules.
+     * @param root Location root; relative patterns are matched below it
+     * @param includePatterns Files must match one of these (empty = all)
+     * @param excludePatterns Files and directories matching these are skipped
+     */
+    PathFilter(const std::filesystem::path& root, const std::vector<std::string>& includePatterns,
+               const std::vector<std::string>& excludePatterns);
+
+    /**
+     * @brief Check whether a directory's subtree should be skipped.
+     *
+     * Only the directory itself is checked; its parents are assumed to
+     * have passed already.
+     *
+     * @param directory Directory below the root
+     * @return true if it matches an exclude rule
+     */
+    bool excludesDirectory(const std::filesystem::path& directory) const;
+
+    /**
+     * @brief Check whether a file should be scanned.
+     * @param file File below the root
+     * @return true for a .blend file (or backup) accepted by the rules
+     */
+    bool matchesFile(const std::filesystem::path& file) const;
+
+    /**
+     * @brief Check whether any rules are set.
+     * @return true if the filter only checks for .blend names
+     */
+    bool empty() const { return m_include.patterns.empty() && m_exclude.patterns.empty(); }
+
+    /**
+     * @brief Check whether a file name is a .blend file or a backup of one.
+     * @param name File name
+     * @return true for .blend, .blend1, .blend2, ... (any case)
+     */
+    static bool isBlendName(std::string_view name);
+
+    /**
+     * @brief Split rule text into patterns.
+     *
+     * One pattern per line; surrounding whitespace, empty lines and lines
+     * starting with '#' are dropped.
+     *
+     * @param text Rules as typed or stored
+     * @return Patterns
+     */
+    static std::vector<std::string> splitPatterns(std::string_view text);
+
+    /**
+     * @brief Join patterns into rule text, one per line.
+     * @param patterns Patterns
+     * @return Text accepted by splitPatterns()
+     */
+    static std::string joinPatterns(const std::vector<std::string>& patterns);
+
+private:
+    /**
+     * @brief One compiled pattern.
+     */
+    struct Pattern {
+        enum class Kind {
+            Suffix,     ///< "*.ext" on the name: compare the end
+            Glob        ///< Anything else: run the glob matcher
+        };
+
+        Kind kind = Kind::Glob;
+        std::string text;               ///< Glob, or the suffix for Kind::Suffix
+        bool anchored = false;          ///< Matched against the relative path, not the name
+        bool directoryOnly = false;     ///< Trailing '/': only matches directories
+    };
+
+    /**
+     * @brief Compiled patterns of one rule list.
+     */
+    struct Rules {
+        std::vector<std::string> patterns;          ///< As given, for empty()
+        std::unordered_set<std::string> names;      ///< Plain names, any depth
+        std::unordered_set<std::string> directoryNames; ///< Plain names with a trailing '/'
+        std::vector<Pattern> compiled;              ///< Everything else
+
+        void add(std::string_view pattern);
+        bool matches(std::string_view relativePath, std::string_view name, bool isDirectory) const;
+        bool matchesWithin(std::string_view relativePath) const;
+    };
+
+    std::string_view relativePath(const std::filesystem::path& path) const;
+
+    std::string m_root;     ///< Root with no trailing '/'
+    Rules m_include;
+    Rules m_exclude;
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,38 @@
+#include "pixel_buffer_pool.hpp"
+
+namespace BlenderFileFinder {
+
+PixelBufferPool::PixelBufferPool(size_t maxBuffers)
+    : m_maxBuffers(maxBuffers) {
+    // Reserve up front so release() never grows the free list
+    m_buffers.reserve(maxBuffers);
+}
+
+std::vector<uint8_t> PixelBufferPool::acquire() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffers.empty()) {
+        return {};
+    }
+
+    std::vector<uint8_t> buffer = std::move(m_buffers.back());
+    m_buffers.pop_back();
+    return buffer;
+}
+
+void PixelBufferPool::release(std::vector<uint8_t>&& buffer) {
+    if (buffer.capacity() == 0) return;  // Nothing worth keeping
+
+    buffer.clear();  // Keeps capacity
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffers.size() < m_maxBuffers) {
+        m_buffers.push_back(std::move(buffer));
+    }
+}
+
+size_t PixelBufferPool::available() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers.size();
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,64 @@
+/**
+ * @file pixel_buffer_pool.hpp
+ * @brief Recycled pixel buffers for thumbnail loading.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Thread-safe free list of pixel buffers.
+ *
+ * Thumbnails are loaded on worker threads and released on the main thread
+ * once uploaded to the GPU. Handing the buffer back here instead of freeing
+ * it lets the next load reuse its capacity, so once the pool is warm a
+ * thumbnail load allocates no pixel memory.
+ *
+ * @par Usage Example:
+ * @code
+ * BlendThumbnail thumbnail;
+ * thumbnail.pixels = pool.acquire();
+ * BlendParser::readThumbnail(path, thumbnail);  // Fills the recycled buffer
+ * // ... upload ...
+ * pool.release(std::move(thumbnail.pixels));
+ * @endcode
+ */
+class PixelBufferPool {
+public:
+    /**
+     * @brief Construct a pool.
+     * @param maxBuffers Most buffers kept for reuse; extra releases are freed
+     */
+    explicit PixelBufferPool(size_t maxBuffers = 32);
+
+    /**
+     * @brief Take a buffer from the pool.
+     * @return Empty buffer, with the capacity of an earlier thumbnail if one was pooled
+     */
+    std::vector<uint8_t> acquire();
+
+    /**
+     * @brief Return a buffer for reuse.
+     * @param buffer Buffer to recycle (contents are discarded)
+     */
+    void release(std::vector<uint8_t>&& buffer);
+
+    /**
+     * @brief Get the number of buffers waiting to be reused.
+     * @return Pooled buffer count
+     */
+    size_t available() const;
+
+private:
+    mutable std::mutex m_mutex;                     ///< Protects m_buffers
+    std::vector<std::vector<uint8_t>> m_buffers;    ///< Released buffers
+    size_t m_maxBuffers;                            ///< Pool capacity
+};
+
+} // namespace BlenderFileFinder
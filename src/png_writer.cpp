@@ -0,0 +1,73 @@
+#include "png_writer.hpp"
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+void appendBE32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void appendChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+    appendBE32(out, static_cast<uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) out.insert(out.end(), data, data + size);
+
+    // The CRC covers the chunk type and data, not the length
+    uLong crc = crc32(0L, out.data() + start, static_cast<uInt>(out.size() - start));
+    appendBE32(out, static_cast<uint32_t>(crc));
+}
+
+} // anonymous namespace
+
+bool PngWriter::write(const std::filesystem::path& path, int width, int height, const uint8_t* rgba) {
+    if (width <= 0 || height <= 0 || !rgba) return false;
+
+    // Each row is prefixed with its filter type (0 = none)
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> raw((rowBytes + 1) * static_cast<size_t>(height));
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = raw.data() + (rowBytes + 1) * static_cast<size_t>(y);
+        row[0] = 0;
+        std::memcpy(row + 1, rgba + rowBytes * static_cast<size_t>(y), rowBytes);
+    }
+
+    uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, raw.data(), static_cast<uLong>(raw.size()),
+                  Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return false;
+    }
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.reserve(png.size() + compressedSize + 64);
+
+    std::vector<uint8_t> header;
+    appendBE32(header, static_cast<uint32_t>(width));
+    appendBE32(header, static_cast<uint32_t>(height));
+    header.push_back(8);    // Bit depth
+    header.push_back(6);    // Color type: RGBA
+    header.push_back(0);    // Compression: deflate
+    header.push_back(0);    // Filter method
+    header.push_back(0);    // No interlace
+
+    appendChunk(png, "IHDR", header.data(), header.size());
+    appendChunk(png, "IDAT", compressed.data(), compressedSize);
+    appendChunk(png, "IEND", nullptr, 0);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace BlenderFileFinder
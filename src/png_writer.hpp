@@ -0,0 +1,33 @@
+/**
+ * @file png_writer.hpp
+ * @brief Minimal PNG encoder for generated preview frames.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Writes 8-bit RGBA images as PNG files.
+ *
+ * Rows are stored unfiltered and compressed with zlib, which the
+ * application already links for compressed .blend files. Good enough for
+ * small preview frames; not meant for large images.
+ */
+class PngWriter {
+public:
+    /**
+     * @brief Encode and write an image.
+     * @param path Output file (overwritten)
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param rgba Pixels, top row first, 4 bytes per pixel
+     * @return true if the file was written
+     */
+    static bool write(const std::filesystem::path& path, int width, int height, const uint8_t* rgba);
+};
+
+} // namespace BlenderFileFinder
@@ -1,5 +1,6 @@
 #include "preview_cache.hpp"
 #include "debug.hpp"
+#include "turntable_renderer.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -232,15 +233,41 @@ bool PreviewCache::generatePreview(const std::filesystem::path& blendFile) {
         return false;
     }
 
+    auto outputDir = getPreviewDir(blendFile);
+    std::filesystem::create_directories(outputDir);
+
+    DEBUG_LOG("Generating preview: \"" << blendFile.filename() << "\"");
+
+    bool success = false;
+    if (m_useBuiltinRenderer) {
+        TurntableRenderer::Settings settings;
+        settings.frameCount = m_frameCount;
+        settings.resolution = m_resolution;
+        success = TurntableRenderer::renderFile(blendFile, outputDir, settings);
+    }
+    if (!success) {
+        success = renderWithBlender(blendFile, outputDir);
+    }
+
+    if (success) {
+        DEBUG_LOG("Preview generated successfully for " << blendFile.filename());
+        // Update cache
+        m_previewExistsCache[blendFile] = true;
+        return true;
+    } else {
+        DEBUG_LOG("Preview generation failed for " << blendFile.filename());
+        m_previewExistsCache[blendFile] = false;
+        return false;
+    }
+}
+
+bool PreviewCache::renderWithBlender(const std::filesystem::path& blendFile, const std::filesystem::path& outputDir) {
     auto scriptPath = getBlenderScriptPath();
     if (scriptPath.empty() || !std::filesystem::exists(scriptPath)) {
         DEBUG_LOG("Cannot generate preview: turntable script not found");
         return false;
     }
 
-    auto outputDir = getPreviewDir(blendFile);
-    std::filesystem::create_directories(outputDir);
-
     // Build Blender command - log output for debugging
     auto logFile = outputDir / "render.log";
     std::stringstream cmd;
@@ -251,8 +278,6 @@ bool PreviewCache::generatePreview(const std::filesystem::path& blendFile) {
         << m_resolution
         << " > \"" << logFile.string() << "\" 2>&1";
 
-    DEBUG_LOG("Generating preview: \"" << blendFile.filename() << "\"");
-
     int result = std::system(cmd.str().c_str());
 
     // Check for success
@@ -273,16 +298,7 @@ bool PreviewCache::generatePreview(const std::filesystem::path& blendFile) {
         }
     }
 
-    if (success) {
-        DEBUG_LOG("Preview generated successfully for " << blendFile.filename());
-        // Update cache
-        m_previewExistsCache[blendFile] = true;
-        return true;
-    } else {
-        DEBUG_LOG("Preview generation failed for " << blendFile.filename());
-        m_previewExistsCache[blendFile] = false;
-        return false;
-    }
+    return success;
 }
 
 void PreviewCache::startBatchGeneration(const std::vector<std::filesystem::path>& files,
@@ -33,16 +33,18 @@ struct PreviewFrames {
  * @brief Cache for animated turntable previews of .blend files.
  *
  * Generates and caches animated previews by rendering .blend files
- * from multiple angles using Blender in background mode. Previews
- * are stored on disk and loaded into OpenGL textures on demand.
+ * from multiple angles. Previews are stored on disk and loaded into
+ * OpenGL textures on demand.
  *
  * The generation process:
- * 1. Runs Blender headless with a Python script (turntable_render.py)
- * 2. Renders N frames (default 24) rotating around the scene
+ * 1. Renders N frames (default 144) rotating around the largest meshes,
+ *    with the built-in TurntableRenderer
+ * 2. Falls back to Blender headless with a Python script
+ *    (turntable_render.py) for files without readable mesh geometry
  * 3. Saves frames as PNG files in ~/.cache/BlenderFileFinder/previews/
  * 4. Loads frames into OpenGL textures when requested
  *
- * @note Preview generation requires Blender to be installed and
+ * @note The Blender fallback requires Blender to be installed and
  *       accessible via the 'blender' command.
  */
 class PreviewCache {
@@ -88,8 +90,9 @@ public:
     /**
      * @brief Generate a preview for a single file (blocking).
      *
-     * Runs Blender to render the turntable animation. This can take
-     * several seconds per file.
+     * Renders the turntable animation with the built-in renderer, or
+     * with Blender if that is disabled or finds no meshes. Blender can
+     * take several seconds per file.
      *
      * @param blendFile Path to the .blend file
      * @return true if generation succeeded
@@ -157,6 +160,22 @@ public:
      */
     int getResolution() const { return m_resolution; }
 
+    /**
+     * @brief Enable or disable the built-in software renderer.
+     *
+     * When disabled every preview is rendered by Blender, which shows
+     * modifiers, materials and non-mesh objects.
+     *
+     * @param enabled true to try the built-in renderer first (default)
+     */
+    void setUseBuiltinRenderer(bool enabled) { m_useBuiltinRenderer = enabled; }
+
+    /**
+     * @brief Check whether the built-in software renderer is tried first.
+     * @return true if enabled
+     */
+    bool getUseBuiltinRenderer() const { return m_useBuiltinRenderer; }
+
     /// @}
 
     /**
@@ -175,10 +194,12 @@ private:
     std::string getFileHash(const std::filesystem::path& blendFile) const;
     std::filesystem::path getBlenderScriptPath() const;
     void loadPreviewFrames(const std::filesystem::path& blendFile, PreviewFrames& preview);
+    bool renderWithBlender(const std::filesystem::path& blendFile, const std::filesystem::path& outputDir);
 
     std::filesystem::path m_cacheDir;       ///< Preview cache directory
     int m_frameCount = 144;                 ///< Frames per preview animation (6x slower)
     int m_resolution = 128;                 ///< Frame resolution (pixels)
+    std::atomic<bool> m_useBuiltinRenderer{true}; ///< Try TurntableRenderer before Blender
 
     std::map<std::filesystem::path, PreviewFrames> m_previews;  ///< Loaded previews
     mutable std::map<std::filesystem::path, bool> m_previewExistsCache; ///< hasPreview cache
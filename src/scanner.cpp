@@ -1,10 +1,53 @@
 #include "scanner.hpp"
+#include "bounded_queue.hpp"
 #include "debug.hpp"
+#include "directory_walker.hpp"
+#include "disk_location.hpp"
 #include <algorithm>
-#include <regex>
+#include <chrono>
+#include <iterator>
 
 namespace BlenderFileFinder {
 
+namespace {
+
+// Paths found but not yet parsed, and parsed files not yet handed on
+constexpr size_t PATH_QUEUE_CAPACITY = 4096;
+constexpr size_t PARSED_QUEUE_CAPACITY = 512;
+
+// Parsed files are handed to the batch callback in groups of this size,
+// once no new file arrived for WRITER_IDLE_FLUSH, or at the latest
+// WRITER_MAX_FLUSH_DELAY after the last hand-over when files trickle in
+constexpr size_t WRITE_BATCH_SIZE = 256;
+constexpr auto WRITER_IDLE_FLUSH = std::chrono::milliseconds(250);
+constexpr auto WRITER_MAX_FLUSH_DELAY = std::chrono::seconds(2);
+
+// A .blend file found by the walker, stat()ed once
+struct FoundFile {
+    std::filesystem::path path;
+    FileStat stat;
+    DiskLocation location;      // Only looked up for ParseOrder::Disk
+};
+
+// A listed directory whose files aren't all handed on yet
+struct PendingDirectory {
+    int64_t outstanding = 0;    // Files found but not yet handed on
+    bool listed = false;        // Listing done; record is valid
+    DirectoryRecord record;
+};
+
+// What is stored for a file that couldn't be parsed
+BlendFileInfo basicInfo(const std::filesystem::path& path, const FileStat& stat) {
+    BlendFileInfo info;
+    info.path = path;
+    info.filename = path.filename().string();
+    info.fileSize = stat.size;
+    info.modifiedTime = stat.modifiedTime;
+    return info;
+}
+
+} // anonymous namespace
+
 Scanner::Scanner() = default;
 
 Scanner::~Scanner() {
@@ -17,16 +60,18 @@ void Scanner::startScan(const std::filesystem::path& directory, bool recursive)
     m_isScanning = true;
     m_stopRequested = false;
     m_isComplete = false;
+    m_wasStopped = false;
     m_filesScanned = 0;
     m_filesTotal = 0;
 
     {
         std::lock_guard<std::mutex> lock(m_resultsMutex);
         m_results.clear();
+        m_directoryRecords.clear();
     }
 
-    m_scanThread = std::jthread([this, directory, recursive]() {
-        scanThread(directory, recursive);
+    m_scanThread = std::jthread([this, directory, recursive, options = m_options]() {
+        scanThread(directory, recursive, options);
     });
 }
 
@@ -43,94 +88,249 @@ std::pair<int, int> Scanner::getProgress() const {
 }
 
 std::vector<BlendFileInfo> Scanner::pollResults() {
+    std::vector<BlendFileInfo> results;
+    std::lock_guard<std::mutex> lock(m_resultsMutex);
+    results.swap(m_results);
+    return results;
+}
+
+std::vector<DirectoryRecord> Scanner::takeDirectoryRecords() {
     std::lock_guard<std::mutex> lock(m_resultsMutex);
-    return m_results;
+    return std::move(m_directoryRecords);
 }
 
-bool Scanner::isBlendFile(const std::filesystem::path& path) const {
-    std::string ext = path.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+BlendFileInfo Scanner::parseFile(const std::filesystem::path& path, const FileStat& stat,
+                                 const ScanOptions& options) {
+    bool knownWithoutThumbnail = false;
+    auto known = options.noThumbnailFiles.find(path.string());
+    if (known != options.noThumbnailFiles.end()) {
+        knownWithoutThumbnail = stat.modifiedTime.time_since_epoch().count() == known->second;
+    }
+
+    // Known thumbnail-less files save nothing when indexing datablocks: an
+    // unchanged file is read through its stored block index, a changed
+    // one is walked
+    if (!knownWithoutThumbnail || options.indexDatablocks) {
+        return parseFile(path, stat, options.indexDatablocks, options.cacheUse, options.previewCallback);
+    }
+
+    // Searched before and unchanged since - nothing to find
+    auto info = BlendParser::parseHeader(path, &stat, options.cacheUse);
+    if (!info) return basicInfo(path, stat);
+    info->noEmbeddedThumbnail = true;
+    return std::move(*info);
+}
+
+BlendFileInfo Scanner::parseFile(const std::filesystem::path& path, const FileStat& stat,
+                                 bool indexDatablocks, BlendParser::CacheUse cacheUse,
+                                 const PreviewCallback& previewCallback) {
+    std::optional<BlendFileInfo> info;
+    if (indexDatablocks) {
+        // Names need the whole block chain; the walk finds the thumbnail
+        // and previews too
+        std::vector<BlendPreview> previews;
+        info = BlendParser::parseFull(path, BlendParser::ParseMode::Stream, previewCallback ? &previews : nullptr,
+                                      &stat, cacheUse);
+        if (info && previewCallback) {
+            previewCallback(*info, previews);
+        }
+    } else {
+        info = BlendParser::parseQuick(path, BlendParser::ParseMode::Stream, &stat, cacheUse);
+    }
 
-    // Match .blend or .blend1, .blend2, etc.
-    if (ext == ".blend") return true;
+    if (info) {
+        return std::move(*info);
+    }
 
-    // Check for backup files (.blend1, .blend2, etc.)
-    static const std::regex backupPattern(R"(\.blend\d+$)", std::regex::icase);
-    return std::regex_match(ext, backupPattern);
+    // Still add basic file info even if parsing failed
+    return basicInfo(path, stat);
 }
 
-void Scanner::scanThread(std::filesystem::path directory, bool recursive) {
+void Scanner::scanThread(std::filesystem::path directory, bool recursive, ScanOptions options) {
     DEBUG_LOG("scanThread starting: " << directory.string() << " recursive=" << recursive);
+    auto startTime = std::chrono::steady_clock::now();
 
-    std::vector<std::filesystem::path> blendFiles;
+    // Walker -> paths -> parse workers -> parsed -> writer. The queues are
+    // bounded, so a fast walk waits for parsing instead of piling up paths.
+    BoundedQueue<FoundFile> paths(PATH_QUEUE_CAPACITY);
+    BoundedQueue<BlendFileInfo> parsed(PARSED_QUEUE_CAPACITY);
 
-    // First pass: collect all blend files
-    try {
-        auto options = std::filesystem::directory_options::skip_permission_denied;
+    unsigned parseThreads = options.parseThreads > 0
+        ? options.parseThreads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::jthread> parsers;
+    for (unsigned i = 0; i < parseThreads; ++i) {
+        parsers.emplace_back([&]() {
+            while (auto found = paths.pop(m_stopRequested)) {
+                if (m_stopRequested) break;
+                if (!parsed.push(parseFile(found->path, found->stat, options), m_stopRequested)) break;
 
-        if (recursive) {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, options)) {
-                if (m_stopRequested) return;
+                ++m_filesScanned;
+                if (m_progressCallback) {
+                    m_progressCallback(m_filesScanned.load(), m_filesTotal.load());
+                }
+            }
+        });
+    }
+
+    // Walk progress for the checkpoint callback: a directory is finished
+    // once it is listed and its last file has been handed on
+    bool checkpointing = recursive && options.checkpointCallback && options.batchCallback;
+    std::mutex checkpointMutex;
+    std::unordered_map<std::string, PendingDirectory> pendingDirectories;
+    std::vector<DirectoryRecord> checkpoint;
 
-                if (entry.is_regular_file() && isBlendFile(entry.path())) {
-                    blendFiles.push_back(entry.path());
+    std::jthread writer([&]() {
+        std::vector<BlendFileInfo> batch;
+        std::vector<std::string> batchDirectories;
+        auto flush = [&]() {
+            if (!batch.empty()) {
+                if (checkpointing) {
+                    batchDirectories.clear();
+                    for (const auto& info : batch) batchDirectories.push_back(info.path.parent_path().string());
+                }
+                if (options.batchCallback) {
+                    options.batchCallback(batch);
+                } else {
+                    // Publish for pollResults(); usually it took the last batch
+                    // already and this is a swap
+                    std::lock_guard<std::mutex> lock(m_resultsMutex);
+                    if (m_results.empty()) {
+                        m_results.swap(batch);
+                    } else {
+                        std::move(batch.begin(), batch.end(), std::back_inserter(m_results));
+                    }
                 }
+                batch.clear();
             }
-        } else {
-            for (const auto& entry : std::filesystem::directory_iterator(directory, options)) {
-                if (m_stopRequested) return;
+            if (!checkpointing) return;
 
-                if (entry.is_regular_file() && isBlendFile(entry.path())) {
-                    blendFiles.push_back(entry.path());
+            std::vector<DirectoryRecord> directories;
+            {
+                std::lock_guard<std::mutex> lock(checkpointMutex);
+                for (const auto& parent : batchDirectories) {
+                    auto it = pendingDirectories.find(parent);
+                    if (it == pendingDirectories.end() || --it->second.outstanding > 0 || !it->second.listed) continue;
+                    checkpoint.push_back(std::move(it->second.record));
+                    pendingDirectories.erase(it);
                 }
+                directories.swap(checkpoint);
+            }
+            batchDirectories.clear();
+            if (!directories.empty()) options.checkpointCallback(directories);
+        };
+
+        auto lastFlush = std::chrono::steady_clock::now();
+        while (!parsed.isFinished()) {
+            // Each pop restarts the idle wait
+            auto info = parsed.popFor(WRITER_IDLE_FLUSH);
+            bool idle = !info;
+            if (info) {
+                batch.push_back(std::move(*info));
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (idle || batch.size() >= WRITE_BATCH_SIZE || now - lastFlush >= WRITER_MAX_FLUSH_DELAY) {
+                flush();
+                lastFlush = now;
             }
         }
-    } catch (const std::filesystem::filesystem_error& e) {
-        DEBUG_LOG("Filesystem error: " << e.what());
-    }
+        flush();
+    });
 
-    DEBUG_LOG("Found " << blendFiles.size() << " blend files");
-    m_filesTotal = static_cast<int>(blendFiles.size());
+    // ParseOrder::Disk collects the whole walk before parsing anything
+    bool diskOrder = options.parseOrder == ParseOrder::Disk;
+    std::mutex foundMutex;
+    std::vector<FoundFile> found;
 
-    // Second pass: parse each file
-    std::vector<BlendFileInfo> results;
-    results.reserve(blendFiles.size());
-
-    for (const auto& path : blendFiles) {
-        if (m_stopRequested) break;
-
-        auto info = BlendParser::parseQuick(path);
-        if (info) {
-            results.push_back(std::move(*info));
-        } else {
-            // Still add basic file info even if parsing failed
-            BlendFileInfo basicInfo;
-            basicInfo.path = path;
-            basicInfo.filename = path.filename().string();
-            std::error_code ec;
-            basicInfo.fileSize = std::filesystem::file_size(path, ec);
-            basicInfo.modifiedTime = std::filesystem::last_write_time(path, ec);
-            results.push_back(std::move(basicInfo));
+    std::atomic<int> filesUnchanged{0};
+    DirectoryIndex directoryIndex(options.previousDirectories);
+    DirectoryWalker walker(options.walkConcurrency);
+    walker.setDirectoryIndex(&directoryIndex);
+    walker.setPathFilter(&options.pathFilter);
+    if (checkpointing) {
+        walker.setDirectoryVisitor([&](const DirectoryRecord& done,
+                                       const std::vector<std::filesystem::path>& subdirectories) {
+            std::lock_guard<std::mutex> lock(checkpointMutex);
+            for (const auto& subdirectory : subdirectories) {
+                checkpoint.push_back(DirectoryRecord{subdirectory, 0, 0});
+            }
+            auto it = pendingDirectories.find(done.path.string());
+            if (it == pendingDirectories.end() || it->second.outstanding == 0) {
+                // No files, or all of them handed on while listing
+                checkpoint.push_back(done);
+                if (it != pendingDirectories.end()) pendingDirectories.erase(it);
+            } else {
+                it->second.listed = true;
+                it->second.record = done;
+            }
+        });
+    }
+    walker.walk(directory, recursive, [&](const WalkEntry& entry) {
+        // The listing's file type and the filter rule out most entries; only
+        // candidates are stat()ed, once, for everything parsing needs
+        if (!entry.mayBeRegularFile() || !options.pathFilter.matchesFile(entry.path)) return;
+        auto stat = FileStat::read(entry.path);
+        if (!stat) return;
+
+        if (!options.knownFiles.empty()) {
+            auto known = options.knownFiles.find(entry.path.string());
+            if (known != options.knownFiles.end() && known->second == *stat) {
+                ++filesUnchanged;
+                return;
+            }
         }
 
-        ++m_filesScanned;
+        if (checkpointing) {
+            std::lock_guard<std::mutex> lock(checkpointMutex);
+            ++pendingDirectories[entry.path.parent_path().string()].outstanding;
+        }
+        ++m_filesTotal;
+        if (diskOrder) {
+            FoundFile file{entry.path, *stat, DiskLocation::of(entry.path)};
+            std::lock_guard<std::mutex> lock(foundMutex);
+            found.push_back(std::move(file));
+            return;
+        }
+        paths.push(FoundFile{entry.path, *stat, {}}, m_stopRequested);
+    }, m_stopRequested);
 
-        if (m_progressCallback) {
-            m_progressCallback(m_filesScanned.load(), m_filesTotal.load());
+    if (diskOrder && !m_stopRequested) {
+        std::sort(found.begin(), found.end(),
+                  [](const FoundFile& a, const FoundFile& b) { return a.location < b.location; });
+        for (auto& file : found) {
+            if (!paths.push(std::move(file), m_stopRequested)) break;
         }
+        found.clear();
     }
 
-    {
-        std::lock_guard<std::mutex> lock(m_resultsMutex);
-        m_results = std::move(results);
+    // Drain the pipeline stage by stage
+    paths.close();
+    parsers.clear();    // Joins
+    parsed.close();
+    writer.join();
+
+    if (m_stopRequested) {
+        // A partial walk leaves no directory records; the stored ones stay
+        m_wasStopped = true;
+    } else {
+        DEBUG_LOG("Scanned " << m_filesScanned.load() << " blend files in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count()
+                  << "ms with " << parseThreads << " parse threads, " << filesUnchanged.load() << " unchanged skipped");
+
+        if (recursive) {
+            auto [skipped, listed] = directoryIndex.counts();
+            DEBUG_LOG("Listed " << listed << " directories, skipped " << skipped << " unchanged");
+
+            // Only a complete walk describes every directory under the root
+            std::lock_guard<std::mutex> lock(m_resultsMutex);
+            m_directoryRecords = directoryIndex.records();
+        }
     }
 
     m_isComplete = true;
     m_isScanning = false;
 
     if (m_completeCallback) {
-        std::lock_guard<std::mutex> lock(m_resultsMutex);
-        m_completeCallback(m_results);
+        m_completeCallback();
     }
 }
 
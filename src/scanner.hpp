@@ -6,12 +6,15 @@
 #pragma once
 
 #include "blend_parser.hpp"
+#include "directory_index.hpp"
+#include "path_filter.hpp"
 #include <atomic>
 #include <filesystem>
 #include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace BlenderFileFinder {
@@ -20,8 +23,13 @@ namespace BlenderFileFinder {
  * @brief Asynchronous directory scanner for .blend files.
  *
  * Scans directories in a background thread to find Blender files,
- * parsing each one to extract thumbnails and metadata. Provides
- * progress reporting and thread-safe result polling.
+ * parsing each one to extract thumbnails and metadata. A scan is a
+ * pipeline: a parallel DirectoryWalker feeds found files to a pool of
+ * parse workers, whose results are collected in batches by a writer
+ * thread (see setBatchCallback()). Stages are joined by bounded queues,
+ * so parsing starts with the first file found and memory use stays flat.
+ * Provides progress reporting and thread-safe result polling: parsed
+ * files are handed over in batches while the scan runs, each file once.
  *
  * @par Usage Example:
  * @code
@@ -35,6 +43,7 @@ namespace BlenderFileFinder {
  *     auto results = scanner.pollResults();
  *     // Process results incrementally...
  * }
+ * auto last = scanner.pollResults();   // Files parsed since the last poll
  * @endcode
  *
  * @note Only one scan can run at a time. Starting a new scan while
@@ -51,9 +60,38 @@ public:
 
     /**
      * @brief Callback type for scan completion.
-     * @param results Vector of all parsed file information
+     *
+     * Results not yet taken are still available from pollResults().
+     */
+    using CompleteCallback = std::function<void()>;
+
+    /**
+     * @brief Callback type for batches of parsed files.
+     * @param batch Files parsed since the previous batch (may be moved from)
+     */
+    using BatchCallback = std::function<void(std::vector<BlendFileInfo>& batch)>;
+
+    /**
+     * @brief Callback type for walk progress worth saving.
+     * @param directories Directories found (modifiedTime 0) or finished
+     *        since the previous call (may be moved from)
+     */
+    using CheckpointCallback = std::function<void(std::vector<DirectoryRecord>& directories)>;
+
+    /**
+     * @brief Callback type for the datablock previews of a parsed file.
+     * @param file The parsed file
+     * @param previews Its datablocks with a preview or marked as assets
+     */
+    using PreviewCallback = std::function<void(const BlendFileInfo& file, const std::vector<BlendPreview>& previews)>;
+
+    /**
+     * @brief Order in which found files are parsed.
      */
-    using CompleteCallback = std::function<void(std::vector<BlendFileInfo>)>;
+    enum class ParseOrder {
+        Discovery,  ///< As the walk finds them, while it continues
+        Disk        ///< After the walk, sorted by DiskLocation (spinning disks)
+    };
 
     Scanner();
     ~Scanner();
@@ -94,7 +132,10 @@ public:
      *
      * Returns and clears any results that have been parsed since
      * the last call. Can be called from the main thread while
-     * scanning continues in the background.
+     * scanning continues in the background; files arrive in batches of
+     * up to a few hundred, in no particular order. The results are moved
+     * out, not copied, so the scanner holds no second copy of them.
+     * Once isComplete() is true, one more call returns the rest.
      *
      * @return Vector of newly parsed file information
      */
@@ -106,35 +147,246 @@ public:
      */
     bool isComplete() const { return m_isComplete.load(); }
 
+    /**
+     * @brief Check if the last scan was cut short by stopScan().
+     * @return true once isComplete() is true for a scan that was stopped
+     */
+    bool wasStopped() const { return m_wasStopped.load(); }
+
     /**
      * @brief Set callback for progress updates.
+     *
+     * Called from the parse worker threads, possibly concurrently.
+     *
      * @param callback Function to call with progress updates
      */
     void setProgressCallback(ProgressCallback callback) { m_progressCallback = std::move(callback); }
 
     /**
      * @brief Set callback for scan completion.
+     *
+     * Called from the scan thread after the last batch was handed over,
+     * also when the scan was stopped.
+     *
      * @param callback Function to call when scan completes
      */
     void setCompleteCallback(CompleteCallback callback) { m_completeCallback = std::move(callback); }
 
+    /**
+     * @brief Set files already known to have no embedded thumbnail.
+     *
+     * Files in the map whose modification time still matches are only
+     * header-parsed instead of searched for a TEST block. Scans that
+     * index datablocks read every block anyway and don't use the map.
+     * Takes effect from the next startScan().
+     *
+     * @param files Map of path to modification time (file_time_type ticks)
+     */
+    void setNoThumbnailFiles(std::unordered_map<std::string, int64_t> files) { m_options.noThumbnailFiles = std::move(files); }
+
+    /**
+     * @brief Skip files the consumer already has.
+     *
+     * Found files whose size and mtime match their entry are neither
+     * parsed nor handed on, so rescanning an unchanged library costs only
+     * the walk. They don't count towards getProgress(). Takes effect from
+     * the next startScan().
+     *
+     * @param files Map of path to the size and mtime stored for it
+     *        (empty to parse every file)
+     */
+    void setKnownFiles(std::unordered_map<std::string, FileStat> files) { m_options.knownFiles = std::move(files); }
+
+    /**
+     * @brief Read datablock names (objects, materials, ...) while scanning.
+     *
+     * Names come from parseFull, which walks every block instead of
+     * stopping at the thumbnail, so scans take longer. Takes effect from
+     * the next startScan().
+     *
+     * @param enabled true to fill BlendMetadata::datablocks for every file
+     */
+    void setIndexDatablocks(bool enabled) { m_options.indexDatablocks = enabled; }
+
+    /**
+     * @brief Set how many directories are listed in parallel.
+     *
+     * Higher values hide network latency on NFS/SMB mounts. Takes effect
+     * from the next startScan().
+     *
+     * @param concurrency Walker threads (0 = DirectoryWalker::defaultConcurrency())
+     */
+    void setWalkConcurrency(unsigned concurrency) { m_options.walkConcurrency = concurrency; }
+
+    /**
+     * @brief Set how many files are parsed in parallel.
+     *
+     * Takes effect from the next startScan().
+     *
+     * @param threads Parse worker threads (0 = hardware concurrency)
+     */
+    void setParseThreads(unsigned threads) { m_options.parseThreads = threads; }
+
+    /**
+     * @brief Set the order in which found files are parsed.
+     *
+     * ParseOrder::Disk holds parsing back until the walk is done, then
+     * reads the files sorted by where their data lies, so a spinning disk
+     * sweeps across them instead of seeking between directories. Each
+     * file's location is looked up while walking (one open and FIEMAP
+     * ioctl per file). Takes effect from the next startScan().
+     *
+     * @param order Parse order (default: ParseOrder::Discovery)
+     */
+    void setParseOrder(ParseOrder order) { m_options.parseOrder = order; }
+
+    /**
+     * @brief Set how parsing uses the page cache.
+     *
+     * With BlendParser::CacheUse::Bulk each file's head is read ahead and
+     * its pages are dropped after parsing, so indexing a library doesn't
+     * push the files people are working on out of the cache. Takes effect
+     * from the next startScan().
+     *
+     * @param cacheUse Page cache behavior (default: Interactive, the kernel's own)
+     */
+    void setCacheUse(BlendParser::CacheUse cacheUse) { m_options.cacheUse = cacheUse; }
+
+    /**
+     * @brief Hand parsed files to a consumer in batches while scanning.
+     *
+     * Called from the scan's writer thread with up to a few hundred files
+     * at a time, e.g. to insert them into the database in one
+     * transaction. While a batch callback is set, results are not kept
+     * for pollResults(). Takes effect from the next startScan().
+     *
+     * @param callback Consumer of each batch, or nullptr to keep results
+     */
+    void setBatchCallback(BatchCallback callback) { m_options.batchCallback = std::move(callback); }
+
+    /**
+     * @brief Skip directories unchanged since a previous scan.
+     *
+     * Directories whose mtime matches their record are not listed, so the
+     * files in them are neither visited nor parsed; the walk still
+     * descends into their recorded subdirectories. Only recursive scans
+     * use the records. Takes effect from the next startScan().
+     *
+     * @param directories Records from takeDirectoryRecords() of an earlier
+     *        scan of the same directory (empty to list everything)
+     */
+    void setPreviousDirectories(std::vector<DirectoryRecord> directories) { m_options.previousDirectories = std::move(directories); }
+
+    /**
+     * @brief Set the include/exclude rules of the scanned location.
+     *
+     * Excluded directories are pruned from the walk; only files the filter
+     * matches are parsed. Takes effect from the next startScan().
+     *
+     * @param filter Compiled rules (default: every .blend file)
+     */
+    void setPathFilter(PathFilter filter) { m_options.pathFilter = std::move(filter); }
+
+    /**
+     * @brief Report walk progress so an interrupted scan can resume.
+     *
+     * Called from the writer thread right after each batch callback, with
+     * the directories found since the last call (modifiedTime 0: still to
+     * be walked) and the directories that are finished: listed completely
+     * and every file in them handed to the batch callback. Saving these
+     * and passing them to setPreviousDirectories(), in front of any older
+     * records, lets the next scan skip finished directories and pick up
+     * the rest. A found record must not replace a finished one.
+     *
+     * Only recursive scans with a batch callback report progress. Takes
+     * effect from the next startScan().
+     *
+     * @param callback Consumer of the records, or nullptr
+     */
+    void setCheckpointCallback(CheckpointCallback callback) { m_options.checkpointCallback = std::move(callback); }
+
+    /**
+     * @brief Hand each file's datablock previews to a consumer while scanning.
+     *
+     * Previews are read by the same walk that indexes datablocks, so only
+     * scans with setIndexDatablocks() report them, e.g. to fill the disk
+     * cache behind ThumbnailCache::getDatablockPreviews(). Called from the
+     * parse threads for every file parsed successfully. Takes effect from
+     * the next startScan().
+     *
+     * @param callback Consumer of each file's previews, or nullptr
+     */
+    void setPreviewCallback(PreviewCallback callback) { m_options.previewCallback = std::move(callback); }
+
+    /**
+     * @brief Take the directory records of the last completed scan.
+     *
+     * Available once isComplete() is true for a recursive scan that was
+     * not stopped; pass them to setPreviousDirectories() next time.
+     *
+     * @return Records of every directory walked, or empty
+     */
+    std::vector<DirectoryRecord> takeDirectoryRecords();
+
+    /**
+     * @brief Parse one file the way a scan with these settings does.
+     *
+     * Reads the whole block chain (parseFull) only when @p indexDatablocks
+     * is set, otherwise just the head (parseQuick). A file that can't be
+     * parsed still yields its path, size and modification time.
+     *
+     * @param path File to parse
+     * @param stat The file's size and mtime, already read
+     * @param indexDatablocks Read datablock names and references
+     * @param cacheUse Page cache hints for the parse
+     * @param previewCallback Given the file's datablock previews when
+     *        indexing datablocks and the parse succeeds (see setPreviewCallback())
+     * @return Parsed or basic file information
+     */
+    static BlendFileInfo parseFile(const std::filesystem::path& path, const FileStat& stat,
+                                   bool indexDatablocks, BlendParser::CacheUse cacheUse,
+                                   const PreviewCallback& previewCallback = nullptr);
+
 private:
-    void scanThread(std::filesystem::path directory, bool recursive);
-    bool isBlendFile(const std::filesystem::path& path) const;
+    /**
+     * @brief Settings captured when a scan starts.
+     */
+    struct ScanOptions {
+        std::unordered_map<std::string, int64_t> noThumbnailFiles; ///< Path -> mtime of files without thumbnails
+        std::unordered_map<std::string, FileStat> knownFiles; ///< Path -> stat of files stored already
+        bool indexDatablocks = false;       ///< Use parseFull to read datablock names
+        unsigned walkConcurrency = 0;       ///< Parallel directory listings (0 = default)
+        unsigned parseThreads = 0;          ///< Parse workers (0 = hardware concurrency)
+        ParseOrder parseOrder = ParseOrder::Discovery; ///< When and in which order files are parsed
+        BlendParser::CacheUse cacheUse = BlendParser::CacheUse::Interactive; ///< Page cache hints for each parse
+        BatchCallback batchCallback;        ///< Consumer of parsed batches, if any
+        CheckpointCallback checkpointCallback; ///< Consumer of walk progress, if any
+        PreviewCallback previewCallback;    ///< Consumer of datablock previews, if any
+        std::vector<DirectoryRecord> previousDirectories; ///< Directories of the previous scan
+        PathFilter pathFilter;              ///< Location's include/exclude rules
+    };
+
+    void scanThread(std::filesystem::path directory, bool recursive, ScanOptions options);
+    static BlendFileInfo parseFile(const std::filesystem::path& path, const FileStat& stat,
+                                   const ScanOptions& options);
 
     std::jthread m_scanThread;              ///< Background scanning thread
     std::atomic<bool> m_isScanning{false};  ///< Scan in progress flag
     std::atomic<bool> m_stopRequested{false}; ///< Stop request flag
     std::atomic<bool> m_isComplete{false};  ///< Scan complete flag
+    std::atomic<bool> m_wasStopped{false};  ///< Scan complete because it was stopped
 
     std::atomic<int> m_filesScanned{0};     ///< Number of files parsed
     std::atomic<int> m_filesTotal{0};       ///< Total .blend files found
 
-    std::mutex m_resultsMutex;              ///< Protects m_results
-    std::vector<BlendFileInfo> m_results;   ///< Parsed file results
+    std::mutex m_resultsMutex;              ///< Protects m_results and m_directoryRecords
+    std::vector<BlendFileInfo> m_results;   ///< Parsed files not yet polled
+    std::vector<DirectoryRecord> m_directoryRecords; ///< Directories walked by the last scan
 
     ProgressCallback m_progressCallback;    ///< Progress callback
     CompleteCallback m_completeCallback;    ///< Completion callback
+
+    ScanOptions m_options;                  ///< Settings for the next scan
 };
 
 } // namespace BlenderFileFinder
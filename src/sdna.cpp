@@ -0,0 +1,321 @@
+#include "sdna.hpp"
+#include "debug.hpp"
+#include <cstring>
+#include <mutex>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+/**
+ * @brief Bounds-checked cursor over the DNA1 payload.
+ */
+class DnaReader {
+public:
+    DnaReader(const uint8_t* data, size_t size, bool bigEndian)
+        : m_data(data), m_size(size), m_bigEndian(bigEndian) {}
+
+    bool expect(const char* tag) {
+        if (m_pos + 4 > m_size || std::memcmp(m_data + m_pos, tag, 4) != 0) return false;
+        m_pos += 4;
+        return true;
+    }
+
+    bool readInt(int32_t& value) {
+        if (m_pos + 4 > m_size) return false;
+        uint32_t raw;
+        std::memcpy(&raw, m_data + m_pos, 4);
+        if (m_bigEndian) raw = __builtin_bswap32(raw);
+        value = static_cast<int32_t>(raw);
+        m_pos += 4;
+        return true;
+    }
+
+    bool readShort(int16_t& value) {
+        if (m_pos + 2 > m_size) return false;
+        uint16_t raw;
+        std::memcpy(&raw, m_data + m_pos, 2);
+        if (m_bigEndian) raw = __builtin_bswap16(raw);
+        value = static_cast<int16_t>(raw);
+        m_pos += 2;
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        const void* nul = std::memchr(m_data + m_pos, '\0', m_size - m_pos);
+        if (!nul) return false;
+        size_t length = static_cast<const uint8_t*>(nul) - (m_data + m_pos);
+        value.assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+        m_pos += length + 1;
+        return true;
+    }
+
+    // Sections are padded to 4 bytes relative to the payload start
+    void align4() { m_pos = (m_pos + 3) & ~static_cast<size_t>(3); }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    bool m_bigEndian;
+};
+
+/**
+ * @brief Member name split into its parts, e.g. "*mat[4][4]".
+ */
+struct ParsedName {
+    std::string bare;
+    uint32_t arrayLength = 1;
+    bool isPointer = false;
+};
+
+ParsedName parseMemberName(const std::string& raw) {
+    ParsedName parsed;
+    parsed.isPointer = raw.find('*') != std::string::npos;
+
+    // Function pointers look like "(*func)()"; plain names may be "*next" or "name[66]"
+    size_t start = raw.find_first_not_of("(*");
+    size_t end = raw.find_first_of(")[", start);
+    if (start == std::string::npos) start = 0;
+    parsed.bare = raw.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+    size_t pos = raw.find('[');
+    while (pos != std::string::npos) {
+        uint32_t dim = static_cast<uint32_t>(std::strtoul(raw.c_str() + pos + 1, nullptr, 10));
+        parsed.arrayLength *= (dim > 0 ? dim : 1);
+        pos = raw.find('[', pos + 1);
+    }
+    return parsed;
+}
+
+uint64_t hashBytes(const uint8_t* data, size_t size) {
+    // FNV-1a - DNA1 blocks are a few hundred KB, this is not a hot path
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::mutex s_cacheMutex;
+std::unordered_map<std::string, std::shared_ptr<const Sdna>> s_cache;
+constexpr size_t MAX_CACHED_CATALOGUES = 64;
+
+} // anonymous namespace
+
+const Sdna::Field* Sdna::Struct::findField(std::string_view fieldName) const {
+    for (const auto& field : fields) {
+        if (field.name == fieldName) return &field;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const Sdna> Sdna::decode(const uint8_t* data, size_t size, bool is64bit, bool bigEndian) {
+    DnaReader reader(data, size, bigEndian);
+
+    int32_t nameCount = 0;
+    if (!reader.expect("SDNA") || !reader.expect("NAME") || !reader.readInt(nameCount) || nameCount < 0) {
+        return nullptr;
+    }
+
+    std::vector<std::string> names(static_cast<size_t>(nameCount));
+    for (auto& name : names) {
+        if (!reader.readString(name)) return nullptr;
+    }
+    reader.align4();
+
+    int32_t typeCount = 0;
+    if (!reader.expect("TYPE") || !reader.readInt(typeCount) || typeCount < 0) {
+        return nullptr;
+    }
+
+    std::vector<std::string> types(static_cast<size_t>(typeCount));
+    for (auto& type : types) {
+        if (!reader.readString(type)) return nullptr;
+    }
+    reader.align4();
+
+    if (!reader.expect("TLEN")) return nullptr;
+    std::vector<int16_t> typeLengths(static_cast<size_t>(typeCount));
+    for (auto& length : typeLengths) {
+        if (!reader.readShort(length)) return nullptr;
+    }
+    reader.align4();
+
+    int32_t structCount = 0;
+    if (!reader.expect("STRC") || !reader.readInt(structCount) || structCount < 0) {
+        return nullptr;
+    }
+
+    auto sdna = std::make_shared<Sdna>();
+    sdna->m_pointerSize = is64bit ? 8 : 4;
+    sdna->m_bigEndian = bigEndian;
+    sdna->m_structs.resize(static_cast<size_t>(structCount));
+
+    for (int32_t i = 0; i < structCount; ++i) {
+        int16_t typeIndex = 0, fieldCount = 0;
+        if (!reader.readShort(typeIndex) || !reader.readShort(fieldCount) ||
+            typeIndex < 0 || typeIndex >= typeCount || fieldCount < 0) {
+            return nullptr;
+        }
+
+        Struct& st = sdna->m_structs[static_cast<size_t>(i)];
+        st.name = types[static_cast<size_t>(typeIndex)];
+        st.size = static_cast<uint16_t>(typeLengths[static_cast<size_t>(typeIndex)]);
+        st.fields.reserve(static_cast<size_t>(fieldCount));
+
+        uint32_t offset = 0;
+        for (int16_t f = 0; f < fieldCount; ++f) {
+            int16_t fieldType = 0, fieldName = 0;
+            if (!reader.readShort(fieldType) || !reader.readShort(fieldName) ||
+                fieldType < 0 || fieldType >= typeCount || fieldName < 0 || fieldName >= nameCount) {
+                return nullptr;
+            }
+
+            ParsedName parsed = parseMemberName(names[static_cast<size_t>(fieldName)]);
+
+            Field field;
+            field.type = types[static_cast<size_t>(fieldType)];
+            field.name = std::move(parsed.bare);
+            field.offset = offset;
+            field.arrayLength = parsed.arrayLength;
+            field.isPointer = parsed.isPointer;
+            uint32_t elementSize = parsed.isPointer
+                ? sdna->m_pointerSize
+                : static_cast<uint16_t>(typeLengths[static_cast<size_t>(fieldType)]);
+            field.size = elementSize * parsed.arrayLength;
+
+            // SDNA structs are explicitly padded, so members are laid out back to back
+            offset += field.size;
+            st.fields.push_back(std::move(field));
+        }
+
+        sdna->m_structIndex.emplace(st.name, i);
+    }
+
+    return sdna;
+}
+
+std::shared_ptr<const Sdna> Sdna::get(const std::string& blenderVersion,
+                                      const uint8_t* data, size_t size,
+                                      bool is64bit, bool bigEndian) {
+    std::string key = blenderVersion;
+    key += is64bit ? "-" : "_";
+    key += bigEndian ? "V" : "v";
+    key += std::to_string(size);
+    key += ":";
+    key += std::to_string(hashBytes(data, size));
+
+    {
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        auto it = s_cache.find(key);
+        if (it != s_cache.end()) {
+            return it->second;
+        }
+    }
+
+    // Decode outside the lock; a concurrent decode of the same DNA is harmless
+    auto sdna = decode(data, size, is64bit, bigEndian);
+    if (!sdna) {
+        DEBUG_LOG("Sdna: failed to decode DNA1 block (" << size << " bytes, version " << blenderVersion << ")");
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    if (s_cache.size() >= MAX_CACHED_CATALOGUES) {
+        s_cache.clear();
+    }
+    auto [it, inserted] = s_cache.emplace(key, sdna);
+    if (inserted) {
+        DEBUG_LOG("Sdna: cached catalogue for Blender " << blenderVersion << " (" << sdna->m_structs.size() << " structs)");
+    }
+    return it->second;
+}
+
+size_t Sdna::cachedCount() {
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    return s_cache.size();
+}
+
+const Sdna::Struct* Sdna::structAt(int32_t sdnaIndex) const {
+    if (sdnaIndex < 0 || static_cast<size_t>(sdnaIndex) >= m_structs.size()) return nullptr;
+    return &m_structs[static_cast<size_t>(sdnaIndex)];
+}
+
+const Sdna::Struct* Sdna::findStruct(std::string_view structName) const {
+    return structAt(findStructIndex(structName));
+}
+
+int32_t Sdna::findStructIndex(std::string_view structName) const {
+    auto it = m_structIndex.find(std::string(structName));
+    return it != m_structIndex.end() ? it->second : -1;
+}
+
+bool Sdna::readInt(const uint8_t* data, size_t size, const Field& field, int64_t& value, uint32_t element) const {
+    if (field.isPointer || element >= field.arrayLength) return false;
+    if (field.type == "float" || field.type == "double") return false;
+    if (static_cast<size_t>(field.offset) + field.size > size) return false;
+
+    uint32_t elementSize = field.size / field.arrayLength;
+    const uint8_t* p = data + field.offset + static_cast<size_t>(elementSize) * element;
+    switch (elementSize) {
+        case 1:
+            value = static_cast<int8_t>(*p);
+            return true;
+        case 2: {
+            uint16_t raw;
+            std::memcpy(&raw, p, 2);
+            if (m_bigEndian) raw = __builtin_bswap16(raw);
+            value = static_cast<int16_t>(raw);
+            return true;
+        }
+        case 4: {
+            uint32_t raw;
+            std::memcpy(&raw, p, 4);
+            if (m_bigEndian) raw = __builtin_bswap32(raw);
+            value = static_cast<int32_t>(raw);
+            return true;
+        }
+        case 8: {
+            uint64_t raw;
+            std::memcpy(&raw, p, 8);
+            if (m_bigEndian) raw = __builtin_bswap64(raw);
+            value = static_cast<int64_t>(raw);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool Sdna::readFloat(const uint8_t* data, size_t size, const Field& field, float& value, uint32_t element) const {
+    if (field.isPointer || field.type != "float" || element >= field.arrayLength) return false;
+    if (static_cast<size_t>(field.offset) + field.size > size) return false;
+
+    uint32_t raw;
+    std::memcpy(&raw, data + field.offset + 4 * static_cast<size_t>(element), 4);
+    if (m_bigEndian) raw = __builtin_bswap32(raw);
+    std::memcpy(&value, &raw, 4);
+    return true;
+}
+
+bool Sdna::readPointer(const uint8_t* data, size_t size, const Field& field, uint64_t& value, uint32_t element) const {
+    if (!field.isPointer || element >= field.arrayLength) return false;
+
+    size_t start = static_cast<size_t>(field.offset) + static_cast<size_t>(m_pointerSize) * element;
+    if (start + m_pointerSize > size) return false;
+
+    if (m_pointerSize == 8) {
+        std::memcpy(&value, data + start, 8);
+        if (m_bigEndian) value = __builtin_bswap64(value);
+    } else {
+        uint32_t raw;
+        std::memcpy(&raw, data + start, 4);
+        if (m_bigEndian) raw = __builtin_bswap32(raw);
+        value = raw;
+    }
+    return true;
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,185 @@
+/**
+ * @file sdna.hpp
+ * @brief Decoder for the SDNA struct catalogue stored in .blend files.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Struct layouts decoded from a .blend file's DNA1 block.
+ *
+ * Every .blend file carries a description of the C structs it was
+ * written with (the "SDNA"): the names of all members, the names and
+ * sizes of all types, and for each struct the list of (type, member)
+ * pairs. Block headers reference these structs by index, which lets a
+ * reader find a member such as Mesh.totvert without hard-coding offsets
+ * that change between Blender versions.
+ *
+ * Decoded catalogues are immutable and shared: files written by the same
+ * Blender build carry byte-identical DNA1 blocks, so get() caches them by
+ * version and content hash and thousands of files pay the decode once.
+ *
+ * @par Usage Example:
+ * @code
+ * auto sdna = Sdna::get("4.02", dnaPayload, dnaSize, true, false);
+ * const Sdna::Struct* mesh = sdna ? sdna->findStruct("Mesh") : nullptr;
+ * const Sdna::Field* totvert = mesh ? mesh->findField("totvert") : nullptr;
+ * @endcode
+ */
+class Sdna {
+public:
+    /**
+     * @brief One member of a struct.
+     */
+    struct Field {
+        std::string type;           ///< Type name (e.g. "int", "float", "ID")
+        std::string name;           ///< Member name without '*' or array suffix
+        uint32_t offset = 0;        ///< Byte offset within the struct
+        uint32_t size = 0;          ///< Total size in bytes (arrays included)
+        uint32_t arrayLength = 1;   ///< Product of all array dimensions
+        bool isPointer = false;     ///< True for pointers (incl. function pointers)
+    };
+
+    /**
+     * @brief Layout of one struct.
+     */
+    struct Struct {
+        std::string name;           ///< Struct type name (e.g. "Mesh")
+        uint32_t size = 0;          ///< Struct size in bytes for this file
+        std::vector<Field> fields;  ///< Members in declaration order
+
+        /**
+         * @brief Find a member by name.
+         * @param fieldName Bare member name (e.g. "totvert")
+         * @return Field, or nullptr if the struct has no such member
+         */
+        const Field* findField(std::string_view fieldName) const;
+    };
+
+    /**
+     * @brief Decode a DNA1 block payload.
+     * @param data Payload bytes (starting with "SDNA")
+     * @param size Payload size in bytes
+     * @param is64bit True if the file uses 8-byte pointers
+     * @param bigEndian True if the file is big-endian
+     * @return Decoded catalogue, or nullptr if the payload is malformed
+     */
+    static std::shared_ptr<const Sdna> decode(const uint8_t* data, size_t size, bool is64bit, bool bigEndian);
+
+    /**
+     * @brief Decode a DNA1 payload, reusing a cached result when possible.
+     *
+     * Thread-safe. The cache key combines the version string, pointer
+     * size, endianness and a hash of the payload bytes.
+     *
+     * @param blenderVersion Version string from the file header (e.g. "4.02")
+     * @param data Payload bytes (starting with "SDNA")
+     * @param size Payload size in bytes
+     * @param is64bit True if the file uses 8-byte pointers
+     * @param bigEndian True if the file is big-endian
+     * @return Decoded catalogue, or nullptr if the payload is malformed
+     */
+    static std::shared_ptr<const Sdna> get(const std::string& blenderVersion,
+                                           const uint8_t* data, size_t size,
+                                           bool is64bit, bool bigEndian);
+
+    /**
+     * @brief Get the number of distinct catalogues currently cached.
+     * @return Cache entry count
+     */
+    static size_t cachedCount();
+
+    /**
+     * @brief Get the struct referenced by a block header's SDNA index.
+     * @param sdnaIndex Index from the block header
+     * @return Struct, or nullptr if out of range
+     */
+    const Struct* structAt(int32_t sdnaIndex) const;
+
+    /**
+     * @brief Find a struct by type name.
+     * @param structName Struct name (e.g. "Mesh")
+     * @return Struct, or nullptr if the file has no such struct
+     */
+    const Struct* findStruct(std::string_view structName) const;
+
+    /**
+     * @brief Find the SDNA index of a struct by type name.
+     * @param structName Struct name (e.g. "PreviewImage")
+     * @return Index usable with block headers, or -1 if not found
+     */
+    int32_t findStructIndex(std::string_view structName) const;
+
+    /**
+     * @brief Get the pointer size of the file this catalogue came from.
+     * @return 4 or 8
+     */
+    uint32_t pointerSize() const { return m_pointerSize; }
+
+    /**
+     * @brief Check the byte order of the file this catalogue came from.
+     * @return true if big-endian
+     */
+    bool isBigEndian() const { return m_bigEndian; }
+
+    /**
+     * @brief Read an integer member from struct data.
+     *
+     * Handles 1, 2, 4 and 8 byte members in the file's byte order.
+     *
+     * @param data Start of the struct in the block payload
+     * @param size Bytes available from @p data
+     * @param field Member to read
+     * @param[out] value Decoded value
+     * @param element Element to read for array members (e.g. 1 for w[1])
+     * @return true if the member lies within @p size and is an integer
+     */
+    bool readInt(const uint8_t* data, size_t size, const Field& field, int64_t& value,
+                 uint32_t element = 0) const;
+
+    /**
+     * @brief Read a float member from struct data.
+     * @param data Start of the struct in the block payload
+     * @param size Bytes available from @p data
+     * @param field Member to read
+     * @param[out] value Decoded value
+     * @param element Element to read for array members (e.g. 2 for co[2])
+     * @return true if the member lies within @p size and is a float
+     */
+    bool readFloat(const uint8_t* data, size_t size, const Field& field, float& value,
+                   uint32_t element = 0) const;
+
+    /**
+     * @brief Read a pointer member from struct data.
+     *
+     * Pointers are the old memory addresses Blender wrote the file with, so
+     * the value is only useful for null checks and matching block addresses.
+     *
+     * @param data Start of the struct in the block payload
+     * @param size Bytes available from @p data
+     * @param field Member to read
+     * @param[out] value Decoded address
+     * @param element Element to read for pointer arrays (e.g. 1 for rect[1])
+     * @return true if the member lies within @p size and is a pointer
+     */
+    bool readPointer(const uint8_t* data, size_t size, const Field& field, uint64_t& value,
+                     uint32_t element = 0) const;
+
+private:
+    std::vector<Struct> m_structs;                          ///< Structs by SDNA index
+    std::unordered_map<std::string, int32_t> m_structIndex; ///< Struct name -> index
+    uint32_t m_pointerSize = 8;
+    bool m_bigEndian = false;
+};
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,114 @@
+#include "storage_device.hpp"
+#include "debug.hpp"
+#include "file_watcher.hpp"
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+constexpr ScanLimits SOLID_STATE_LIMITS{4, 0, 0};
+constexpr ScanLimits ROTATIONAL_LIMITS{1, 2, 2};
+constexpr ScanLimits NETWORK_LIMITS{1, 8, 2};
+
+std::string deviceNumber(dev_t device) {
+    return std::to_string(major(device)) + ":" + std::to_string(minor(device));
+}
+
+/**
+ * @brief Find the server in a network mount source.
+ * @param source "host:/export", "user@host:/path", "//host/share", ...
+ * @return Host, or the whole source if it names none
+ */
+std::string serverOf(const std::string& source) {
+    if (source.compare(0, 2, "//") == 0) {
+        return source.substr(2, source.find('/', 2) - 2);
+    }
+    size_t colon = source.find(':');
+    if (colon == std::string::npos) return source;
+    std::string host = source.substr(0, colon);
+    size_t at = host.rfind('@');
+    return at == std::string::npos ? host : host.substr(at + 1);
+}
+
+/**
+ * @brief Look up the mount source of a device in /proc/self/mountinfo.
+ * @param device st_dev of a path on the mount
+ * @return Source field, or empty if not found
+ */
+std::string mountSource(dev_t device) {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string wanted = deviceNumber(device);
+
+    // ID PARENT MAJOR:MINOR ROOT MOUNTPOINT OPTIONS [OPTIONAL...] - TYPE SOURCE SUPEROPTIONS
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        std::istringstream fields(line);
+        std::string id, parent, majorMinor;
+        fields >> id >> parent >> majorMinor;
+        if (majorMinor != wanted) continue;
+
+        std::string field;
+        while (fields >> field && field != "-") {}
+        std::string type, source;
+        fields >> type >> source;
+        return source;
+    }
+    return {};
+}
+
+bool isRotational(dev_t device) {
+    // Partitions have no queue of their own; their disk's is one level up
+    std::string base = "/sys/dev/block/" + deviceNumber(device);
+    for (const char* queue : {"/queue/rotational", "/../queue/rotational"}) {
+        std::ifstream file(base + queue);
+        int rotational = 0;
+        if (file >> rotational) return rotational != 0;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+StorageDevice StorageDevice::of(const std::filesystem::path& path) {
+    StorageDevice result;
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        result.key = "path:" + path.string();
+        return result;
+    }
+
+    if (FileWatcher::isNetworkFilesystem(path)) {
+        result.kind = Kind::Network;
+        std::string source = mountSource(st.st_dev);
+        result.key = source.empty() ? "dev:" + deviceNumber(st.st_dev) : "net:" + serverOf(source);
+    } else {
+        result.kind = isRotational(st.st_dev) ? Kind::Rotational : Kind::SolidState;
+        result.key = "dev:" + deviceNumber(st.st_dev);
+    }
+
+    DEBUG_LOG("StorageDevice: " << path << " is on " << result.key << " (" << result.kindName() << ")");
+    return result;
+}
+
+ScanLimits StorageDevice::limits() const {
+    switch (kind) {
+        case Kind::Rotational: return ROTATIONAL_LIMITS;
+        case Kind::Network: return NETWORK_LIMITS;
+        default: return SOLID_STATE_LIMITS;
+    }
+}
+
+const char* StorageDevice::kindName() const {
+    switch (kind) {
+        case Kind::Rotational: return "hdd";
+        case Kind::Network: return "network";
+        default: return "ssd";
+    }
+}
+
+} // namespace BlenderFileFinder
@@ -0,0 +1,77 @@
+/**
+ * @file storage_device.hpp
+ * @brief Which device a path lives on, and how hard to read from it.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief How many readers a scan may put on one device.
+ */
+struct ScanLimits {
+    unsigned scans = 1;             ///< Locations on the device scanned at once
+    unsigned walkConcurrency = 0;   ///< Directories listed in parallel per scan (0 = walker default)
+    unsigned parseThreads = 0;      ///< Files parsed in parallel per scan (0 = hardware concurrency)
+};
+
+/**
+ * @brief The storage behind a path, for scheduling scans.
+ *
+ * Local locations are grouped by st_dev, i.e. by filesystem. Network
+ * mounts are grouped by server, taken from the mount source in
+ * /proc/self/mountinfo ("nas:/export", "//nas/share"), so two shares of
+ * the same NAS count as one device.
+ *
+ * Local block devices report whether they are rotational in
+ * /sys/dev/block/MAJOR:MINOR/queue/rotational. Filesystems without a
+ * single block device (btrfs, tmpfs, overlays) count as solid state.
+ *
+ * @par Usage Example:
+ * @code
+ * StorageDevice device = StorageDevice::of(location.path);
+ * ScanLimits limits = device.limits();
+ * scanner.setWalkConcurrency(limits.walkConcurrency);
+ * @endcode
+ */
+struct StorageDevice {
+    enum class Kind {
+        SolidState,     ///< SSD, NVMe, or unknown local storage
+        Rotational,     ///< Spinning disk: seeks are expensive
+        Network         ///< NFS, SMB, FUSE, ...: every request is a round trip
+    };
+
+    std::string key;                ///< Equal for paths on the same device
+    Kind kind = Kind::SolidState;
+
+    /**
+     * @brief Find the device a path is stored on.
+     * @param path Existing path
+     * @return Device; paths that can't be stat()ed get a key of their own
+     */
+    static StorageDevice of(const std::filesystem::path& path);
+
+    /**
+     * @brief Get the scan limits for this kind of device.
+     *
+     * Solid state takes several scans with many readers each. Spinning
+     * disks and network servers get one scan with two parse readers, so
+     * heads and servers aren't thrashed; network scans still list many
+     * directories at once to hide latency.
+     *
+     * @return Limits for scans of locations on this device
+     */
+    ScanLimits limits() const;
+
+    /**
+     * @brief Get a short name for the kind, for logs.
+     * @return "ssd", "hdd" or "network"
+     */
+    const char* kindName() const;
+};
+
+} // namespace BlenderFileFinder
@@ -8,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <utility>
 
 namespace BlenderFileFinder {
 
@@ -173,65 +174,93 @@ void ThumbnailCache::loadThread() {
             continue;
         }
 
+        // Fill a recycled buffer; it goes back to the pool after upload
         LoadRequest request;
-        request.path = pathToLoad;
+        request.thumbnail.pixels = m_pixelPool.acquire();
 
         // First, try loading from disk cache (much faster than parsing .blend)
-        auto cachedThumb = loadFromDiskCache(pathToLoad);
-
-        if (cachedThumb) {
+        if (loadFromDiskCache(pathToLoad, request.thumbnail)) {
             // Cache hit - use cached thumbnail (may be empty marker for files without thumbnails)
-            request.thumbnail = std::move(*cachedThumb);
         } else {
             // Cache miss - check if file is accessible first
             std::error_code ec;
-            bool fileExists = std::filesystem::exists(pathToLoad, ec);
+            auto modTime = std::filesystem::last_write_time(pathToLoad, ec);
+            bool fileExists = !ec;
+            int64_t modTimeCount = fileExists ? modTime.time_since_epoch().count() : 0;
+
+            bool knownWithoutThumbnail = false;
+            if (fileExists) {
+                std::lock_guard<std::mutex> lock(m_noThumbnailMutex);
+                auto known = m_noThumbnailFiles.find(pathToLoad.string());
+                knownWithoutThumbnail = known != m_noThumbnailFiles.end() && known->second == modTimeCount;
+            }
 
-            if (!fileExists || ec) {
-                // File doesn't exist or is inaccessible - don't keep retrying
+            if (!fileExists || knownWithoutThumbnail) {
+                // File is inaccessible, or known to have no thumbnail at this
+                // mtime - don't keep retrying
                 request.thumbnail.width = 0;
                 request.thumbnail.height = 0;
+                request.thumbnail.pixels.clear();
                 // Save empty marker so we don't retry this file
                 saveToDiskCache(pathToLoad, request.thumbnail);
             } else {
-                // Parse file and extract thumbnail
+                // Map the file and read the thumbnail in place (compressed
+                // files are decompressed only up to the TEST block)
                 auto parseStart = std::chrono::steady_clock::now();
-                auto info = BlendParser::parseQuick(pathToLoad);
+                bool noEmbeddedThumbnail = false;
+                bool hasThumbnail = BlendParser::readThumbnail(pathToLoad, request.thumbnail, &noEmbeddedThumbnail);
                 auto parseMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::steady_clock::now() - parseStart).count();
 
                 // Log all parses that take > 50ms (could indicate I/O issues)
                 if (parseMs > 50) {
-                    DEBUG_LOG("Slow parseQuick: " << pathToLoad.filename() << " took " << parseMs << "ms (thread)");
+                    DEBUG_LOG("Slow readThumbnail: " << pathToLoad.filename() << " took " << parseMs << "ms (thread)");
                 }
 
-                if (info && info->thumbnail) {
-                    request.thumbnail = std::move(*info->thumbnail);
-                } else {
+                if (!hasThumbnail) {
                     // No thumbnail in file - create an empty thumbnail marker
                     request.thumbnail.width = 0;
                     request.thumbnail.height = 0;
+                    request.thumbnail.pixels.clear();
+                }
+
+                if (noEmbeddedThumbnail) {
+                    std::lock_guard<std::mutex> lock(m_noThumbnailMutex);
+                    m_noThumbnailFiles[pathToLoad.string()] = modTimeCount;
+                    m_noThumbnailResults.emplace_back(pathToLoad, modTimeCount);
                 }
                 // Save to disk cache (including empty markers for files without thumbnails)
                 saveToDiskCache(pathToLoad, request.thumbnail);
             }
         }
 
+        request.path = std::move(pathToLoad);
+
         std::lock_guard<std::mutex> lock(m_loadedMutex);
-        m_loadedQueue.push(std::move(request));
+        m_loadedQueue.push_back(std::move(request));
     }
 }
 
+void ThumbnailCache::setNoThumbnailFiles(std::unordered_map<std::string, int64_t> files) {
+    std::lock_guard<std::mutex> lock(m_noThumbnailMutex);
+    m_noThumbnailFiles = std::move(files);
+}
+
+std::vector<std::pair<std::filesystem::path, int64_t>> ThumbnailCache::takeNoThumbnailResults() {
+    std::lock_guard<std::mutex> lock(m_noThumbnailMutex);
+    return std::exchange(m_noThumbnailResults, {});
+}
+
 void ThumbnailCache::processLoadedThumbnails() {
     // Extract all pending requests under the lock, then process without holding it
-    // This avoids lock order issues with loadThread() which acquires m_queueMutex first
-    std::queue<LoadRequest> toProcess;
+    // This avoids lock order issues with loadThread() which acquires m_queueMutex first.
+    // Swapping the two vectors keeps both their capacities, so no allocation here.
     {
         std::lock_guard<std::mutex> lock(m_loadedMutex);
-        std::swap(toProcess, m_loadedQueue);
+        std::swap(m_uploadQueue, m_loadedQueue);
     }
 
-    if (toProcess.empty()) {
+    if (m_uploadQueue.empty()) {
         return;
     }
 
@@ -239,8 +268,7 @@ void ThumbnailCache::processLoadedThumbnails() {
     auto processStart = std::chrono::steady_clock::now();
     std::vector<std::string> processedKeys;  // Track keys to update in m_loadingSet
 
-    while (!toProcess.empty()) {
-        auto& request = toProcess.front();
+    for (auto& request : m_uploadQueue) {
         std::string key = request.path.string();
 
         uint32_t textureId;
@@ -261,6 +289,9 @@ void ThumbnailCache::processLoadedThumbnails() {
         }
         processedCount++;
 
+        // The GPU has its copy now; hand the pixels back for the next load
+        m_pixelPool.release(std::move(request.thumbnail.pixels));
+
         // Check if already in cache (shouldn't happen, but safeguard)
         auto existingIt = m_cacheMap.find(key);
         if (existingIt != m_cacheMap.end()) {
@@ -270,19 +301,16 @@ void ThumbnailCache::processLoadedThumbnails() {
             if (existingIsReal && !newIsReal) {
                 // Don't overwrite a real thumbnail with placeholder - skip
                 processedKeys.push_back(key);
-                toProcess.pop();
                 continue;
             }
             if (existingIsReal && newIsReal) {
                 // Both real - keep existing, skip new
                 processedKeys.push_back(key);
-                toProcess.pop();
                 continue;
             }
             if (!existingIsReal && !newIsReal) {
                 // Both placeholder - skip
                 processedKeys.push_back(key);
-                toProcess.pop();
                 continue;
             }
             // Existing is placeholder, new is real - remove old entry to replace
@@ -305,8 +333,8 @@ void ThumbnailCache::processLoadedThumbnails() {
         m_totalLoaded++;
 
         processedKeys.push_back(key);
-        toProcess.pop();
     }
+    m_uploadQueue.clear();  // Keeps capacity for the next frame
 
     // Update loading set and recently loaded map (separate lock acquisition)
     // This ensures consistent lock ordering: never hold m_loadedMutex while acquiring m_queueMutex
@@ -420,19 +448,19 @@ std::filesystem::path ThumbnailCache::getDiskCachePath(const std::filesystem::pa
     return m_diskCacheDir / ss.str();
 }
 
-std::optional<BlendThumbnail> ThumbnailCache::loadFromDiskCache(const std::filesystem::path& blendFile) {
+bool ThumbnailCache::loadFromDiskCache(const std::filesystem::path& blendFile, BlendThumbnail& thumb) {
     std::filesystem::path cachePath = getDiskCachePath(blendFile);
 
     std::ifstream file(cachePath, std::ios::binary);
     if (!file) {
-        return std::nullopt;  // Cache miss
+        return false;  // Cache miss
     }
 
     // Read and verify magic bytes
     char magic[4];
     file.read(magic, 4);
     if (!file || std::memcmp(magic, "BFFT", 4) != 0) {
-        return std::nullopt;  // Invalid cache file
+        return false;  // Invalid cache file
     }
 
     // Read version
@@ -440,14 +468,14 @@ std::optional<BlendThumbnail> ThumbnailCache::loadFromDiskCache(const std::files
     file.read(reinterpret_cast<char*>(&version), sizeof(version));
     if (!file || version != 2) {
         // Version 1 didn't have mod time - invalidate old cache
-        return std::nullopt;
+        return false;
     }
 
     // Read stored modification time
     int64_t storedModTime;
     file.read(reinterpret_cast<char*>(&storedModTime), sizeof(storedModTime));
     if (!file) {
-        return std::nullopt;
+        return false;
     }
 
     // Check if source file has been modified (cache invalidation)
@@ -458,7 +486,7 @@ std::optional<BlendThumbnail> ThumbnailCache::loadFromDiskCache(const std::files
         if (!ec) {
             int64_t currentModTimeCount = currentModTime.time_since_epoch().count();
             if (currentModTimeCount != storedModTime) {
-                return std::nullopt;  // Source file changed, cache invalid
+                return false;  // Source file changed, cache invalid
             }
         }
         // If we can't get current mod time, use cached version anyway
@@ -469,25 +497,25 @@ std::optional<BlendThumbnail> ThumbnailCache::loadFromDiskCache(const std::files
     file.read(reinterpret_cast<char*>(&width), sizeof(width));
     file.read(reinterpret_cast<char*>(&height), sizeof(height));
     if (!file || width > 4096 || height > 4096) {
-        return std::nullopt;  // Invalid dimensions
+        return false;  // Invalid dimensions
     }
 
     // Handle "no thumbnail" marker (width=0, height=0)
-    BlendThumbnail thumb;
     thumb.width = static_cast<int>(width);
     thumb.height = static_cast<int>(height);
 
+    thumb.pixels.clear();
     if (width > 0 && height > 0) {
-        // Read pixel data
-        thumb.pixels.resize(width * height * 4);
+        // Read pixel data (into the caller's buffer, reusing its capacity)
+        thumb.pixels.resize(static_cast<size_t>(width) * height * 4);
         file.read(reinterpret_cast<char*>(thumb.pixels.data()), thumb.pixels.size());
 
         if (!file) {
-            return std::nullopt;  // Incomplete read
+            return false;  // Incomplete read
         }
     }
 
-    return thumb;
+    return true;
 }
 
 void ThumbnailCache::saveToDiskCache(const std::filesystem::path& blendFile, const BlendThumbnail& thumbnail) {
@@ -526,4 +554,137 @@ void ThumbnailCache::saveToDiskCache(const std::filesystem::path& blendFile, con
     }
 }
 
+std::vector<BlendPreview> ThumbnailCache::getDatablockPreviews(const std::filesystem::path& path) {
+    std::vector<BlendPreview> previews;
+    if (loadPreviewsFromDiskCache(path, previews)) {
+        return previews;
+    }
+
+    auto info = BlendParser::parseFull(path, BlendParser::ParseMode::Mapped, &previews);
+    if (!info) {
+        return {};
+    }
+
+    savePreviewsToDiskCache(path, info->modifiedTime.time_since_epoch().count(), previews);
+    return previews;
+}
+
+bool ThumbnailCache::loadPreviewsFromDiskCache(const std::filesystem::path& blendFile,
+                                               std::vector<BlendPreview>& previews) {
+    std::filesystem::path cachePath = getDiskCachePath(blendFile).replace_extension(".prev");
+
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file) {
+        return false;  // Cache miss
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    int64_t storedModTime = 0;
+    uint32_t count = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&storedModTime), sizeof(storedModTime));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, "BFFP", 4) != 0 || version != 1 || count > 100000) {
+        return false;
+    }
+
+    // Unlike file thumbnails, previews are only written after a successful
+    // parse, so the stored time is always real
+    std::error_code ec;
+    auto currentModTime = std::filesystem::last_write_time(blendFile, ec);
+    if (!ec && currentModTime.time_since_epoch().count() != storedModTime) {
+        return false;  // Source file changed, cache invalid
+    }
+
+    previews.clear();
+    previews.resize(count);
+    for (auto& preview : previews) {
+        char type[2];
+        uint8_t isAsset = 0;
+        uint16_t nameLength = 0;
+        file.read(type, 2);
+        file.read(reinterpret_cast<char*>(&isAsset), sizeof(isAsset));
+        file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        if (!file) return false;
+
+        preview.type.assign(type, 2);
+        preview.isAsset = isAsset != 0;
+        preview.name.resize(nameLength);
+        file.read(preview.name.data(), nameLength);
+
+        uint32_t width = 0, height = 0;
+        file.read(reinterpret_cast<char*>(&width), sizeof(width));
+        file.read(reinterpret_cast<char*>(&height), sizeof(height));
+        if (!file || width > 1024 || height > 1024) {
+            return false;
+        }
+
+        preview.image.width = static_cast<int>(width);
+        preview.image.height = static_cast<int>(height);
+        preview.image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        file.read(reinterpret_cast<char*>(preview.image.pixels.data()), preview.image.pixels.size());
+        if (!file) return false;
+    }
+
+    return true;
+}
+
+void ThumbnailCache::savePreviewsToDiskCache(const std::filesystem::path& blendFile, int64_t modifiedTime,
+                                             const std::vector<BlendPreview>& previews) {
+    std::filesystem::path cachePath = getDiskCachePath(blendFile).replace_extension(".prev");
+
+    // Written under a unique name and renamed into place, since readers
+    // don't lock and parses of the same file may run at once
+    std::filesystem::path tempPath = cachePath;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return;  // Can't write cache
+    }
+
+    // Layout: "BFFP", version, source mod time, entry count, then per entry
+    // type[2], isAsset, name length, name, width, height, pixels
+    file.write("BFFP", 4);
+    uint32_t version = 1;
+    uint32_t count = static_cast<uint32_t>(previews.size());
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&modifiedTime), sizeof(modifiedTime));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    for (const auto& preview : previews) {
+        uint8_t isAsset = preview.isAsset ? 1 : 0;
+        uint16_t nameLength = static_cast<uint16_t>(std::min<size_t>(preview.name.size(), UINT16_MAX));
+        file.write(preview.type.data(), 2);
+        file.write(reinterpret_cast<const char*>(&isAsset), sizeof(isAsset));
+        file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        file.write(preview.name.data(), nameLength);
+
+        uint32_t width = static_cast<uint32_t>(std::max(0, preview.image.width));
+        uint32_t height = static_cast<uint32_t>(std::max(0, preview.image.height));
+        if (preview.image.pixels.size() != static_cast<size_t>(width) * height * 4) {
+            width = height = 0;
+        }
+        file.write(reinterpret_cast<const char*>(&width), sizeof(width));
+        file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+        if (width > 0 && height > 0) {
+            file.write(reinterpret_cast<const char*>(preview.image.pixels.data()), preview.image.pixels.size());
+        }
+    }
+
+    file.close();
+    std::error_code ec;
+    if (!file) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        DEBUG_LOG("Failed to store datablock previews: " << ec.message());
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
 } // namespace BlenderFileFinder
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "blend_parser.hpp"
+#include "pixel_buffer_pool.hpp"
 #include <cstdint>
 #include <filesystem>
 #include <list>
@@ -31,6 +32,8 @@ namespace BlenderFileFinder {
  * - Parallel background loading (4 threads by default)
  * - Thread-safe operations
  * - Automatic placeholder texture for loading/missing thumbnails
+ * - Pixel buffers recycled through a PixelBufferPool once uploaded, so
+ *   steady-state loading doesn't allocate pixel memory
  *
  * @par Usage Pattern:
  * @code
@@ -117,6 +120,53 @@ public:
      */
     bool isLoadingThumbnails() const;
 
+    /**
+     * @brief Set files already known to have no embedded thumbnail.
+     *
+     * Loader threads skip parsing files in the map whose modification time
+     * still matches. Thread-safe.
+     *
+     * @param files Map of path to modification time (file_time_type ticks)
+     */
+    void setNoThumbnailFiles(std::unordered_map<std::string, int64_t> files);
+
+    /**
+     * @brief Take the files the loader threads found to have no thumbnail.
+     *
+     * Returns and clears the list, for recording in the database.
+     *
+     * @return Pairs of (path, modification time the file was read at)
+     */
+    std::vector<std::pair<std::filesystem::path, int64_t>> takeNoThumbnailResults();
+
+    /**
+     * @brief Get the previews of a file's datablocks, and its assets.
+     *
+     * Returned from the disk cache when the file hasn't changed since they
+     * were cached, so browsing materials or assets across a library only
+     * parses each file once. Otherwise the file is fully parsed (see
+     * BlendParser::parseFull) and the result cached.
+     *
+     * Blocking; call from a worker thread. Thread-safe.
+     *
+     * @param path Path to the .blend file
+     * @return Datablocks with a preview or marked as assets, in file order
+     */
+    std::vector<BlendPreview> getDatablockPreviews(const std::filesystem::path& path);
+
+    /**
+     * @brief Cache previews read elsewhere, e.g. by a scan that indexes datablocks.
+     *
+     * getDatablockPreviews() then returns them without parsing the file
+     * while it is unchanged. Thread-safe.
+     *
+     * @param blendFile Path to the .blend file
+     * @param modifiedTime Modification time of the file the previews were read from
+     * @param previews The file's datablocks with a preview or marked as assets
+     */
+    void savePreviewsToDiskCache(const std::filesystem::path& blendFile, int64_t modifiedTime,
+                                 const std::vector<BlendPreview>& previews);
+
 private:
     /**
      * @brief Cache entry storing a texture and its source path.
@@ -142,8 +192,9 @@ private:
     // Disk cache methods
     void initDiskCache();
     std::filesystem::path getDiskCachePath(const std::filesystem::path& blendFile) const;
-    std::optional<BlendThumbnail> loadFromDiskCache(const std::filesystem::path& blendFile);
+    bool loadFromDiskCache(const std::filesystem::path& blendFile, BlendThumbnail& thumbnail);
     void saveToDiskCache(const std::filesystem::path& blendFile, const BlendThumbnail& thumbnail);
+    bool loadPreviewsFromDiskCache(const std::filesystem::path& blendFile, std::vector<BlendPreview>& previews);
 
     size_t m_maxCacheSize;              ///< Maximum cache capacity
 
@@ -164,7 +215,9 @@ private:
     /// @name Loaded Results
     /// @{
     std::mutex m_loadedMutex;                   ///< Protects loaded queue
-    std::queue<LoadRequest> m_loadedQueue;     ///< Thumbnails ready for GPU
+    std::vector<LoadRequest> m_loadedQueue;     ///< Thumbnails ready for GPU
+    std::vector<LoadRequest> m_uploadQueue;     ///< Main thread's batch, swapped with m_loadedQueue
+    PixelBufferPool m_pixelPool;                ///< Buffers returned after upload
     /// @}
 
     /// @name Background Threads
@@ -187,6 +240,14 @@ private:
     std::filesystem::path m_diskCacheDir;       ///< Directory for cached thumbnails
     /// @}
 
+    /// @name Files Without Thumbnails
+    /// Known from the database, and newly found by the loader threads
+    /// @{
+    std::mutex m_noThumbnailMutex;              ///< Protects both members below
+    std::unordered_map<std::string, int64_t> m_noThumbnailFiles;
+    std::vector<std::pair<std::filesystem::path, int64_t>> m_noThumbnailResults;
+    /// @}
+
     /// @name Anti-Thrashing
     /// Recently loaded items that shouldn't be re-requested immediately after eviction
     /// @{
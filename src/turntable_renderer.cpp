@@ -0,0 +1,318 @@
+#include "turntable_renderer.hpp"
+#include "debug.hpp"
+#include "png_writer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace BlenderFileFinder {
+
+namespace {
+
+// Blender's default camera: 50 mm lens on a 36 mm sensor
+constexpr float HALF_FOV_TAN = 18.0f / 50.0f;
+
+// Same framing as turntable_render.py
+constexpr float CAMERA_DISTANCE = 2.5f;     // Times the object size
+constexpr float CAMERA_HEIGHT = 0.5f;       // Times the camera distance
+constexpr float MIN_OBJECT_SIZE = 0.1f;
+
+// Neutral grey material lit by a key light from (1, 1, 2) and a weaker
+// fill from (-1, -1, 1), like the sun and area light of the script
+constexpr float ALBEDO = 0.8f;
+constexpr float AMBIENT = 0.12f;
+constexpr float KEY_STRENGTH = 0.75f;
+constexpr float FILL_STRENGTH = 0.25f;
+
+constexpr float PI = 3.14159265358979f;
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+};
+
+Vec3 operator-(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+Vec3 normalize(const Vec3& v) {
+    float length = std::sqrt(dot(v, v));
+    return length > 0 ? Vec3{v.x / length, v.y / length, v.z / length} : v;
+}
+
+Vec3 vertex(const SceneMesh& mesh, uint32_t index) {
+    const float* p = &mesh.positions[static_cast<size_t>(index) * 3];
+    return {p[0], p[1], p[2]};
+}
+
+uint8_t shadeValue(const Vec3& normal) {
+    static const Vec3 key = normalize({1, 1, 2});
+    static const Vec3 fill = normalize({-1, -1, 1});
+    float light = AMBIENT + KEY_STRENGTH * std::max(0.0f, dot(normal, key)) +
+                  FILL_STRENGTH * std::max(0.0f, dot(normal, fill));
+    float linear = std::min(1.0f, ALBEDO * light);
+    return static_cast<uint8_t>(std::pow(linear, 1.0f / 2.2f) * 255.0f + 0.5f);
+}
+
+/**
+ * @brief Object shown in the preview, with per-triangle shading precomputed.
+ *
+ * The lights don't move with the camera, so each face has one shade per
+ * side for the whole turntable.
+ */
+struct FeaturedObject {
+    const SceneMesh* mesh = nullptr;
+    Vec3 center;
+    float size = 0;
+    std::vector<Vec3> normals;          ///< Per triangle
+    std::vector<uint8_t> frontShade;    ///< Per triangle, seen from the normal's side
+    std::vector<uint8_t> backShade;     ///< Per triangle, seen from behind
+};
+
+FeaturedObject prepare(const SceneMesh& mesh) {
+    FeaturedObject object;
+    object.mesh = &mesh;
+    object.center = {(mesh.boundsMin[0] + mesh.boundsMax[0]) * 0.5f, (mesh.boundsMin[1] + mesh.boundsMax[1]) * 0.5f,
+                     (mesh.boundsMin[2] + mesh.boundsMax[2]) * 0.5f};
+    Vec3 extent = {mesh.boundsMax[0] - mesh.boundsMin[0], mesh.boundsMax[1] - mesh.boundsMin[1],
+                   mesh.boundsMax[2] - mesh.boundsMin[2]};
+    object.size = std::max(std::sqrt(dot(extent, extent)), MIN_OBJECT_SIZE);
+
+    size_t triangleCount = mesh.triangles.size() / 3;
+    object.normals.resize(triangleCount);
+    object.frontShade.resize(triangleCount);
+    object.backShade.resize(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        Vec3 a = vertex(mesh, mesh.triangles[t * 3]);
+        Vec3 b = vertex(mesh, mesh.triangles[t * 3 + 1]);
+        Vec3 c = vertex(mesh, mesh.triangles[t * 3 + 2]);
+        Vec3 n = normalize(cross(b - a, c - a));
+        object.normals[t] = n;
+        object.frontShade[t] = shadeValue(n);
+        object.backShade[t] = shadeValue({-n.x, -n.y, -n.z});
+    }
+    return object;
+}
+
+/**
+ * @brief One output frame: which object, from which angle.
+ */
+struct FrameJob {
+    size_t object = 0;
+    float angle = 0;
+    int index = 0;
+};
+
+/**
+ * @brief Per-thread buffers, reused across frames.
+ */
+struct RenderTarget {
+    int size = 0;                       ///< Samples per side
+    std::vector<float> depth;           ///< 1/z of the nearest surface, 0 if empty
+    std::vector<uint8_t> shade;         ///< Grey value of the nearest surface
+    std::vector<float> screenX;         ///< Projected vertices of the current frame
+    std::vector<float> screenY;
+    std::vector<float> inverseZ;
+    std::vector<uint8_t> rgba;          ///< Resolved frame
+};
+
+void rasterize(RenderTarget& target, float x0, float y0, float z0, float x1, float y1, float z1,
+               float x2, float y2, float z2, uint8_t shade) {
+    float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (std::fabs(area) < 1e-12f) return;
+
+    // Make the edge functions positive inside regardless of winding
+    float sign = area > 0 ? 1.0f : -1.0f;
+    float inverseArea = 1.0f / std::fabs(area);
+
+    int size = target.size;
+    int minX = std::max(0, static_cast<int>(std::floor(std::min({x0, x1, x2}) - 0.5f)));
+    int maxX = std::min(size - 1, static_cast<int>(std::ceil(std::max({x0, x1, x2}) - 0.5f)));
+    int minY = std::max(0, static_cast<int>(std::floor(std::min({y0, y1, y2}) - 0.5f)));
+    int maxY = std::min(size - 1, static_cast<int>(std::ceil(std::max({y0, y1, y2}) - 0.5f)));
+    if (minX > maxX || minY > maxY) return;
+
+    // Edge function of (a, b) at p: (b - a) x (p - a); steps are constant per pixel
+    auto edge = [](float ax, float ay, float bx, float by, float px, float py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    };
+    float stepX0 = -(y2 - y1) * sign, stepY0 = (x2 - x1) * sign;
+    float stepX1 = -(y0 - y2) * sign, stepY1 = (x0 - x2) * sign;
+    float stepX2 = -(y1 - y0) * sign, stepY2 = (x1 - x0) * sign;
+
+    float startX = minX + 0.5f;
+    float startY = minY + 0.5f;
+    float row0 = edge(x1, y1, x2, y2, startX, startY) * sign;
+    float row1 = edge(x2, y2, x0, y0, startX, startY) * sign;
+    float row2 = edge(x0, y0, x1, y1, startX, startY) * sign;
+
+    for (int y = minY; y <= maxY; ++y) {
+        float w0 = row0, w1 = row1, w2 = row2;
+        size_t index = static_cast<size_t>(y) * size + minX;
+        for (int x = minX; x <= maxX; ++x, ++index) {
+            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
+                // 1/z is linear in screen space
+                float z = (w0 * z0 + w1 * z1 + w2 * z2) * inverseArea;
+                if (z > target.depth[index]) {
+                    target.depth[index] = z;
+                    target.shade[index] = shade;
+                }
+            }
+            w0 += stepX0;
+            w1 += stepX1;
+            w2 += stepX2;
+        }
+        row0 += stepY0;
+        row1 += stepY1;
+        row2 += stepY2;
+    }
+}
+
+void renderFrame(const FeaturedObject& object, float angle, const TurntableRenderer::Settings& settings,
+                 RenderTarget& target) {
+    const SceneMesh& mesh = *object.mesh;
+    int samples = std::max(1, settings.supersampling);
+    int size = settings.resolution * samples;
+    size_t sampleCount = static_cast<size_t>(size) * size;
+
+    target.size = size;
+    target.depth.assign(sampleCount, 0.0f);
+    target.shade.resize(sampleCount);
+
+    // Camera circles the object's center around world Z, looking at it
+    float distance = object.size * CAMERA_DISTANCE;
+    Vec3 camera = {object.center.x + distance * std::cos(angle), object.center.y + distance * std::sin(angle),
+                   object.center.z + distance * CAMERA_HEIGHT};
+    Vec3 forward = normalize(object.center - camera);
+    Vec3 right = normalize(cross(forward, {0, 0, 1}));
+    Vec3 up = cross(right, forward);
+
+    float half = size * 0.5f;
+    float scale = half / HALF_FOV_TAN;
+    float nearClip = object.size * 0.01f;
+
+    size_t vertexCount = mesh.positions.size() / 3;
+    target.screenX.resize(vertexCount);
+    target.screenY.resize(vertexCount);
+    target.inverseZ.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        Vec3 v = vertex(mesh, static_cast<uint32_t>(i)) - camera;
+        float z = dot(v, forward);
+        if (z < nearClip) {
+            target.inverseZ[i] = -1.0f;
+            continue;
+        }
+        target.inverseZ[i] = 1.0f / z;
+        target.screenX[i] = half + dot(v, right) * target.inverseZ[i] * scale;
+        target.screenY[i] = half - dot(v, up) * target.inverseZ[i] * scale;
+    }
+
+    const auto& tris = mesh.triangles;
+    for (size_t t = 0; t * 3 + 2 < tris.size(); ++t) {
+        uint32_t a = tris[t * 3], b = tris[t * 3 + 1], c = tris[t * 3 + 2];
+        if (target.inverseZ[a] <= 0 || target.inverseZ[b] <= 0 || target.inverseZ[c] <= 0) continue;
+
+        bool facing = dot(object.normals[t], camera - vertex(mesh, a)) >= 0;
+        rasterize(target, target.screenX[a], target.screenY[a], target.inverseZ[a],
+                  target.screenX[b], target.screenY[b], target.inverseZ[b],
+                  target.screenX[c], target.screenY[c], target.inverseZ[c],
+                  facing ? object.frontShade[t] : object.backShade[t]);
+    }
+
+    // Average each pixel's samples; uncovered samples are transparent
+    int resolution = settings.resolution;
+    target.rgba.assign(static_cast<size_t>(resolution) * resolution * 4, 0);
+    for (int py = 0; py < resolution; ++py) {
+        for (int px = 0; px < resolution; ++px) {
+            int covered = 0;
+            int sum = 0;
+            for (int sy = 0; sy < samples; ++sy) {
+                size_t row = static_cast<size_t>(py * samples + sy) * size + px * samples;
+                for (int sx = 0; sx < samples; ++sx) {
+                    if (target.depth[row + sx] > 0) {
+                        ++covered;
+                        sum += target.shade[row + sx];
+                    }
+                }
+            }
+            if (covered == 0) continue;
+
+            uint8_t* out = &target.rgba[(static_cast<size_t>(py) * resolution + px) * 4];
+            uint8_t grey = static_cast<uint8_t>(sum / covered);
+            out[0] = out[1] = out[2] = grey;
+            out[3] = static_cast<uint8_t>(covered * 255 / (samples * samples));
+        }
+    }
+}
+
+} // anonymous namespace
+
+int TurntableRenderer::render(const std::vector<SceneMesh>& meshes, const std::filesystem::path& outputDir,
+                              const Settings& settings) {
+    if (settings.frameCount <= 0 || settings.resolution <= 0) return 0;
+
+    // Largest objects first, like turntable_render.py
+    std::vector<FeaturedObject> featured;
+    for (const auto& mesh : meshes) {
+        if (!mesh.triangles.empty()) featured.push_back(prepare(mesh));
+    }
+    if (featured.empty()) return 0;
+
+    std::stable_sort(featured.begin(), featured.end(),
+                     [](const FeaturedObject& a, const FeaturedObject& b) { return a.size > b.size; });
+    featured.resize(std::min(featured.size(), static_cast<size_t>(std::max(1, settings.maxFeaturedObjects))));
+
+    int framesPerObject = std::max(1, settings.frameCount / static_cast<int>(featured.size()));
+    std::vector<FrameJob> jobs;
+    for (size_t o = 0; o < featured.size() && static_cast<int>(jobs.size()) < settings.frameCount; ++o) {
+        for (int i = 0; i < framesPerObject && static_cast<int>(jobs.size()) < settings.frameCount; ++i) {
+            jobs.push_back({o, 2.0f * PI * i / framesPerObject, static_cast<int>(jobs.size())});
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+
+    std::atomic<size_t> nextJob{0};
+    std::atomic<int> written{0};
+    auto worker = [&]() {
+        RenderTarget target;
+        for (size_t j = nextJob++; j < jobs.size(); j = nextJob++) {
+            const FrameJob& job = jobs[j];
+            renderFrame(featured[job.object], job.angle, settings, target);
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%03d.png", job.index);
+            if (PngWriter::write(outputDir / name, settings.resolution, settings.resolution, target.rgba.data())) {
+                ++written;
+            }
+        }
+    };
+
+    unsigned threadCount = settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(jobs.size()));
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    return written.load();
+}
+
+bool TurntableRenderer::renderFile(const std::filesystem::path& blendFile, const std::filesystem::path& outputDir,
+                                   const Settings& settings) {
+    auto meshes = BlendScene::readMeshObjects(blendFile);
+    if (!meshes || meshes->empty()) {
+        DEBUG_LOG("TurntableRenderer: no mesh objects in " << blendFile.filename());
+        return false;
+    }
+
+    int frames = render(*meshes, outputDir, settings);
+    DEBUG_LOG("TurntableRenderer: " << frames << " frames of " << blendFile.filename());
+    return frames > 0;
+}
+
+} // namespace BlenderFileFinder
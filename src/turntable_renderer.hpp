@@ -0,0 +1,72 @@
+/**
+ * @file turntable_renderer.hpp
+ * @brief Software rasterizer for turntable previews.
+ */
+
+#pragma once
+
+#include "blend_scene.hpp"
+#include <filesystem>
+#include <vector>
+
+namespace BlenderFileFinder {
+
+/**
+ * @brief Renders turntable preview frames on the CPU, without Blender.
+ *
+ * Produces the same output as resources/turntable_render.py: the largest
+ * mesh objects are shown one after another, each alone, with the camera
+ * circling it at 2.5x its size and half that height, on a transparent
+ * background. Frames are written as frame_000.png, frame_001.png, ... so
+ * PreviewCache loads them like the Blender-rendered ones.
+ *
+ * Geometry comes from BlendScene (base meshes, no modifiers) and is
+ * drawn flat shaded with a z-buffer, supersampled for anti-aliasing.
+ * Frames are independent and rendered in parallel.
+ *
+ * @par Usage Example:
+ * @code
+ * TurntableRenderer::Settings settings;
+ * settings.frameCount = 144;
+ * settings.resolution = 128;
+ * TurntableRenderer::renderFile("model.blend", previewDir, settings);
+ * @endcode
+ */
+class TurntableRenderer {
+public:
+    /**
+     * @brief Output and quality settings.
+     */
+    struct Settings {
+        int frameCount = 144;           ///< Total frames across all featured objects
+        int resolution = 128;           ///< Square frame size in pixels
+        int supersampling = 2;          ///< Samples per pixel along each axis
+        int maxFeaturedObjects = 5;     ///< Largest objects to show, one after another
+        unsigned threads = 0;           ///< Render threads (0 = hardware concurrency)
+    };
+
+    /**
+     * @brief Render frames of already loaded meshes.
+     * @param meshes World-space mesh objects
+     * @param outputDir Directory for the frame PNGs (created if missing)
+     * @param settings Output settings
+     * @return Number of frames written (0 if there was nothing to render)
+     */
+    static int render(const std::vector<SceneMesh>& meshes, const std::filesystem::path& outputDir,
+                      const Settings& settings);
+
+    /**
+     * @brief Read a .blend file's meshes and render its frames.
+     *
+     * Blocking; call from a worker thread.
+     *
+     * @param blendFile Path to the .blend file
+     * @param outputDir Directory for the frame PNGs (created if missing)
+     * @param settings Output settings
+     * @return true if at least one frame was written
+     */
+    static bool renderFile(const std::filesystem::path& blendFile, const std::filesystem::path& outputDir,
+                           const Settings& settings);
+};
+
+} // namespace BlenderFileFinder
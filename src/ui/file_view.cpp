@@ -37,6 +37,11 @@ bool FileView::matchesFilterWithTags(const BlendFileInfo& file, const std::strin
         return true;
     }
 
+    // Then check datablock names (objects, materials, ...)
+    if (m_datablockMatches.count(file.path)) {
+        return true;
+    }
+
     // Then check tags
     if (m_database) {
         const auto& tags = getCachedTags(file.path);
@@ -89,6 +94,22 @@ bool FileView::matchesTagFilter(const BlendFileInfo& file) const {
     return std::find(tags.begin(), tags.end(), m_tagFilter) != tags.end();
 }
 
+const BlendFileInfo* FileView::findPreviousVersion(const std::vector<FileGroup>& groups, const BlendFileInfo& file) const {
+    // Versions are ordered newest first, after the primary file
+    for (const auto& group : groups) {
+        if (group.versions.empty()) continue;
+        if (group.primaryFile.path == file.path) {
+            return &group.versions.front();
+        }
+        for (size_t v = 0; v + 1 < group.versions.size(); ++v) {
+            if (group.versions[v].path == file.path) {
+                return &group.versions[v + 1];
+            }
+        }
+    }
+    return nullptr;
+}
+
 const std::vector<std::string>& FileView::getCachedTags(const std::filesystem::path& path) const {
     static const std::vector<std::string> emptyTags;
 
@@ -138,6 +159,17 @@ void FileView::loadPendingTags() {
     }
 }
 
+void FileView::updateDatablockMatches(const std::string& filter) {
+    if (filter == m_datablockQuery) return;
+    m_datablockQuery = filter;
+    m_datablockMatches.clear();
+    if (filter.empty() || !m_database) return;
+
+    for (const auto& match : m_database->searchDatablocks(filter)) {
+        m_datablockMatches.insert(match.filePath);
+    }
+}
+
 void FileView::render(std::vector<FileGroup>& groups, ThumbnailCache& cache,
                       PreviewCache& previewCache, Database& database,
                       const std::string& filter, const std::string& tagFilter) {
@@ -148,6 +180,7 @@ void FileView::render(std::vector<FileGroup>& groups, ThumbnailCache& cache,
     m_tagFilter = tagFilter;
     m_currentFrame++;
     m_tagsLoadedThisFrame = 0;  // Reset per-frame limit
+    updateDatablockMatches(filter);
 
     // Log for first 10 frames
     if (m_currentFrame <= 10) {
@@ -399,7 +432,7 @@ void FileView::renderGridView(std::vector<FileGroup>& groups, ThumbnailCache& ca
 
         // Context menu
         if (ImGui::BeginPopupContextItem("FileContext")) {
-            renderFileContextMenu(file);
+            renderFileContextMenu(file, findPreviousVersion(groups, file));
             ImGui::EndPopup();
         }
 
@@ -816,7 +849,7 @@ void FileView::renderListView(std::vector<FileGroup>& groups, ThumbnailCache& ca
             }
 
             if (ImGui::BeginPopupContextItem()) {
-                renderFileContextMenu(group.primaryFile);
+                renderFileContextMenu(group.primaryFile, hasVersions ? &group.versions.front() : nullptr);
                 ImGui::EndPopup();
             }
 
@@ -848,7 +881,8 @@ void FileView::renderListView(std::vector<FileGroup>& groups, ThumbnailCache& ca
 
             // Versions
             if (hasVersions && opened) {
-                for (const auto& version : group.versions) {
+                for (size_t v = 0; v < group.versions.size(); ++v) {
+                    const auto& version = group.versions[v];
                     ImGui::TableNextRow();
                     ImGui::PushID(version.filename.c_str());
 
@@ -878,6 +912,11 @@ void FileView::renderListView(std::vector<FileGroup>& groups, ThumbnailCache& ca
                         }
                     }
 
+                    if (ImGui::BeginPopupContextItem()) {
+                        renderFileContextMenu(version, v + 1 < group.versions.size() ? &group.versions[v + 1] : nullptr);
+                        ImGui::EndPopup();
+                    }
+
                     // Tags column (for versions)
                     ImGui::TableNextColumn();
                     if (m_database) {
@@ -909,7 +948,7 @@ void FileView::renderListView(std::vector<FileGroup>& groups, ThumbnailCache& ca
     }
 }
 
-void FileView::renderFileContextMenu(const BlendFileInfo& file) {
+void FileView::renderFileContextMenu(const BlendFileInfo& file, const BlendFileInfo* previousVersion) {
     if (ImGui::MenuItem("Open in Blender")) {
         if (m_openCallback) {
             m_openCallback(file);
@@ -922,6 +961,17 @@ void FileView::renderFileContextMenu(const BlendFileInfo& file) {
         }
     }
 
+    if (previousVersion) {
+        if (ImGui::MenuItem("Compare with Previous Version")) {
+            if (m_compareCallback) {
+                m_compareCallback(*previousVersion, file);
+            }
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Datablocks added, removed or changed since %s", previousVersion->filename.c_str());
+        }
+    }
+
     ImGui::Separator();
 
     // Tags submenu
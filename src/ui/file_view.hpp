@@ -60,6 +60,13 @@ public:
      */
     using TagFilterCallback = std::function<void(const std::string&)>;
 
+    /**
+     * @brief Callback type for comparing two versions of a file.
+     * @param older The previous version
+     * @param newer The version it is compared with
+     */
+    using CompareCallback = std::function<void(const BlendFileInfo& older, const BlendFileInfo& newer)>;
+
     FileView();
 
     /**
@@ -116,6 +123,7 @@ public:
     void setSelectCallback(FileCallback callback) { m_selectCallback = std::move(callback); }
     void setOpenFolderCallback(PathCallback callback) { m_openFolderCallback = std::move(callback); }
     void setTagFilterCallback(TagFilterCallback callback) { m_tagFilterCallback = std::move(callback); }
+    void setCompareCallback(CompareCallback callback) { m_compareCallback = std::move(callback); }
     /// @}
 
     /// @name Tag Filter
@@ -130,11 +138,19 @@ public:
     void clearSelection() { m_selectedPath.clear(); }
     /// @}
 
+    /**
+     * @brief Run the datablock search again on the next render.
+     *
+     * Matches are cached per filter; call after the file list is reloaded
+     * so files stored since then are matched too.
+     */
+    void invalidateDatablockMatches() { m_datablockQuery.clear(); }
+
 private:
     void renderGridView(std::vector<FileGroup>& groups, ThumbnailCache& cache, PreviewCache& previewCache, const std::string& filter);
     void renderListView(std::vector<FileGroup>& groups, ThumbnailCache& cache, PreviewCache& previewCache, const std::string& filter);
     void renderFileItem(const BlendFileInfo& file, ThumbnailCache& cache, PreviewCache& previewCache, bool isPrimary = true);
-    void renderFileContextMenu(const BlendFileInfo& file);
+    void renderFileContextMenu(const BlendFileInfo& file, const BlendFileInfo* previousVersion = nullptr);
     void renderFileDetails(const BlendFileInfo& file);
     void renderTagMenu(const BlendFileInfo& file);
     void renderFileTags(const BlendFileInfo& file);
@@ -142,6 +158,7 @@ private:
     bool matchesFilter(const std::string& filename, const std::string& filter) const;
     bool matchesFilterWithTags(const BlendFileInfo& file, const std::string& filter) const;
     bool matchesTagFilter(const BlendFileInfo& file) const;
+    const BlendFileInfo* findPreviousVersion(const std::vector<FileGroup>& groups, const BlendFileInfo& file) const;
     std::string formatFileSize(uintmax_t bytes) const;
     std::string formatDate(const std::filesystem::file_time_type& time) const;
     bool isSelected(const BlendFileInfo& file) const { return file.path == m_selectedPath; }
@@ -181,10 +198,21 @@ private:
     void invalidateTagCache() { m_tagCache.clear(); m_pendingTagLoads.clear(); }
     /// @}
 
+    /// @name Datablock Matches
+    /// Files containing a datablock whose name starts with the filter,
+    /// queried once per filter change
+    /// @{
+    std::string m_datablockQuery;
+    std::set<std::filesystem::path> m_datablockMatches;
+
+    void updateDatablockMatches(const std::string& filter);
+    /// @}
+
     FileCallback m_openCallback;                ///< File open callback
     FileCallback m_selectCallback;              ///< File select callback
     PathCallback m_openFolderCallback;          ///< Open folder callback
     TagFilterCallback m_tagFilterCallback;      ///< Tag filter change callback
+    CompareCallback m_compareCallback;          ///< Compare with previous version callback
 
     std::vector<std::string> m_availableTags;   ///< Available tags for filter dropdown
 };